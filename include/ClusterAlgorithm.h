@@ -0,0 +1,281 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	Segmented algorithms for cluster_vector and cluster_map.
+//
+//	Each algorithm walks the container's segments() and runs a plain loop over
+//	every cluster's contiguous elements, so the per-element end-of-cluster
+//	check made by the containers' iterators stays out of the inner loop and
+//	the compiler is free to unroll and vectorise it.
+//
+//	Example usage:
+//	    sw::cluster_vector<float, Allocator> weights;
+//	    sw::fill(weights, 1.0f);
+//	    float total = sw::accumulate(weights, 0.0f);
+//	    size_t heavy = sw::count_if(weights, [](float w) { return w > 0.5f; });
+//	    auto light = sw::lower_bound(sortedWeights, 0.5f);
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+#include "ClusterMap.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <utility>
+
+namespace sw
+{
+
+// for_each_segment
+//
+// Calls function(first, last) for every contiguous run of elements.
+//
+template <typename Container, typename SegmentFunction>
+inline SegmentFunction for_each_segment(Container& container, SegmentFunction function)
+{
+	for (auto segment : container.segments())
+	{
+		function(segment.begin(), segment.end());
+	}
+	return function;
+}
+
+template <typename Container, typename Function>
+inline Function for_each(Container& container, Function function)
+{
+	for (auto segment : container.segments())
+	{
+		for (auto i = segment.begin(), e = segment.end(); i != e; ++i)
+		{
+			function(*i);
+		}
+	}
+	return function;
+}
+
+template <typename Container, typename OutputIterator, typename UnaryOperation>
+inline OutputIterator transform(Container& container, OutputIterator result, UnaryOperation operation)
+{
+	for (auto segment : container.segments())
+	{
+		result = std::transform(segment.begin(), segment.end(), result, operation);
+	}
+	return result;
+}
+
+template <typename Container, typename T>
+inline void fill(Container& container, const T& value)
+{
+	for (auto segment : container.segments())
+	{
+		std::fill(segment.begin(), segment.end(), value);
+	}
+}
+
+template <typename Container, typename OutputIterator>
+inline OutputIterator copy(Container const & container, OutputIterator result)
+{
+	for (auto segment : container.segments())
+	{
+		result = std::copy(segment.begin(), segment.end(), result);
+	}
+	return result;
+}
+
+template <typename Container, typename T>
+inline T accumulate(Container const & container, T init)
+{
+	for (auto segment : container.segments())
+	{
+		init = std::accumulate(segment.begin(), segment.end(), init);
+	}
+	return init;
+}
+
+template <typename Container, typename T, typename BinaryOperation>
+inline T accumulate(Container const & container, T init, BinaryOperation operation)
+{
+	for (auto segment : container.segments())
+	{
+		init = std::accumulate(segment.begin(), segment.end(), init, operation);
+	}
+	return init;
+}
+
+template <typename Container, typename T>
+inline auto find(Container& container, const T& value) -> decltype(container.end())
+{
+	for (auto segment : container.segments())
+	{
+		auto e = segment.end();
+		auto i = std::find(segment.begin(), e, value);
+		if (i != e)
+		{
+			return segment.to_iterator(i);
+		}
+	}
+	return container.end();
+}
+
+template <typename Container, typename Predicate>
+inline auto find_if(Container& container, Predicate predicate) -> decltype(container.end())
+{
+	for (auto segment : container.segments())
+	{
+		auto e = segment.end();
+		auto i = std::find_if(segment.begin(), e, predicate);
+		if (i != e)
+		{
+			return segment.to_iterator(i);
+		}
+	}
+	return container.end();
+}
+
+template <typename Container, typename Predicate>
+inline size_t count_if(Container const & container, Predicate predicate)
+{
+	size_t count = 0u;
+	for (auto segment : container.segments())
+	{
+		count += static_cast<size_t>(std::count_if(segment.begin(), segment.end(), predicate));
+	}
+	return count;
+}
+
+namespace detail
+{
+	//Index of the first segment in [low, segment_count()) whose last element fails before, by binary search of the
+	//container's cluster directory. Only the last element of O(log clusters) clusters is read.
+	template <typename Container, typename Predicate>
+	inline size_t partition_segments(Container& container, size_t low, Predicate before)
+	{
+		size_t high = container.segment_count();
+		while (low < high)
+		{
+			size_t mid = low + (high - low) / 2u;
+			auto segment = container.segment(mid);
+			if (before(*(segment.end() - 1)))
+			{
+				low = mid + 1u;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+		return low;
+	}
+}
+
+// lower_bound
+//
+// For a cluster_vector or cluster_map sorted by compare. The cluster holding
+// the answer is found by binary searching the cluster directory on each
+// cluster's last element, and is then binary searched itself, so the search
+// is logarithmic in both the cluster count and the cluster size.
+//
+template <typename Container, typename T, typename Compare>
+inline auto lower_bound(Container& container, const T& value, Compare compare) -> decltype(container.end())
+{
+	size_t index = detail::partition_segments(container, 0u, [&](auto const & element) { return compare(element, value); });
+	if (index == container.segment_count())
+	{
+		return container.end();
+	}
+	auto segment = container.segment(index);
+	return segment.to_iterator(std::lower_bound(segment.begin(), segment.end(), value, compare));
+}
+
+template <typename Container, typename T>
+inline auto lower_bound(Container& container, const T& value) -> decltype(container.end())
+{
+	return sw::lower_bound(container, value, std::less<>());
+}
+
+// upper_bound
+//
+// As lower_bound, for the first element that compares greater than value.
+//
+template <typename Container, typename T, typename Compare>
+inline auto upper_bound(Container& container, const T& value, Compare compare) -> decltype(container.end())
+{
+	size_t index = detail::partition_segments(container, 0u, [&](auto const & element) { return !compare(value, element); });
+	if (index == container.segment_count())
+	{
+		return container.end();
+	}
+	auto segment = container.segment(index);
+	return segment.to_iterator(std::upper_bound(segment.begin(), segment.end(), value, compare));
+}
+
+template <typename Container, typename T>
+inline auto upper_bound(Container& container, const T& value) -> decltype(container.end())
+{
+	return sw::upper_bound(container, value, std::less<>());
+}
+
+// equal_range
+//
+// Searches the cluster directory once for each end, the upper one starting
+// from the lower one's cluster. When both ends share a cluster it is only
+// searched once.
+//
+template <typename Container, typename T, typename Compare>
+inline auto equal_range(Container& container, const T& value, Compare compare) -> std::pair<decltype(container.end()), decltype(container.end())>
+{
+	size_t const count = container.segment_count();
+	size_t lowerIndex = detail::partition_segments(container, 0u, [&](auto const & element) { return compare(element, value); });
+	if (lowerIndex == count)
+	{
+		return std::make_pair(container.end(), container.end());
+	}
+	size_t upperIndex = detail::partition_segments(container, lowerIndex, [&](auto const & element) { return !compare(value, element); });
+
+	auto lowerSegment = container.segment(lowerIndex);
+	if (upperIndex == lowerIndex)
+	{
+		auto range = std::equal_range(lowerSegment.begin(), lowerSegment.end(), value, compare);
+		return std::make_pair(lowerSegment.to_iterator(range.first), lowerSegment.to_iterator(range.second));
+	}
+	auto lower = lowerSegment.to_iterator(std::lower_bound(lowerSegment.begin(), lowerSegment.end(), value, compare));
+	if (upperIndex == count)
+	{
+		return std::make_pair(lower, container.end());
+	}
+	auto upperSegment = container.segment(upperIndex);
+	return std::make_pair(lower, upperSegment.to_iterator(std::upper_bound(upperSegment.begin(), upperSegment.end(), value, compare)));
+}
+
+template <typename Container, typename T>
+inline auto equal_range(Container& container, const T& value) -> std::pair<decltype(container.end()), decltype(container.end())>
+{
+	return sw::equal_range(container, value, std::less<>());
+}
+
+// nth_element
+//
+// Partially orders a cluster_vector so that the element at index n is the
+// one a full sort would put there, with nothing after it comparing less and
+// nothing before it comparing greater. Runs std::nth_element over the
+// indexed iterators, so it needs no scratch space.
+//
+template <typename Container, typename Compare>
+inline void nth_element(Container& container, size_t n, Compare compare)
+{
+	if (n < container.size())
+	{
+		std::nth_element(container.indexed_begin(), container.indexed_begin() + n, container.indexed_end(), compare);
+	}
+}
+
+template <typename Container>
+inline void nth_element(Container& container, size_t n)
+{
+	sw::nth_element(container, n, std::less<typename Container::value_type>());
+}
+
+}
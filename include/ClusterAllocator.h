@@ -0,0 +1,587 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	Allocators for the Allocator parameter of cluster_vector, cluster_map and
+//	cluster_soa_vector.
+//
+//	huge_page_allocator serves small requests from the aligned heap and maps
+//	anything of at least its threshold directly, rounded up to and aligned on
+//	2MB so that the kernel can back it with transparent huge pages. Geometric
+//	growth makes the tail clusters the large ones, which is exactly where the
+//	TLB pressure of a long scan comes from. Mapped clusters can be bound to
+//	one NUMA node or interleaved across every node the process may use; on a
+//	machine with a single node, or a kernel without NUMA support, the policy
+//	is skipped and the memory is used as mapped.
+//
+//	Huge pages and NUMA placement are only implemented on Linux. Elsewhere
+//	every request comes from the aligned heap.
+//
+//	monotonic_arena hands out memory by bumping a pointer through a chain of
+//	blocks and never frees individual allocations; reset() or rewinding to a
+//	marker takes everything back at once. arena_allocator is the Allocator
+//	that points a container at an arena, with a deallocate() that does nothing,
+//	and arena_scope rewinds an arena when it goes out of scope so that scopes
+//	nest like a stack. Containers using an arena must be destroyed before the
+//	arena is reset or rewound past their clusters, since destroying them still
+//	reads their elements.
+//
+//	Example usage:
+//	    sw::huge_page_allocator allocator(sw::huge_page_allocator::kHugePageSize, sw::numa_policy::interleave);
+//	    sw::cluster_vector<float, sw::huge_page_allocator> samples(1024u, allocator);
+//
+//	    sw::monotonic_arena frameArena(1024u * 1024u);
+//	    {
+//	        sw::cluster_vector<Contact, sw::arena_allocator> contacts(64u, sw::arena_allocator(frameArena));
+//	        ...
+//	    }
+//	    frameArena.reset();
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#define CLUSTER_HUGE_PAGES_ENABLED 1
+#else
+	#define CLUSTER_HUGE_PAGES_ENABLED 0
+#endif
+
+#if defined(_WIN32)
+	#include <malloc.h>
+#endif
+
+namespace sw
+{
+
+enum class numa_policy
+{
+	none,			//Leave placement to the kernel, usually first touch
+	bind,			//Place mapped clusters on a single node
+	interleave,		//Spread the pages of mapped clusters across every allowed node
+};
+
+namespace detail
+{
+	inline void* aligned_heap_allocate(size_t n, size_t alignment)
+	{
+		if (alignment < sizeof(void*))
+		{
+			alignment = sizeof(void*);
+		}
+#if defined(_WIN32)
+		return _aligned_malloc(n, alignment);
+#else
+		void* p = nullptr;
+		return posix_memalign(&p, alignment, n) == 0 ? p : nullptr;
+#endif
+	}
+
+	inline void aligned_heap_free(void* p)
+	{
+#if defined(_WIN32)
+		_aligned_free(p);
+#else
+		free(p);
+#endif
+	}
+
+#if CLUSTER_HUGE_PAGES_ENABLED
+	//Values from linux/mempolicy.h, called through syscall() so that libnuma is not needed
+	static const int kMpolBind = 2;
+	static const int kMpolInterleave = 3;
+	static const unsigned long kMpolFMemsAllowed = 1ul << 2;
+	static const size_t kMaxNumaNodes = 1024u;
+
+	struct numa_node_mask
+	{
+		unsigned long mBits[kMaxNumaNodes / (8u * sizeof(unsigned long))];
+	};
+
+	//Nodes this process may allocate from, zero nodes if the kernel has no NUMA support
+	inline size_t allowed_numa_nodes(numa_node_mask& mask)
+	{
+		mask = numa_node_mask{};
+		if (syscall(SYS_get_mempolicy, nullptr, mask.mBits, kMaxNumaNodes, nullptr, kMpolFMemsAllowed) != 0)
+		{
+			return 0u;
+		}
+		size_t count = 0u;
+		for (unsigned long bits : mask.mBits)
+		{
+			for (; bits; bits &= bits - 1u)
+			{
+				++count;
+			}
+		}
+		return count;
+	}
+#endif
+}
+
+// huge_page_allocator
+//
+// Maps requests of at least hugePageThreshold bytes with madvise(MADV_HUGEPAGE)
+// and the chosen NUMA policy, and sends smaller ones to the aligned heap. A
+// large request that cannot be mapped fails rather than falling back.
+// deallocate() tells the two apart by size, so it must be given the size that
+// was allocated, as every container here does. Copies share their settings
+// and can free each other's memory.
+//
+class huge_page_allocator
+{
+public:
+	static const size_t kHugePageSize = 2u * 1024u * 1024u;
+
+	explicit huge_page_allocator(size_t hugePageThreshold = kHugePageSize, numa_policy policy = numa_policy::none, int numaNode = 0)
+		: mHugePageThreshold(hugePageThreshold ? hugePageThreshold : 1u)
+		, mPolicy(policy)
+		, mNumaNode(numaNode)
+	{
+	}
+
+	void* allocate(size_t n, int /*flags*/ = 0)
+	{
+		return allocate(n, CLUSTER_ALLOCATOR_MIN_ALIGNMENT, 0u);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset, int /*flags*/ = 0)
+	{
+		if (alignmentOffset % alignment != 0u)
+		{
+			return nullptr;
+		}
+#if CLUSTER_HUGE_PAGES_ENABLED
+		if (n >= mHugePageThreshold)
+		{
+			//Mappings are only ever huge page aligned, and deallocate() relies on every large request being mapped
+			return alignment <= kHugePageSize ? DoMap(n) : nullptr;
+		}
+#endif
+		return detail::aligned_heap_allocate(n, alignment);
+	}
+
+	void* allocate(size_t n, int flags, const char* /*file*/, int /*line*/, const char* /*functionName*/)
+	{
+		return allocate(n, flags);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset, int flags, const char* /*file*/, int /*line*/, const char* /*functionName*/)
+	{
+		return allocate(n, alignment, alignmentOffset, flags);
+	}
+
+	void deallocate(void* p, size_t n)
+	{
+		if (!p)
+		{
+			return;
+		}
+#if CLUSTER_HUGE_PAGES_ENABLED
+		if (n >= mHugePageThreshold)
+		{
+			munmap(p, DoMappedLength(n));
+			return;
+		}
+#else
+		CLUSTER_UNUSED(n);
+#endif
+		detail::aligned_heap_free(p);
+	}
+
+	size_t				huge_page_threshold() const { return mHugePageThreshold; }
+	numa_policy			policy() const { return mPolicy; }
+	int					numa_node() const { return mNumaNode; }
+
+protected:
+#if CLUSTER_HUGE_PAGES_ENABLED
+	static size_t DoMappedLength(size_t n)
+	{
+		return (n + kHugePageSize - 1u) & ~(kHugePageSize - 1u);
+	}
+
+	//Over-maps by a huge page and trims both ends so that the mapping starts on a huge page boundary
+	void* DoMap(size_t n) const
+	{
+		size_t const length = DoMappedLength(n);
+		void* mapping = mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+		char* const base = static_cast<char*>(mapping);
+		char* const aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(base) + kHugePageSize - 1u) & ~uintptr_t(kHugePageSize - 1u));
+		if (aligned != base)
+		{
+			munmap(base, static_cast<size_t>(aligned - base));
+		}
+		size_t const tail = static_cast<size_t>(base + length + kHugePageSize - (aligned + length));
+		if (tail)
+		{
+			munmap(aligned + length, tail);
+		}
+
+#if defined(MADV_HUGEPAGE)
+		//Only advice, kernels with transparent huge pages disabled keep using small pages
+		madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+		DoApplyNumaPolicy(aligned, length);
+		return aligned;
+	}
+
+	void DoApplyNumaPolicy(void* p, size_t length) const
+	{
+		if (mPolicy == numa_policy::none)
+		{
+			return;
+		}
+
+		detail::numa_node_mask allowed;
+		if (detail::allowed_numa_nodes(allowed) < 2u)
+		{
+			return;
+		}
+
+		detail::numa_node_mask mask{};
+		size_t const bitsPerWord = 8u * sizeof(unsigned long);
+		if (mPolicy == numa_policy::bind)
+		{
+			size_t const node = static_cast<size_t>(mNumaNode);
+			if (mNumaNode < 0 || node >= detail::kMaxNumaNodes || !(allowed.mBits[node / bitsPerWord] & (1ul << (node % bitsPerWord))))
+			{
+				return;
+			}
+			mask.mBits[node / bitsPerWord] = 1ul << (node % bitsPerWord);
+		}
+		else
+		{
+			mask = allowed;
+		}
+
+		//Placement is best effort, a refused policy leaves the pages to the default policy
+		syscall(SYS_mbind, p, length, mPolicy == numa_policy::bind ? detail::kMpolBind : detail::kMpolInterleave, mask.mBits, detail::kMaxNumaNodes, 0u);
+	}
+#endif
+
+	size_t				mHugePageThreshold;
+	numa_policy			mPolicy;
+	int					mNumaNode;
+};
+
+// monotonic_arena
+//
+// Bump allocator over a chain of blocks. A block that runs out is followed by
+// the next one, reusing blocks kept from before the last reset() or rewind()
+// where they are large enough and allocating a new block of at least twice
+// the previous size otherwise. An optional caller buffer, such as a stack
+// array, serves as the first block. Not thread safe.
+//
+class monotonic_arena
+{
+public:
+	//Position in the arena to rewind to, everything allocated after it is taken back
+	struct marker
+	{
+		void*		mBlock;
+		char*		mCurrent;
+	};
+
+	explicit monotonic_arena(size_t initialBlockSize = 64u * 1024u)
+		: mFirstBlock(nullptr)
+		, mCurrentBlock(nullptr)
+		, mCurrent(nullptr)
+		, mEnd(nullptr)
+		, mNextBlockSize(initialBlockSize > sizeof(block) ? initialBlockSize : 2u * sizeof(block))
+	{
+	}
+
+	monotonic_arena(void* buffer, size_t bufferSize, size_t nextBlockSize = 64u * 1024u)
+		: monotonic_arena(nextBlockSize)
+	{
+		if (buffer && bufferSize > sizeof(block) + CLUSTER_ALIGN_OF(block))
+		{
+			uintptr_t const alignedAddress = (reinterpret_cast<uintptr_t>(buffer) + CLUSTER_ALIGN_OF(block) - 1u) & ~uintptr_t(CLUSTER_ALIGN_OF(block) - 1u);
+			block* first = reinterpret_cast<block*>(alignedAddress);
+			first->mNext = nullptr;
+			first->mEnd = static_cast<char*>(buffer) + bufferSize;
+			first->mOwned = false;
+			mFirstBlock = first;
+			DoEnterBlock(first);
+		}
+	}
+
+	~monotonic_arena()
+	{
+		release();
+	}
+
+	monotonic_arena(monotonic_arena const &) = delete;
+	monotonic_arena& operator=(monotonic_arena const &) = delete;
+
+	void* allocate(size_t n, size_t alignment = CLUSTER_ALLOCATOR_MIN_ALIGNMENT)
+	{
+		if (alignment < CLUSTER_ALLOCATOR_MIN_ALIGNMENT)
+		{
+			alignment = CLUSTER_ALLOCATOR_MIN_ALIGNMENT;
+		}
+		char* result = DoAlign(mCurrent, alignment);
+		if (CLUSTER_UNLIKELY(!mCurrent || n > static_cast<size_t>(mEnd - result)))
+		{
+			result = DoNextBlock(n, alignment);
+			if (!result)
+			{
+				//Out of memory, the current block stays as it was
+				return nullptr;
+			}
+		}
+		mCurrent = result + n;
+		return result;
+	}
+
+	//Takes back every allocation but keeps the blocks for reuse, O(1)
+	void reset()
+	{
+		if (mFirstBlock)
+		{
+			DoEnterBlock(mFirstBlock);
+		}
+	}
+
+	marker mark() const
+	{
+		return marker{ mCurrentBlock, mCurrent };
+	}
+
+	//Takes back every allocation made since m was taken, O(1)
+	void rewind(marker m)
+	{
+		if (!m.mBlock)
+		{
+			reset();
+			return;
+		}
+		mCurrentBlock = static_cast<block*>(m.mBlock);
+		mCurrent = m.mCurrent;
+		mEnd = mCurrentBlock->mEnd;
+	}
+
+	//Frees every block the arena allocated, leaving it as freshly constructed apart from a caller buffer
+	void release()
+	{
+		block* const first = mFirstBlock;
+		bool const keepFirst = first && !first->mOwned;
+		block* i = first;
+		while (i)
+		{
+			block* next = i->mNext;
+			if (i->mOwned)
+			{
+				detail::aligned_heap_free(i);
+			}
+			i = next;
+		}
+		mFirstBlock = nullptr;
+		mCurrentBlock = nullptr;
+		mCurrent = nullptr;
+		mEnd = nullptr;
+		if (keepFirst)
+		{
+			first->mNext = nullptr;
+			mFirstBlock = first;
+			DoEnterBlock(first);
+		}
+	}
+
+	//Bytes handed out since the last reset, including alignment padding
+	size_t bytes_used() const
+	{
+		size_t used = 0u;
+		for (block* i = mFirstBlock; i; i = i->mNext)
+		{
+			if (i == mCurrentBlock)
+			{
+				return used + static_cast<size_t>(mCurrent - i->begin());
+			}
+			used += static_cast<size_t>(i->mEnd - i->begin());
+		}
+		return used;
+	}
+
+	//Bytes of block space held, used or not
+	size_t bytes_reserved() const
+	{
+		size_t reserved = 0u;
+		for (block* i = mFirstBlock; i; i = i->mNext)
+		{
+			reserved += static_cast<size_t>(i->mEnd - i->begin());
+		}
+		return reserved;
+	}
+
+protected:
+	struct block
+	{
+		block*		mNext;
+		char*		mEnd;
+		bool		mOwned;
+
+		char*		begin() { return reinterpret_cast<char*>(this + 1); }
+	};
+
+	static char* DoAlign(char* p, size_t alignment)
+	{
+		return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(p) + alignment - 1u) & ~uintptr_t(alignment - 1u));
+	}
+
+	void DoEnterBlock(block* b)
+	{
+		mCurrentBlock = b;
+		mCurrent = b->begin();
+		mEnd = b->mEnd;
+	}
+
+	//Moves on to the first following block with room for n, or links in a new one after the current block
+	char* DoNextBlock(size_t n, size_t alignment)
+	{
+		block* previous = mCurrentBlock;
+		for (block* i = previous ? previous->mNext : mFirstBlock; i; i = i->mNext)
+		{
+			char* result = DoAlign(i->begin(), alignment);
+			if (n <= static_cast<size_t>(i->mEnd - result))
+			{
+				DoEnterBlock(i);
+				return result;
+			}
+			previous = i;
+		}
+
+		//A request this large cannot be given a block, and would wrap the size below
+		if (CLUSTER_UNLIKELY(n > SIZE_MAX - sizeof(block) - alignment))
+		{
+#if CLUSTER_EXCEPTIONS_ENABLED
+			throw std::bad_alloc();
+#elif CLUSTER_ASSERT_ENABLED
+			CLUSTER_ASSERT("monotonic_arena::allocate -- request too large");
+#endif
+			return nullptr;
+		}
+
+		//Block sizes double until they would overflow, then stay at what is needed
+		size_t const needed = sizeof(block) + alignment + n;
+		size_t blockSize = mNextBlockSize;
+		while (blockSize < needed)
+		{
+			blockSize = blockSize <= SIZE_MAX / 2u ? blockSize * 2u : needed;
+		}
+		mNextBlockSize = blockSize <= SIZE_MAX / 2u ? blockSize * 2u : blockSize;
+
+		block* newBlock = static_cast<block*>(detail::aligned_heap_allocate(blockSize, CLUSTER_ALIGN_OF(block)));
+		if (!newBlock)
+		{
+			return nullptr;
+		}
+		newBlock->mNext = nullptr;
+		newBlock->mEnd = reinterpret_cast<char*>(newBlock) + blockSize;
+		newBlock->mOwned = true;
+		if (previous)
+		{
+			previous->mNext = newBlock;
+		}
+		else
+		{
+			mFirstBlock = newBlock;
+		}
+		DoEnterBlock(newBlock);
+		return DoAlign(mCurrent, alignment);
+	}
+
+	block*		mFirstBlock;
+	block*		mCurrentBlock;
+	char*		mCurrent;
+	char*		mEnd;
+	size_t		mNextBlockSize;
+};
+
+// arena_allocator
+//
+// Allocator for the containers that bumps through a monotonic_arena. Freeing
+// is a no-op, memory comes back when the arena is reset or rewound.
+//
+class arena_allocator
+{
+public:
+	explicit arena_allocator(monotonic_arena& arena)
+		: mArena(&arena)
+	{
+	}
+
+	void* allocate(size_t n, int /*flags*/ = 0)
+	{
+		return mArena->allocate(n);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset, int /*flags*/ = 0)
+	{
+		if (alignmentOffset % alignment != 0u)
+		{
+			return nullptr;
+		}
+		return mArena->allocate(n, alignment);
+	}
+
+	void* allocate(size_t n, int flags, const char* /*file*/, int /*line*/, const char* /*functionName*/)
+	{
+		return allocate(n, flags);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset, int flags, const char* /*file*/, int /*line*/, const char* /*functionName*/)
+	{
+		return allocate(n, alignment, alignmentOffset, flags);
+	}
+
+	void deallocate(void* /*p*/, size_t /*n*/)
+	{
+	}
+
+	monotonic_arena&	arena() const { return *mArena; }
+
+protected:
+	monotonic_arena*	mArena;
+};
+
+// arena_scope
+//
+// Marks an arena on construction and rewinds it on destruction, so nested
+// scopes give the arena stack discipline: a per-request scope inside a
+// per-frame arena gives its memory back as soon as the request finishes.
+//
+class arena_scope
+{
+public:
+	explicit arena_scope(monotonic_arena& arena)
+		: mArena(arena)
+		, mMarker(arena.mark())
+	{
+	}
+
+	~arena_scope()
+	{
+		mArena.rewind(mMarker);
+	}
+
+	arena_scope(arena_scope const &) = delete;
+	arena_scope& operator=(arena_scope const &) = delete;
+
+protected:
+	monotonic_arena&			mArena;
+	monotonic_arena::marker		mMarker;
+};
+
+}
@@ -0,0 +1,442 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	A cluster_map variant that links its sparse and dense sides with 32-bit
+//	element indices instead of pointers.
+//
+//	cluster_map keeps a 4 byte sparse slot number per dense element and a
+//	16 byte sparse slot, holding an 8 byte element pointer, the element's 4
+//	byte dense position and the 4 byte generation of cluster_map_key, plus
+//	an 8 byte free list entry per free slot. For ints, floats and ids that
+//	is several times the element itself. compact_cluster_map stores the
+//	same 4 byte slot index per element but only a 4 byte dense index plus a
+//	4 byte generation in each slot, and keeps its free list inside the
+//	unoccupied slots. Indices are resolved through the cluster directory,
+//	which is offset arithmetic under the default growth policies.
+//
+//	The dense storage is a cluster_soa_vector, so each cluster holds the
+//	elements as one contiguous T array with the slot indices in a parallel
+//	array beside it in the same allocation. segments() yields each
+//	cluster's elements as a plain T* span that sweeps and the simd_
+//	functions can run over without pulling the slot indices through the
+//	cache.
+//
+//	There are no pointer handles, elements are addressed by cluster_map_key
+//	only. Resolving a key costs two directory lookups, one for the slot and
+//	one for the element, where a cluster_map handle costs one dereference.
+//	At most 2^32 - 1 elements can be live at once.
+//
+//	Example usage:
+//	    sw::compact_cluster_map<float, Allocator> weights(256);
+//	    sw::cluster_map_key key = weights.insert(1.0f);
+//	    if (float* weight = weights.find(key)) { *weight *= 0.5f; }
+//	    for (auto segment : weights.segments())
+//	        for (float& weight : segment) { weight *= decay; }
+//	    weights.erase(key);
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterMap.h"
+#include "ClusterSoaVector.h"
+
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sw
+{
+
+// compact_cluster_map_slot
+//
+// One slot of a compact_cluster_map's sparse indices. While the slot is
+// occupied mDense is the element's position in the dense storage, while it
+// is free mDense is the next free slot.
+//
+struct compact_cluster_map_slot
+{
+	uint32_t							mDense;
+	uint32_t							mGeneration;	//Bumped each time the slot's element is erased, never 0
+};
+
+template <typename T>
+struct compact_cluster_map_iterator
+{
+public:
+	using this_type			= compact_cluster_map_iterator<T>;
+	using cluster_type		= soa_cluster<std::tuple<typename std::remove_const<T>::type, uint32_t>>;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= typename std::remove_const<T>::type;
+	using difference_type	= ptrdiff_t;
+	using pointer			= T*;
+	using reference			= T&;
+
+	T*								operator->() const { return mCurrent; }
+	T&								operator*() const { return *mCurrent; }
+
+	this_type&						operator++();
+	this_type						operator++(int) { this_type i(*this); operator++(); return i; }
+
+	bool							operator==(this_type const & other) const { return mCurrent == other.mCurrent; }
+	bool							operator!=(this_type const & other) const { return mCurrent != other.mCurrent; }
+
+	//Index of the element within the dense storage
+	size_t							dense_index() const { return mCluster->mStartIndex + (mCurrent - mCluster->template column<0>()); }
+
+	cluster_type*					mCluster;
+	T*								mCurrent;
+	T*								mEnd;
+};
+
+// The elements of one dense storage cluster as a contiguous T span, see cluster_segment.
+template <typename T>
+struct compact_cluster_map_segment
+{
+public:
+	using cluster_type			= typename compact_cluster_map_iterator<T>::cluster_type;
+	using size_type				= size_t;
+	using iterator				= T*;
+	using container_iterator	= compact_cluster_map_iterator<T>;
+
+	T*								begin() const { return mBegin; }
+	T*								end() const { return mEnd; }
+	size_type						size() const { return mEnd - mBegin; }
+	bool							empty() const { return mBegin == mEnd; }
+
+	//Iterator of the owning compact_cluster_map pointing at an element of this segment
+	container_iterator				to_iterator(T* position) const { return container_iterator{mCluster, position, mEnd}; }
+
+	cluster_type*					mCluster;
+	T*								mBegin;
+	T*								mEnd;
+};
+
+template <typename T>
+struct compact_cluster_map_segment_iterator
+{
+public:
+	using this_type			= compact_cluster_map_segment_iterator<T>;
+	using cluster_type		= typename compact_cluster_map_segment<T>::cluster_type;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= compact_cluster_map_segment<T>;
+	using difference_type	= ptrdiff_t;
+	using pointer			= const value_type*;
+	using reference			= value_type;
+
+	value_type						operator*() const;
+
+	this_type&						operator++() { mCluster = mCluster->mNext; return *this; }
+	this_type						operator++(int) { this_type i(*this); mCluster = mCluster->mNext; return i; }
+
+	bool							operator==(this_type const & other) const { return mCluster == other.mCluster; }
+	bool							operator!=(this_type const & other) const { return mCluster != other.mCluster; }
+
+	cluster_type*					mCluster;
+};
+
+template <typename T>
+inline typename compact_cluster_map_iterator<T>::this_type&
+compact_cluster_map_iterator<T>::operator++()
+{
+	if (CLUSTER_UNLIKELY(++mCurrent == mEnd))
+	{
+		//Clusters in the chain are never empty
+		mCluster = mCluster->mNext;
+		if (mCluster)
+		{
+			mCurrent = mCluster->template column<0>();
+			mEnd = mCurrent + mCluster->mSize;
+		}
+		else
+		{
+			mCurrent = nullptr;
+		}
+	}
+	return *this;
+}
+
+template <typename T>
+inline typename compact_cluster_map_segment_iterator<T>::value_type
+compact_cluster_map_segment_iterator<T>::operator*() const
+{
+	T* first = mCluster->template column<0>();
+	return value_type{mCluster, first, first + mCluster->mSize};
+}
+
+template <typename T, typename Allocator, size_t tStepSize = 2u, typename GrowthPolicy = geometric_growth<tStepSize>>
+class compact_cluster_map
+{
+public:
+
+	using this_type				= compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>;
+	using allocator_type		= Allocator;
+
+	using size_type				= size_t;
+	using slot_type				= compact_cluster_map_slot;
+	using key_type				= cluster_map_key;
+
+	//Column 0 holds the elements, column 1 the index of each element's sparse slot
+	using dense_vector_type		= cluster_soa_vector<std::tuple<T, uint32_t>, Allocator, tStepSize, GrowthPolicy>;
+	using slot_vector_type		= cluster_vector<slot_type, Allocator, tStepSize, GrowthPolicy>;
+	using const_iterator		= compact_cluster_map_iterator<const T>;
+	using iterator				= compact_cluster_map_iterator<T>;
+	using segment_range			= cluster_segment_range<compact_cluster_map_segment_iterator<T>>;
+	using const_segment_range	= cluster_segment_range<compact_cluster_map_segment_iterator<const T>>;
+
+	using value_type			= T;
+
+	static const uint32_t		kNoSlot = 0xFFFFFFFFu;
+
+								compact_cluster_map(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
+								compact_cluster_map() : compact_cluster_map(64u) {}
+								compact_cluster_map(this_type&& other);
+
+								compact_cluster_map(this_type const &) = delete;
+	this_type&					operator=(this_type const &) = delete;
+
+	void						swap(this_type& other);
+
+	allocator_type&				get_allocator() { return mDenseStorage.get_allocator(); }
+
+	const_iterator				begin() const;
+	iterator					begin();
+	const_iterator				end() const { return const_iterator{}; }
+	iterator					end() { return iterator{}; }
+
+	//The elements of each dense storage cluster as a contiguous T span
+	const_segment_range			segments() const;
+	segment_range				segments();
+
+	size_type					size() const { return mDenseStorage.size(); }
+	size_type					capacity() const { return mDenseStorage.capacity(); }
+	bool						empty() const { return mDenseStorage.empty(); }
+	void						clear();
+
+	//Pre-allocates dense storage and sparse indices so that the first count live elements never allocate
+	void						reserve(size_type count);
+
+	template<typename... Args>
+	key_type					insert(Args&&... args);
+
+	//Returns false if the element had already been erased
+	bool						erase(key_type key);
+	void						erase(iterator itr);
+
+	key_type					key_of(const_iterator itr) const { return DoKeyOf(mDenseStorage.template get<1>(itr.dense_index())); }
+	key_type					key_of(iterator itr) const { return DoKeyOf(mDenseStorage.template get<1>(itr.dense_index())); }
+	bool						contains(key_type key) const;
+	//The element, or nullptr if it has been erased
+	const T*					find(key_type key) const;
+	T*							find(key_type key);
+
+	dense_vector_type const &	dense_storage() const { return mDenseStorage; }
+	slot_vector_type const &	sparse_indices() const { return mSparseIndices; }
+
+protected:
+	slot_type const *			DoFindSlot(key_type key) const;
+	key_type					DoKeyOf(uint32_t slotIndex) const { return key_type{slotIndex, mSparseIndices[slotIndex].mGeneration}; }
+	void						DoErase(uint32_t slotIndex);
+
+	dense_vector_type			mDenseStorage;			//Live elements without gaps, beside the index of each one's sparse slot. Addresses are not stable.
+	slot_vector_type			mSparseIndices;			//Stable slots holding the dense index of their element, or the next free slot
+	uint32_t					mFreeSlot;				//Head of the free list threaded through the unoccupied slots
+	uint32_t					mNextSlotGeneration;	//Generation of newly added sparse slots. No slot has had a later one, and erased slots are kept below it.
+};
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::compact_cluster_map(size_type initialClusterCapacity, const Allocator& allocator) :
+	mDenseStorage(initialClusterCapacity, allocator)
+	,mSparseIndices(initialClusterCapacity, allocator)
+	,mFreeSlot(kNoSlot)
+	,mNextSlotGeneration(1u)
+{}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::compact_cluster_map(this_type&& other) :
+	mDenseStorage(std::move(other.mDenseStorage))
+	,mSparseIndices(std::move(other.mSparseIndices))
+	,mFreeSlot(other.mFreeSlot)
+	,mNextSlotGeneration(other.mNextSlotGeneration)
+{
+	other.mFreeSlot = kNoSlot;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::swap(this_type& other)
+{
+	mDenseStorage.swap(other.mDenseStorage);
+	mSparseIndices.swap(other.mSparseIndices);
+	std::swap(mFreeSlot, other.mFreeSlot);
+	std::swap(mNextSlotGeneration, other.mNextSlotGeneration);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::begin() const
+{
+	const_segment_range range = segments();
+	if (range.begin() == range.end())
+	{
+		return const_iterator{};
+	}
+	compact_cluster_map_segment<const T> first = *range.begin();
+	return const_iterator{first.mCluster, first.mBegin, first.mEnd};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::iterator
+compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::begin()
+{
+	segment_range range = segments();
+	if (range.begin() == range.end())
+	{
+		return iterator{};
+	}
+	compact_cluster_map_segment<T> first = *range.begin();
+	return iterator{first.mCluster, first.mBegin, first.mEnd};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::const_segment_range
+compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segments() const
+{
+	const_segment_range range{};
+	range.mBegin.mCluster = const_cast<dense_vector_type&>(mDenseStorage).segments().mBegin.mCluster;
+	return range;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segment_range
+compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segments()
+{
+	segment_range range{};
+	range.mBegin.mCluster = mDenseStorage.segments().mBegin.mCluster;
+	return range;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::clear()
+{
+	//No slot has a generation past mNextSlotGeneration, so moving it on once keeps keys into the dropped slots from matching the slots that replace them
+	mNextSlotGeneration = detail::next_generation(mNextSlotGeneration);
+	mDenseStorage.clear();
+	mSparseIndices.clear();
+	mFreeSlot = kNoSlot;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::reserve(size_type count)
+{
+	mDenseStorage.reserve(count);
+	mSparseIndices.reserve(count);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template<typename ...Args>
+inline typename compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::key_type
+compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::insert(Args && ...args)
+{
+	size_type denseIndex = mDenseStorage.size();
+#if CLUSTER_EXCEPTIONS_ENABLED
+	if (CLUSTER_UNLIKELY(denseIndex >= kNoSlot))
+		throw std::length_error("compact_cluster_map::insert -- 32-bit index space exhausted");
+#elif CLUSTER_ASSERT_ENABLED
+	if (CLUSTER_UNLIKELY(denseIndex >= kNoSlot))
+		CLUSTER_ASSERT("compact_cluster_map::insert -- 32-bit index space exhausted");
+#endif
+
+	uint32_t slotIndex = mFreeSlot;
+	slot_type* slot{};
+	if (slotIndex != kNoSlot)
+	{
+		slot = &mSparseIndices[slotIndex];
+		mFreeSlot = slot->mDense;
+	}
+	else
+	{
+		slotIndex = static_cast<uint32_t>(mSparseIndices.size());
+		slot = mSparseIndices.push_back(slot_type{0u, mNextSlotGeneration}).mCurrent;
+	}
+	slot->mDense = static_cast<uint32_t>(denseIndex);
+
+	typename dense_vector_type::reference pushed = mDenseStorage.push_back_uninitialized();
+	new (&std::get<1>(pushed)) uint32_t(slotIndex);
+	new (&std::get<0>(pushed)) T(std::forward<Args>(args)...);
+
+	return key_type{slotIndex, slot->mGeneration};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoErase(uint32_t slotIndex)
+{
+	slot_type& slot = mSparseIndices[slotIndex];
+	uint32_t backSlot = mDenseStorage.template get<1>(mDenseStorage.size() - 1u);
+
+	//erase_unsorted relocates the back element into the hole, so patch up its slot to match
+	mSparseIndices[backSlot].mDense = slot.mDense;
+	mDenseStorage.erase_unsorted(slot.mDense);
+
+	//Keys to the erased element stop resolving
+	slot.mGeneration = detail::next_generation(slot.mGeneration);
+	if (slot.mGeneration >= mNextSlotGeneration)
+	{
+		mNextSlotGeneration = detail::next_generation(slot.mGeneration);
+	}
+	slot.mDense = mFreeSlot;
+	mFreeSlot = slotIndex;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::erase(key_type key)
+{
+	if (!DoFindSlot(key))
+	{
+		return false;
+	}
+	DoErase(key.mSlot);
+	return true;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::erase(iterator itr)
+{
+	DoErase(mDenseStorage.template get<1>(itr.dense_index()));
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::slot_type const *
+compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoFindSlot(key_type key) const
+{
+	if (key.mSlot >= mSparseIndices.size())
+	{
+		return nullptr;
+	}
+	slot_type const & slot = mSparseIndices[key.mSlot];
+	return slot.mGeneration == key.mGeneration ? &slot : nullptr;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::contains(key_type key) const
+{
+	return DoFindSlot(key) != nullptr;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T* compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::find(key_type key) const
+{
+	slot_type const * slot = DoFindSlot(key);
+	return slot ? &mDenseStorage.template get<0>(slot->mDense) : nullptr;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T* compact_cluster_map<T, Allocator, tStepSize, GrowthPolicy>::find(key_type key)
+{
+	slot_type const * slot = DoFindSlot(key);
+	return slot ? &mDenseStorage.template get<0>(slot->mDense) : nullptr;
+}
+
+}
@@ -0,0 +1,437 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	A cluster vector that any number of threads can append to at once.
+//
+//	Each push_back() or emplace_back() reserves its slot with a single atomic
+//	increment of the size, works out the owning cluster from the growth
+//	policy's cluster_index() and constructs the element in place. A cluster
+//	that does not exist yet is allocated by whichever threads first need it
+//	and published with a compare-and-swap on the previous cluster's mNext
+//	link, so exactly one allocation wins and the losers free theirs. Clusters
+//	never move, so the address of an element is stable from the moment it is
+//	constructed.
+//
+//	Appending is the only concurrent operation. An element may be read by
+//	other threads once its producer has handed it over, for example by
+//	finishing its job; size(), iteration and clear() expect every append to
+//	have completed. The allocator is called from the appending threads and
+//	must be thread safe.
+//
+//	Example usage:
+//	    sw::concurrent_cluster_vector<Result, Allocator> results;
+//	    jobs.parallel_for(jobCount, [&](size_t job) { results.emplace_back(run(job)); });
+//	    for (Result const & r : results) { ... }
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+
+#include <atomic>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sw
+{
+
+template <typename T>
+struct concurrent_cluster
+{
+	std::atomic<concurrent_cluster*>	mNext;
+	size_t								mCapacity;
+	size_t								mStartIndex;
+
+	static constexpr size_t data_offset()
+	{
+		return (sizeof(concurrent_cluster) + alignof(T) - 1u) / alignof(T) * alignof(T);
+	}
+
+	static constexpr size_t alignment()
+	{
+		return alignof(T) > alignof(concurrent_cluster) ? alignof(T) : alignof(concurrent_cluster);
+	}
+
+	static size_t allocation_size(size_t capacity)
+	{
+		return data_offset() + capacity * sizeof(T);
+	}
+
+	T* begin() const
+	{
+		return reinterpret_cast<T*>(reinterpret_cast<char*>(const_cast<concurrent_cluster*>(this)) + data_offset());
+	}
+};
+
+template <typename T>
+struct concurrent_cluster_vector_iterator
+{
+public:
+	using this_type			= concurrent_cluster_vector_iterator<T>;
+	using cluster_type		= concurrent_cluster<typename std::remove_const<T>::type>;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= typename std::remove_const<T>::type;
+	using difference_type	= ptrdiff_t;
+	using pointer			= T*;
+	using reference			= T&;
+
+	reference				operator*() const { return *mCurrent; }
+	pointer					operator->() const { return mCurrent; }
+
+	this_type&				operator++();
+	this_type				operator++(int) { this_type i(*this); operator++(); return i; }
+
+	bool					operator==(this_type const & other) const { return mCurrent == other.mCurrent; }
+	bool					operator!=(this_type const & other) const { return mCurrent != other.mCurrent; }
+
+	//Points the iterator at the live elements of cluster, or at the end if there are none
+	void					DoEnterCluster(cluster_type* cluster);
+
+	T*						mCurrent;
+	T*						mEnd;
+	cluster_type*			mCluster;
+	size_t					mSize;		//Elements in the container when the iterator was made
+};
+
+template <typename T>
+inline void
+concurrent_cluster_vector_iterator<T>::DoEnterCluster(cluster_type* cluster)
+{
+	mCluster = cluster;
+	if (!cluster || cluster->mStartIndex >= mSize)
+	{
+		mCurrent = nullptr;
+		return;
+	}
+	size_t const remaining = mSize - cluster->mStartIndex;
+	mCurrent = cluster->begin();
+	mEnd = mCurrent + (remaining < cluster->mCapacity ? remaining : cluster->mCapacity);
+}
+
+template <typename T>
+inline typename concurrent_cluster_vector_iterator<T>::this_type&
+concurrent_cluster_vector_iterator<T>::operator++()
+{
+	if (CLUSTER_UNLIKELY(++mCurrent == mEnd))
+	{
+		DoEnterCluster(mCluster->mNext.load(std::memory_order_acquire));
+	}
+	return *this;
+}
+
+// concurrent_cluster_vector
+//
+// Append-only from many threads at once, see the top of this file. The growth
+// policy must provide cluster_index(), since a thread finds the cluster for
+// its slot without looking at any other thread's work.
+//
+template <typename T, typename Allocator, size_t tStepSize = 2u, typename GrowthPolicy = geometric_growth<tStepSize>>
+class concurrent_cluster_vector
+{
+	static_assert(GrowthPolicy::kHasClusterIndex, "concurrent_cluster_vector needs a growth policy with cluster_index()");
+
+public:
+	using size_type				= size_t;
+	using this_type				= concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>;
+	using cluster_type			= concurrent_cluster<T>;
+	using allocator_type		= Allocator;
+	using growth_policy_type	= GrowthPolicy;
+	using iterator				= concurrent_cluster_vector_iterator<T>;
+	using const_iterator		= concurrent_cluster_vector_iterator<const T>;
+	using value_type			= T;
+
+	concurrent_cluster_vector(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
+	concurrent_cluster_vector() : concurrent_cluster_vector(64u) {}
+	~concurrent_cluster_vector();
+
+	concurrent_cluster_vector(this_type const &) = delete;
+	this_type& operator=(this_type const &) = delete;
+
+	allocator_type&			get_allocator() { return mAllocator; }
+
+	//Safe to call from any number of threads at once
+	T&						push_back(const T& value);
+	T&						push_back(T&& value);
+	template <typename... Args>
+	T&						emplace_back(Args&&... args);
+
+	//The following expect every append to have completed
+	const_iterator			begin() const;
+	iterator				begin();
+	const_iterator			end() const;
+	iterator				end();
+
+	size_type				size() const;
+	bool					empty() const;
+	size_type				cluster_count() const;
+
+	const T&				operator[](size_type index) const;
+	T&						operator[](size_type index);
+
+	//Destroys every element and frees every cluster
+	void					clear();
+
+protected:
+	//Enough directory blocks to address more clusters than any size_t index needs
+	static const size_type	kDirectoryBlockCount = 48u;
+	static const size_type	kFirstDirectoryBlockSize = 64u;
+
+	using directory_entry	= std::atomic<cluster_type*>;
+
+	T*						DoReserveSlot();
+	cluster_type*			DoCluster(size_type clusterIndex) const;
+	cluster_type*			DoAcquireCluster(size_type clusterIndex);
+	directory_entry&		DoDirectoryEntry(size_type clusterIndex) const;
+
+	mutable allocator_type				mAllocator;
+	size_type const						mInitialClusterCapacity;
+	std::atomic<size_type>				mSize;
+	std::atomic<cluster_type*>			mFirstcluster;
+	//Block b holds the directory entries of kFirstDirectoryBlockSize << b clusters, blocks are published by CAS like clusters
+	mutable std::atomic<directory_entry*>	mDirectoryBlocks[kDirectoryBlockCount];
+};
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::concurrent_cluster_vector(size_type initialClusterCapacity, const Allocator& allocator)
+	:	mAllocator(allocator)
+	,	mInitialClusterCapacity(initialClusterCapacity)
+	,	mSize(0u)
+	,	mFirstcluster(nullptr)
+{
+	for (std::atomic<directory_entry*>& block : mDirectoryBlocks)
+	{
+		block.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::~concurrent_cluster_vector()
+{
+	clear();
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back(const T& value)
+{
+	return *::new (DoReserveSlot()) T(value);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back(T&& value)
+{
+	return *::new (DoReserveSlot()) T(std::move(value));
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename... Args>
+inline T&
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::emplace_back(Args&&... args)
+{
+	return *::new (DoReserveSlot()) T(std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::begin() const
+{
+	const_iterator i;
+	i.mSize = size();
+	i.DoEnterCluster(mFirstcluster.load(std::memory_order_acquire));
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::begin()
+{
+	iterator i;
+	i.mSize = size();
+	i.DoEnterCluster(mFirstcluster.load(std::memory_order_acquire));
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::end() const
+{
+	const_iterator i;
+	i.mCurrent = nullptr;
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::end()
+{
+	iterator i;
+	i.mCurrent = nullptr;
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size() const
+{
+	return mSize.load(std::memory_order_acquire);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::empty() const
+{
+	return size() == 0u;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_count() const
+{
+	size_type count = 0u;
+	for (cluster_type* cluster = mFirstcluster.load(std::memory_order_acquire); cluster; cluster = cluster->mNext.load(std::memory_order_acquire))
+	{
+		++count;
+	}
+	return count;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T&
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::operator[](size_type index) const
+{
+	cluster_type* cluster = DoCluster(GrowthPolicy::cluster_index(mInitialClusterCapacity, index));
+	return cluster->begin()[index - cluster->mStartIndex];
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::operator[](size_type index)
+{
+	cluster_type* cluster = DoCluster(GrowthPolicy::cluster_index(mInitialClusterCapacity, index));
+	return cluster->begin()[index - cluster->mStartIndex];
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::clear()
+{
+	size_type remaining = mSize.load(std::memory_order_acquire);
+	cluster_type* cluster = mFirstcluster.load(std::memory_order_acquire);
+	while (cluster)
+	{
+		cluster_type* next = cluster->mNext.load(std::memory_order_relaxed);
+		size_type const live = remaining < cluster->mCapacity ? remaining : cluster->mCapacity;
+		detail::destroy_run(cluster->begin(), cluster->begin() + live);
+		remaining -= live;
+		CLUSTERFree(mAllocator, cluster, cluster_type::allocation_size(cluster->mCapacity));
+		cluster = next;
+	}
+
+	for (size_type b = 0u; b < kDirectoryBlockCount; ++b)
+	{
+		if (directory_entry* block = mDirectoryBlocks[b].load(std::memory_order_relaxed))
+		{
+			size_type const blockSize = kFirstDirectoryBlockSize << b;
+			for (size_type i = 0u; i < blockSize; ++i)
+			{
+				block[i].~directory_entry();
+			}
+			CLUSTERFree(mAllocator, block, blockSize * sizeof(directory_entry));
+			mDirectoryBlocks[b].store(nullptr, std::memory_order_relaxed);
+		}
+	}
+	mFirstcluster.store(nullptr, std::memory_order_relaxed);
+	mSize.store(0u, std::memory_order_release);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T*
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoReserveSlot()
+{
+	size_type const index = mSize.fetch_add(1u, std::memory_order_relaxed);
+	cluster_type* cluster = DoAcquireCluster(GrowthPolicy::cluster_index(mInitialClusterCapacity, index));
+	return cluster->begin() + (index - cluster->mStartIndex);
+}
+
+//Looks up a cluster that is known to exist
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoCluster(size_type clusterIndex) const
+{
+	return DoDirectoryEntry(clusterIndex).load(std::memory_order_acquire);
+}
+
+//Returns the cluster, allocating it and any missing clusters before it. Each link is claimed by CAS, so racing threads agree on one cluster and the rest free theirs.
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoAcquireCluster(size_type clusterIndex)
+{
+	directory_entry& entry = DoDirectoryEntry(clusterIndex);
+	if (cluster_type* cluster = entry.load(std::memory_order_acquire))
+	{
+		return cluster;
+	}
+
+	cluster_type* previous = clusterIndex ? DoAcquireCluster(clusterIndex - 1u) : nullptr;
+	std::atomic<cluster_type*>& link = previous ? previous->mNext : mFirstcluster;
+	cluster_type* cluster = link.load(std::memory_order_acquire);
+	if (!cluster)
+	{
+		size_type const capacity = GrowthPolicy::cluster_capacity(mInitialClusterCapacity, clusterIndex, sizeof(T), cluster_type::data_offset());
+		cluster_type* newcluster = (cluster_type*)sw_allocate_memory(mAllocator, cluster_type::allocation_size(capacity), cluster_type::alignment(), 0);
+		::new (&newcluster->mNext) std::atomic<cluster_type*>(nullptr);
+		newcluster->mCapacity = capacity;
+		newcluster->mStartIndex = previous ? previous->mStartIndex + previous->mCapacity : 0u;
+		if (link.compare_exchange_strong(cluster, newcluster, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			cluster = newcluster;
+		}
+		else
+		{
+			newcluster->mNext.~atomic();
+			CLUSTERFree(mAllocator, newcluster, cluster_type::allocation_size(capacity));
+		}
+	}
+	//Every thread stores the same winner, so plain stores are enough
+	entry.store(cluster, std::memory_order_release);
+	return cluster;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+typename concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::directory_entry&
+concurrent_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoDirectoryEntry(size_type clusterIndex) const
+{
+	size_type const b = detail::floor_log<2u>(clusterIndex / kFirstDirectoryBlockSize + 1u);
+	size_type const blockStart = kFirstDirectoryBlockSize * ((size_type(1u) << b) - 1u);
+	std::atomic<directory_entry*>& blockLink = mDirectoryBlocks[b];
+
+	directory_entry* block = blockLink.load(std::memory_order_acquire);
+	if (CLUSTER_UNLIKELY(!block))
+	{
+		size_type const blockSize = kFirstDirectoryBlockSize << b;
+		directory_entry* newBlock = (directory_entry*)sw_allocate_memory(mAllocator, blockSize * sizeof(directory_entry), CLUSTER_ALIGN_OF(directory_entry), 0);
+		for (size_type i = 0u; i < blockSize; ++i)
+		{
+			::new (&newBlock[i]) directory_entry(nullptr);
+		}
+		if (blockLink.compare_exchange_strong(block, newBlock, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			block = newBlock;
+		}
+		else
+		{
+			for (size_type i = 0u; i < blockSize; ++i)
+			{
+				newBlock[i].~directory_entry();
+			}
+			CLUSTERFree(mAllocator, newBlock, blockSize * sizeof(directory_entry));
+		}
+	}
+	return block[clusterIndex - blockStart];
+}
+
+}
@@ -1,518 +1,1240 @@
-//-----------------------------------------------------------------------------
-//	The contents of this file is modified versions of EASTL source --
-//	https://github.com/electronicarts/EASTL
-//-----------------------------------------------------------------------------
-//	BSD 3-Clause License
-//	
-//	Copyright (c) 2019, Electronic Arts
-//	All rights reserved.
-//	
-//	Redistribution and use in source and binary forms, with or without
-//	modification, are permitted provided that the following conditions are met:
-//	
-//	1. Redistributions of source code must retain the above copyright notice, this
-//	list of conditions and the following disclaimer.
-//	
-//	2. Redistributions in binary form must reproduce the above copyright notice,
-//	this list of conditions and the following disclaimer in the documentation
-//	and/or other materials provided with the distribution.
-//	
-//	3. Neither the name of the copyright holder nor the names of its
-//	contributors may be used to endorse or promote products derived from
-//	this software without specific prior written permission.
-//	
-//	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
-//	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
-//	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-//	DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
-//	FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
-//	DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
-//	SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
-//	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
-//	OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
-//	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-//-----------------------------------------------------------------------------
-
-#pragma once 
-
-#include "Common.h"
-
-#include "ClusterVector.h"
-
-#include <type_traits>
-
-namespace sw
-{
-
-template <typename T>
-struct cluster_map_dense_storage;
-
-template <typename T>
-struct cluster_map_dense_storage
-{
-	cluster_map_dense_storage<T>**					mSparseIndexPtr;
-	sw::aligned_storage_t<sizeof(T), alignof(T)>	mData;
-};
-
-template <typename T>
-struct cluster_map_handle
-{
-	cluster_map_dense_storage<T>**		mSparseIndexPtr;
-	cluster_map_dense_storage<T>*		mElementPtr;
-};
-
-template <typename T> inline void		validate(cluster_map_handle<T>& handle);
-template <typename T> inline T&			at(cluster_map_handle<T>& handle);
-template <typename T> inline T const&	at_c(cluster_map_handle<T>& handle);
-template <typename T> inline bool		is_null(cluster_map_handle<T> handle);
-
-template <typename T>
-void validate(cluster_map_handle<T>& handle)
-{
-	cluster_map_dense_storage<T>* index = handle.mElementPtr;
-	if (index->mSparseIndexPtr != handle.mSparseIndexPtr)
-	{
-		//Update the element ptr
-		handle.mElementPtr = *(handle.mSparseIndexPtr);
-	}
-}
-
-template <typename T>
-T& at(cluster_map_handle<T>& handle)
-{
-	validate(handle);
-	return *reinterpret_cast<T*>(handle.mElementPtr->mData.mCharData);
-}
-
-template <typename T>
-T const& at_c(cluster_map_handle<T>& handle)
-{
-	validate(handle);
-	return *reinterpret_cast<T const*>(handle.mElementPtr->mData.mCharData);
-}
-
-template <typename T> 
-bool is_null(cluster_map_handle<T> handle)
-{
-	return handle.mElementPtr == nullptr;
-}
-
-template <typename T>
-struct cluster_type_helper
-{
-	using const_ver = typename std::conditional< std::is_const<T>::value, T, const T>::type;
-	using constless = typename std::conditional< std::is_const<T>::value, typename std::remove_const<T>::type, T>::type;
-	//using constless = T;
-	using inner_type = cluster_map_dense_storage<constless>;
-};
-
-
-template <typename T>
-struct cluster_map_dense_storage_iterator
-{
-public:
-	typedef cluster_map_dense_storage_iterator<T>										this_type;
-	typedef cluster_vector_iterator< typename cluster_type_helper<T>::inner_type>		vec_itr_type;
-
-	cluster_map_dense_storage_iterator() = default;
-	cluster_map_dense_storage_iterator(vec_itr_type const & currentElement, vec_itr_type const & lastElement);
-	
-	this_type&						operator=(vec_itr_type const &);
-
-	T*								operator->() const;
-	T&								operator*() const;
-
-	this_type&						operator++();
-	this_type						operator++(int);
-
-	vec_itr_type					mCurrentElement;
-	vec_itr_type					mLastElement;
-};
-
-template <typename T>
-inline typename cluster_map_handle<T> itr_to_handle(cluster_map_dense_storage_iterator<T> const * itr);
-
-template <typename T>
-typename cluster_map_handle<T> itr_to_handle(cluster_map_dense_storage_iterator<T> const * itr)
-{
-	using handle_type = cluster_map_handle<T>;
-	using itr_type = cluster_map_dense_storage_iterator<T>;
-	handle_type han{};
-	if (!itr->mCurrentElement.mCurrent)
-	{
-		return han;
-	}
-	han.mElementPtr = itr->mCurrentElement.mCurrent;
-	han.mSparseIndexPtr = han.mElementPtr->mSparseIndexPtr;
-	return han;
-}
-
-template <typename T, typename Allocator, size_t tStepSize = 2u>
-class cluster_map
-{
-public:
-
-	using this_type				= cluster_map<T, Allocator, tStepSize>;
-	using allocator_type		= Allocator;
-
-	using size_type				= size_t;
-	using storage_type			= cluster_map_dense_storage<T>;
-	using index_type			= cluster_map_dense_storage<T>*;
-	using handle_type			= cluster_map_handle<T>;
-
-	template <typename U>
-	using cluster_vector_type	= cluster_vector<U, Allocator, tStepSize>;
-
-	using storage_vector_type	= cluster_vector_type<storage_type>;
-	using storage_cluster_type	= typename storage_vector_type::cluster_type;
-	using const_iterator		= cluster_map_dense_storage_iterator<const T>;
-	using iterator				= cluster_map_dense_storage_iterator<T>;
-
-	using index_vector_type		= cluster_vector_type<index_type>;
-	using index_ptr_vector_type	= cluster_vector_type<index_type*>;
-
-	using value_type			= T;
-
-								cluster_map(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
-								cluster_map() : cluster_map(64u) {}
-	void						swap(this_type& other);
-
-	allocator_type&				get_allocator() {return mDenseStorage.get_allocator();}
-
-	const_iterator				begin() const
-	{
-		typename storage_vector_type::const_iterator itr = mDenseStorage.begin();	
-		typename storage_vector_type::iterator * unconstitr = (typename storage_vector_type::iterator *)(void*)&itr;
-		const_iterator i(*unconstitr, mDenseEnd);
-		return i;
-	}
-	iterator					begin() { iterator i(mDenseStorage.begin(), mDenseEnd); return i; }
-
-	const_iterator				end() const;
-	iterator					end();
-
-	size_type					size() const;
-	handle_type					front();
-	handle_type					back();
-
-	bool						empty() const {return begin() == end();}
-	void						clear();
-
-	void						swap_pos(iterator lhs, iterator rhs);
-	void						swap_pos(handle_type& lhs, handle_type& rhs);
-
-	template<typename... Args>
-	handle_type					insert(Args&&... args);
-
-	void						erase(handle_type& handle);
-	void						erase(iterator itr);
-
-	storage_vector_type const & dense_storage() const { return mDenseStorage; }
-	index_vector_type const &	sparse_indices() const { return mSparseIndices; }
-	index_ptr_vector_type const & unoccupied_list() const { return mUnoccupiedElements; }
-
-protected:
-
-	storage_vector_type				mDenseStorage;			//Store our data without any gaps or null elements, addresses are not stable. Intrusively stores a ptr back to the sparse Indices array.
-	index_vector_type				mSparseIndices;			//Store stable ptrs to the dense storage associated with this index. Null entries are nullptrs.
-	index_ptr_vector_type			mUnoccupiedElements;	//Store a list of removed sparse indices so that we have constant-time insertion
-	typename iterator::vec_itr_type	mDenseEnd;				//Itr to the last dense element + cluster
-};
-
-template<typename T>
-inline cluster_map_dense_storage_iterator<T>::cluster_map_dense_storage_iterator(vec_itr_type const& currentElement, vec_itr_type const & lastElement)
-	: mCurrentElement(currentElement)
-	, mLastElement(lastElement)
-{
-}
-
-template<typename T>
-inline typename cluster_map_dense_storage_iterator<T>::this_type&
-cluster_map_dense_storage_iterator<T>::operator=
-(
-	typename cluster_map_dense_storage_iterator<T>::vec_itr_type const& itr
-)
-{
-	mCurrentElement = itr;
-	return *this;
-}
-
-template<typename T>
-T*
-cluster_map_dense_storage_iterator<T>::operator->() const
-{
-	return reinterpret_cast<T*>(mCurrentElement->mData.mCharData);
-}
-
-template<typename T>
-T&
-cluster_map_dense_storage_iterator<T>::operator*() const
-{
-	return *reinterpret_cast<T*>(mCurrentElement->mData.mCharData);
-}
-
-template<typename T>
-cluster_map_dense_storage_iterator<T>&
-cluster_map_dense_storage_iterator<T>::operator++()
-{
-	if (CLUSTER_UNLIKELY(mCurrentElement.mCurrent + 1u == mLastElement.mCurrent))
-	{
-		mCurrentElement = mLastElement;
-	}
-	else
-	{
-		++mCurrentElement;
-	}
-	return *this;
-}
-
-template<typename T>
-cluster_map_dense_storage_iterator<T>
-cluster_map_dense_storage_iterator<T>::operator++(int)
-{
-	this_type i(*this);
-	operator++();
-	return i;
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline cluster_map<T, Allocator, tStepSize>::cluster_map(size_type initialClusterCapacity, const Allocator& allocator) :
-	mDenseStorage(initialClusterCapacity, allocator)
-	,mSparseIndices(initialClusterCapacity, allocator)
-	,mUnoccupiedElements(initialClusterCapacity, allocator)
-	,mDenseEnd{}
-{}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline void cluster_map<T, Allocator, tStepSize>::swap(this_type & other)
-{
-	mDenseStorage.swap(other.mDenseStorage);
-	mSparseIndices.swap(other.mSparseIndices);
-	mUnoccupiedElements.swap(other.mUnoccupiedElements);
-	mDenseEnd.swap(other.mDenseEnd);
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline typename cluster_map<T, Allocator, tStepSize>::iterator
-cluster_map<T, Allocator, tStepSize>::end()
-{
-	return iterator(mDenseEnd, mDenseEnd);
-}
-
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline typename cluster_map<T, Allocator, tStepSize>::const_iterator
-cluster_map<T, Allocator, tStepSize>::end() const
-{	
-	return const_iterator(mDenseEnd, mDenseEnd);
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline typename cluster_map<T, Allocator, tStepSize>::size_type
-cluster_map<T, Allocator, tStepSize>::size() const
-{
-	if (storage_cluster_type* cluster = mDenseEnd.mCluster)
-	{
-
-		size_t lastCapacity = cluster->capacity();
-		size_t powerDifference = lastCapacity / mDenseStorage.mInitialClusterCapacity;
-		uint32_t numDenseClusters = static_cast<uint32_t>(64 - CLUSTER_COUNT_LEADING_ZEROES(powerDifference));
-		size_t lastSize = mDenseEnd.mCurrent - cluster->begin();
-
-		//Geometric Series formula: Sn = a1(1-r^n) / (1-r)
-		size_t series_sum = detail::pow_table<tStepSize>::val[numDenseClusters - 1u];
-		size_t numerator = (mDenseStorage.mInitialClusterCapacity * (series_sum - 1));
-		size_t denominator = (tStepSize - 1);
-		size_t result = (numerator / denominator) + lastSize;
-		return result;
-	}
-	return 0;
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline typename cluster_map<T, Allocator, tStepSize>::handle_type
-cluster_map<T, Allocator, tStepSize>::front()
-{
-	iterator first = begin();
-	return handle_type
-	{
-		reinterpret_cast<cluster_map_dense_storage<T>**>(first.mCurrentElement->mSparseIndexPtr),
-		reinterpret_cast<cluster_map_dense_storage<T>*>(first.operator->())
-	};
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline typename cluster_map<T, Allocator, tStepSize>::handle_type
-cluster_map<T, Allocator, tStepSize>::back()
-{
-	storage_type* last = mDenseEnd.mCurrent - 1u;
-	return handle_type
-	{
-		reinterpret_cast<cluster_map_dense_storage<T>**>(last->mSparseIndexPtr),
-		reinterpret_cast<cluster_map_dense_storage<T>*>(last->mData.mCharData)
-	};
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline void cluster_map<T, Allocator, tStepSize>::clear()
-{
-	mDenseStorage.clear();
-	mSparseIndices.clear();
-	mUnoccupiedElements.clear();
-	mDenseEnd = mDenseStorage.end();
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline void cluster_map<T, Allocator, tStepSize>::swap_pos(iterator lhs, iterator rhs)
-{
-	storage_type& lh = *reinterpret_cast<storage_type*>(lhs.mCurrentElement.mCurrent);
-	storage_type& rh = *reinterpret_cast<storage_type*>(rhs.mCurrentElement.mCurrent);
-	index_type* lh_index_ptr = lh.mSparseIndexPtr;
-	index_type* rh_index_ptr = rh.mSparseIndexPtr;
-	std::swap(lh, rh);
-
-	//Patch up indexes for swapped elements
-	*lh.mSparseIndexPtr = &lh;
-	*rh.mSparseIndexPtr = &rh;
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline void cluster_map<T, Allocator, tStepSize>::swap_pos(handle_type& lhs, handle_type& rhs)
-{
-	validate(lhs);
-	validate(rhs);
-	storage_type& lh = *lhs.mElementPtr;
-	storage_type& rh = *rhs.mElementPtr;
-	index_type* lh_index_ptr = lh.mSparseIndexPtr;
-	index_type* rh_index_ptr = rh.mSparseIndexPtr;
-	std::swap(lh, rh);
-
-	//Patch up indexes for swapped elements
-	*lh.mSparseIndexPtr = &lh;
-	*rh.mSparseIndexPtr = &rh;
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-template<typename ...Args>
-inline typename cluster_map<T, Allocator, tStepSize>::handle_type
-cluster_map<T, Allocator, tStepSize>::insert(Args && ...args)
-{
-	index_type* index_ptr{};
-	index_type index{};
-
-	if(mUnoccupiedElements.empty())
-	{		
-		//No free space in our dense storage
-		typename storage_vector_type::iterator iter = mDenseStorage.push_back();
-		index = iter.mCurrent;
-		index_ptr = mSparseIndices.push_back(index).mCurrent;
-		//Points to the element
-		mDenseEnd = iter;
-		//Increment past the end
-		mDenseEnd.mCurrent++;
-	}
-	else
-	{
-		//Free space to be reused
-		index_ptr = mUnoccupiedElements.back();
-		mUnoccupiedElements.pop_back();
-		//We know there must be space after DenseEnd as there are unoccupied elements
-
-		//We increment like this to account for iterating between clusters
-		mDenseEnd.mCurrent--;
-		mDenseEnd++;
-		mDenseEnd.mCurrent++;
-
-		index = mDenseEnd.mCurrent - 1u;
-		*index_ptr = index;
-	}
-
-	index->mSparseIndexPtr = index_ptr;
-	new (&(index->mData)) T(std::forward<Args>(args)...);
-
-	return handle_type{index_ptr, index};
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline void cluster_map<T, Allocator, tStepSize>::erase(handle_type& handle)
-{
-	validate(handle);
-	//Swap
-	storage_type& target = *handle.mElementPtr;
-	storage_type& back = *(mDenseEnd.mCurrent - 1u);
-	std::swap(target, back);
-
-	//Destruct
-	reinterpret_cast<T*>(back.mData.mCharData)->~T();
-	index_type* index_ptr = back.mSparseIndexPtr;
-
-	//Patch up index for swapped live element
-	mUnoccupiedElements.push_back(index_ptr);
-	index_type* swapped_index_ptr = target.mSparseIndexPtr;
-	*swapped_index_ptr = &target;
-
-	//Pop
-	back.mSparseIndexPtr = nullptr;
-
-	//Decrement mDenseEnd
-	mDenseEnd.mCurrent--;
-	if (mDenseEnd.mCluster->begin() == mDenseEnd.mCurrent)
-	{
-		mDenseEnd.mCluster = (storage_cluster_type*)(mDenseEnd.mCluster->mPrev & (~storage_cluster_type::kIsLastCluster));
-		if (mDenseEnd.mCluster)
-		{
-			mDenseEnd.mCurrent = mDenseEnd.mEnd = mDenseEnd.mCluster->end();
-		}
-		else
-		{
-			mDenseEnd.mCurrent = mDenseEnd.mEnd = nullptr;
-		}
-	}
-}
-
-template<typename T, typename Allocator, size_t tStepSize>
-inline void cluster_map<T, Allocator, tStepSize>::erase(iterator itr)
-{
-	erase(handle_type{itr.mCurrent->mSparseIndexPtr, itr.operator->()});
-}
-
-template<typename T>
-inline bool operator==(const cluster_map_dense_storage_iterator<const T>& a, const cluster_map_dense_storage_iterator<const T>& b)
-{
-	return a.mCurrentElement == b.mCurrentElement;
-}
-
-
-template<typename T>
-inline bool operator!=(const cluster_map_dense_storage_iterator<const T>& a, const cluster_map_dense_storage_iterator<const T>& b)
-{
-	return a.mCurrentElement != b.mCurrentElement;
-}
-
-template<typename T>
-inline bool operator==(const cluster_map_dense_storage_iterator<T>& a, const cluster_map_dense_storage_iterator<T>& b)
-{
-	return a.mCurrentElement == b.mCurrentElement;
-}
-
-
-template<typename T>
-inline bool operator!=(const cluster_map_dense_storage_iterator<T>& a, const cluster_map_dense_storage_iterator<T>& b)
-{
-	return a.mCurrentElement != b.mCurrentElement;
-}
-
-template<typename T>
-inline bool operator==(const cluster_map_dense_storage_iterator<T>& a, const cluster_vector_iterator<cluster_map_dense_storage<T>>& b)
-{
-	return a.mCurrentElement == b.mCurrent;
-}
-
-template<typename T>
-inline bool operator!=(const cluster_vector_iterator<cluster_map_dense_storage<T>>& a, const cluster_map_dense_storage_iterator<T>& b)
-{
-	return a.mCurrent != b.mCurrentElement;
-}
-
-}
-
+//-----------------------------------------------------------------------------
+//	The contents of this file is modified versions of EASTL source --
+//	https://github.com/electronicarts/EASTL
+//-----------------------------------------------------------------------------
+//	BSD 3-Clause License
+//	
+//	Copyright (c) 2019, Electronic Arts
+//	All rights reserved.
+//	
+//	Redistribution and use in source and binary forms, with or without
+//	modification, are permitted provided that the following conditions are met:
+//	
+//	1. Redistributions of source code must retain the above copyright notice, this
+//	list of conditions and the following disclaimer.
+//	
+//	2. Redistributions in binary form must reproduce the above copyright notice,
+//	this list of conditions and the following disclaimer in the documentation
+//	and/or other materials provided with the distribution.
+//	
+//	3. Neither the name of the copyright holder nor the names of its
+//	contributors may be used to endorse or promote products derived from
+//	this software without specific prior written permission.
+//	
+//	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//	DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//	FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//	DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//	SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//	OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once 
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sw
+{
+
+// cluster_map_dense_storage
+//
+// Raw storage for one dense element, so a cluster of them is a contiguous
+// T array. The back link to each element's sparse slot is kept apart, in
+// the map's dense slots.
+//
+template <typename T>
+struct cluster_map_dense_storage
+{
+	sw::aligned_storage_t<sizeof(T), alignof(T)>	mData;
+};
+
+// cluster_map_sparse_index
+//
+// One slot of a cluster_map's sparse indices. mElement comes first, so a
+// pointer to the slot is also a pointer to its element pointer, which is
+// what handles hold. While the slot is occupied mDense is the element's
+// position in the dense storage, while it is free mDense is the slot's own
+// position in the sparse indices.
+//
+// On 64-bit targets a slot is 16 bytes, against the bare 8-byte element
+// pointer the sparse indices used to hold, and every slot pays it whether
+// live or free. mDense is what lets the dense storage hold plain T arrays,
+// and mGeneration sits where mDense's padding would otherwise be, so keys
+// cost no bytes of their own on top of that. compact_cluster_map keeps its
+// slots at 8 bytes when that overhead matters.
+//
+template <typename T>
+struct cluster_map_sparse_index
+{
+	T*									mElement;
+	uint32_t							mDense;
+	uint32_t							mGeneration;	//Bumped each time the slot's element is erased, never 0
+};
+
+template <typename T>
+struct cluster_map_handle
+{
+	T**									mSparseIndexPtr;
+	T*									mElementPtr;
+};
+
+// cluster_map_key
+//
+// A compact alternative to cluster_map_handle: the element's sparse slot and
+// the generation that slot had when the element was inserted. Half the size
+// of a handle, it resolves by indexing the sparse indices and stops resolving
+// once the element is erased, even after its slot is reused. A value
+// initialised key never resolves.
+//
+struct cluster_map_key
+{
+	uint32_t							mSlot;
+	uint32_t							mGeneration;
+};
+
+inline bool operator==(cluster_map_key a, cluster_map_key b) { return a.mSlot == b.mSlot && a.mGeneration == b.mGeneration; }
+inline bool operator!=(cluster_map_key a, cluster_map_key b) { return !(a == b); }
+
+namespace detail
+{
+	struct parallel_access;
+
+	//The generation a sparse slot moves to when its element is erased. 0 is skipped so a value initialised key never resolves.
+	inline uint32_t next_generation(uint32_t generation) { return generation + 1u ? generation + 1u : 1u; }
+}
+
+template <typename T> inline void		validate(cluster_map_handle<T>& handle);
+template <typename T> inline T&			at(cluster_map_handle<T>& handle);
+template <typename T> inline T const&	at_c(cluster_map_handle<T>& handle);
+template <typename T> inline bool		is_null(cluster_map_handle<T> handle);
+
+template <typename T>
+void validate(cluster_map_handle<T>& handle)
+{
+	//Always reload through the sparse index, compact() may have freed the storage the cached ptr points into
+	handle.mElementPtr = *(handle.mSparseIndexPtr);
+}
+
+template <typename T>
+T& at(cluster_map_handle<T>& handle)
+{
+	validate(handle);
+	return *handle.mElementPtr;
+}
+
+template <typename T>
+T const& at_c(cluster_map_handle<T>& handle)
+{
+	validate(handle);
+	return *handle.mElementPtr;
+}
+
+template <typename T> 
+bool is_null(cluster_map_handle<T> handle)
+{
+	return handle.mElementPtr == nullptr;
+}
+
+template <typename T>
+struct cluster_type_helper
+{
+	using const_ver = typename std::conditional< std::is_const<T>::value, T, const T>::type;
+	using constless = typename std::conditional< std::is_const<T>::value, typename std::remove_const<T>::type, T>::type;
+	//using constless = T;
+	using inner_type = cluster_map_dense_storage<constless>;
+};
+
+
+template <typename T>
+struct cluster_map_dense_storage_iterator
+{
+public:
+	typedef cluster_map_dense_storage_iterator<T>										this_type;
+	typedef cluster_vector_iterator< typename cluster_type_helper<T>::inner_type>		vec_itr_type;
+
+	cluster_map_dense_storage_iterator() = default;
+	cluster_map_dense_storage_iterator(vec_itr_type const & currentElement, vec_itr_type const & lastElement);
+	
+	this_type&						operator=(vec_itr_type const &);
+
+	T*								operator->() const;
+	T&								operator*() const;
+
+	this_type&						operator++();
+	this_type						operator++(int);
+
+	vec_itr_type					mCurrentElement;
+	vec_itr_type					mLastElement;
+};
+
+// The live elements of one dense storage cluster as a contiguous T span, see cluster_segment.
+template <typename T>
+struct cluster_map_segment
+{
+public:
+	using storage_type			= typename cluster_type_helper<T>::inner_type;
+	using cluster_type			= cluster<storage_type>;
+	using size_type				= size_t;
+	using iterator				= T*;
+	using container_iterator	= cluster_map_dense_storage_iterator<T>;
+
+	T*								begin() const { return mBegin; }
+	T*								end() const { return mEnd; }
+	size_type						size() const { return mEnd - mBegin; }
+	bool							empty() const { return mBegin == mEnd; }
+
+	//Iterator of the owning cluster_map pointing at an element of this segment
+	container_iterator				to_iterator(T* position) const;
+
+	cluster_type*					mCluster;
+	T*								mBegin;
+	T*								mEnd;
+	typename container_iterator::vec_itr_type	mLastElement;
+};
+
+template <typename T>
+struct cluster_map_segment_iterator
+{
+public:
+	using this_type			= cluster_map_segment_iterator<T>;
+	using storage_type		= typename cluster_type_helper<T>::inner_type;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= cluster_map_segment<T>;
+	using difference_type	= ptrdiff_t;
+	using pointer			= const value_type*;
+	using reference			= value_type;
+
+	value_type						operator*() const;
+
+	this_type&						operator++() { ++mSegment; return *this; }
+	this_type						operator++(int) { this_type i(*this); ++mSegment; return i; }
+
+	bool							operator==(this_type const & other) const { return mSegment == other.mSegment; }
+	bool							operator!=(this_type const & other) const { return mSegment != other.mSegment; }
+
+	cluster_segment_iterator<storage_type>							mSegment;
+	typename cluster_map_segment<T>::container_iterator::vec_itr_type	mLastElement;
+};
+
+template <typename T>
+inline typename cluster_map_segment<T>::container_iterator
+cluster_map_segment<T>::to_iterator(iterator position) const
+{
+	typename container_iterator::vec_itr_type current;
+	current.mCurrent = reinterpret_cast<storage_type*>(const_cast<typename cluster_type_helper<T>::constless*>(position));
+	current.mEnd = mCluster->end();
+	current.mCluster = mCluster;
+	return container_iterator(current, mLastElement);
+}
+
+template <typename T>
+inline typename cluster_map_segment_iterator<T>::value_type
+cluster_map_segment_iterator<T>::operator*() const
+{
+	cluster_segment<storage_type> storage = *mSegment;
+	value_type segment;
+	segment.mCluster = storage.mCluster;
+	segment.mBegin = reinterpret_cast<T*>(storage.mBegin);
+	segment.mEnd = reinterpret_cast<T*>(storage.mEnd);
+	segment.mLastElement = mLastElement;
+	return segment;
+}
+
+template <typename T, typename Allocator, size_t tStepSize = 2u, typename GrowthPolicy = geometric_growth<tStepSize>>
+class cluster_map
+{
+	friend struct detail::snapshot_access;
+	friend struct detail::parallel_access;
+
+public:
+
+	using this_type				= cluster_map<T, Allocator, tStepSize, GrowthPolicy>;
+	using allocator_type		= Allocator;
+
+	using size_type				= size_t;
+	using storage_type			= cluster_map_dense_storage<T>;
+	using index_type			= T*;
+	using sparse_index_type		= cluster_map_sparse_index<T>;
+	using handle_type			= cluster_map_handle<T>;
+	using key_type				= cluster_map_key;
+
+	template <typename U>
+	using cluster_vector_type	= cluster_vector<U, Allocator, tStepSize, GrowthPolicy>;
+
+	using storage_vector_type	= cluster_vector_type<storage_type>;
+	using storage_cluster_type	= typename storage_vector_type::cluster_type;
+	using const_iterator		= cluster_map_dense_storage_iterator<const T>;
+	using iterator				= cluster_map_dense_storage_iterator<T>;
+
+	using index_vector_type		= cluster_vector_type<sparse_index_type>;
+	using index_ptr_vector_type	= cluster_vector_type<index_type*>;
+	using dense_slot_vector_type	= cluster_vector_type<uint32_t>;
+	using segment_range			= cluster_segment_range<cluster_map_segment_iterator<T>>;
+	using const_segment_range	= cluster_segment_range<cluster_map_segment_iterator<const T>>;
+
+	using value_type			= T;
+
+	//Dense positions and sparse slot numbers are 32-bit, so a map holds fewer than kNoSlot elements
+	static const uint32_t		kNoSlot = 0xFFFFFFFFu;
+
+								cluster_map(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
+								cluster_map() : cluster_map(64u) {}
+								cluster_map(this_type&& other);
+								~cluster_map();
+
+								cluster_map(this_type const &) = delete;
+	this_type&					operator=(this_type const &) = delete;
+
+	void						swap(this_type& other);
+
+	allocator_type&				get_allocator() {return mDenseStorage.get_allocator();}
+
+	const_iterator				begin() const
+	{
+		//The dense storage keeps its slots once every element is erased, so only mDenseEnd tells whether anything is live
+		if (!mDenseEnd.mCluster)
+		{
+			return end();
+		}
+		typename storage_vector_type::const_iterator itr = mDenseStorage.begin();	
+		typename storage_vector_type::iterator * unconstitr = (typename storage_vector_type::iterator *)(void*)&itr;
+		const_iterator i(*unconstitr, mDenseEnd);
+		return i;
+	}
+	iterator					begin() { iterator i(mDenseEnd.mCluster ? mDenseStorage.begin() : mDenseEnd, mDenseEnd); return i; }
+
+	const_iterator				end() const;
+	iterator					end();
+
+	//The live elements of each dense storage cluster as a contiguous T span, see cluster_segment
+	const_segment_range			segments() const;
+	segment_range				segments();
+	//The runs covering only the dense elements with positions in [first, last)
+	const_segment_range			segments(size_type first, size_type last) const;
+	segment_range				segments(size_type first, size_type last);
+	//The live run of the dense storage cluster at position clusterIndex, found through the cluster directory. Valid for clusterIndex < segment_count().
+	size_type					segment_count() const;
+	cluster_map_segment<const T> segment(size_type clusterIndex) const;
+	cluster_map_segment<T>		segment(size_type clusterIndex);
+
+	size_type					size() const;
+	size_type					capacity() const;
+	handle_type					front();
+	handle_type					back();
+
+	bool						empty() const {return begin() == end();}
+	void						clear();
+
+	//Pre-allocates dense storage, sparse indices and the free list so that the first count live elements never allocate
+	void						reserve(size_type count);
+	//Relocates the live elements into one contiguous dense storage cluster of exactly size() and rewrites the sparse indices, so handles stay valid
+	void						compact();
+	//Frees the dense clusters past the last live element and any reservation, drops the free sparse slots at the back of the sparse indices
+	//and trims the free list to match. Free slots below the last live one stay, handles to the slots after them pin them in place.
+	void						shrink_to_fit();
+	//Once set, erase() calls shrink_to_fit() when fewer than factor * capacity() elements are live and a whole dense cluster can be freed.
+	//Keep it well under 0.5 so a map that regrows does not shrink again straight away. 0, the default, never shrinks.
+	float						shrink_load_factor() const { return mShrinkLoadFactor; }
+	void						set_shrink_load_factor(float factor);
+
+	void						swap_pos(iterator lhs, iterator rhs);
+	void						swap_pos(handle_type& lhs, handle_type& rhs);
+
+	template<typename... Args>
+	handle_type					insert(Args&&... args);
+	//Inserts count elements each constructed from args, writing their handles to out. Free slots are reused first and the rest are appended a cluster run at a time.
+	template<typename OutputIterator, typename... Args>
+	OutputIterator				insert_n(size_type count, OutputIterator out, Args const&... args);
+	//As insert_n, constructing one element from each of [first, last)
+	template<typename ForwardIterator, typename OutputIterator>
+	OutputIterator				insert_range(ForwardIterator first, ForwardIterator last, OutputIterator out);
+
+	void						erase(handle_type& handle);
+	void						erase(iterator itr);
+	//Erases the element of every handle in [first, last), each of which must be live and distinct. Holes below the new end are filled from the surviving elements of the dense tail, so only those are moved, each once and in order.
+	template<typename HandleIterator>
+	void						erase_batch(HandleIterator first, HandleIterator last);
+
+	//Compact handles, see cluster_map_key. Resolving a key indexes the sparse indices, so it costs one directory lookup.
+	key_type					key_of(handle_type const & handle) const;
+	bool						contains(key_type key) const;
+	//The element, or nullptr if it has been erased
+	const T*					find(key_type key) const;
+	T*							find(key_type key);
+	//A handle to the element, or a null handle if it has been erased
+	handle_type					to_handle(key_type key);
+	//A handle to the element at itr, which must be live
+	handle_type					to_handle(iterator itr);
+	//Returns false if the element had already been erased
+	bool						erase(key_type key);
+
+	storage_vector_type const & dense_storage() const { return mDenseStorage; }
+	index_vector_type const &	sparse_indices() const { return mSparseIndices; }
+	index_ptr_vector_type const & unoccupied_list() const { return mUnoccupiedElements; }
+	dense_slot_vector_type const & dense_slots() const { return mDenseSlots; }
+
+protected:
+	void							DoDestroyElements(std::true_type) {}
+	void							DoDestroyElements(std::false_type);
+	sparse_index_type const *		DoFindSlot(key_type key) const;
+	static sparse_index_type*		DoSlotOf(index_type* index_ptr) { return reinterpret_cast<sparse_index_type*>(index_ptr); }
+	void							DoRetireSlot(sparse_index_type* slot);
+	static size_type				DoPositionOf(storage_type const * element, storage_cluster_type const * cluster) { return cluster->mStartIndex + (element - cluster->begin()); }
+	handle_type						DoHandleAt(size_type position);
+	void							DoSwapPositions(T* lhs, size_type lhsPosition, T* rhs, size_type rhsPosition);
+	void							DoCheckSize(size_type count) const;
+	template<typename Construct, typename OutputIterator>
+	OutputIterator					DoInsertRun(size_type count, Construct construct, OutputIterator out);
+	void							DoSetDenseEnd(size_type count);
+	void							DoShrinkIfSparse();
+
+	storage_vector_type				mDenseStorage;			//Store our data without any gaps or null elements, addresses are not stable. Each cluster is a contiguous T array.
+	dense_slot_vector_type			mDenseSlots;			//Sparse slot number of each live dense element, in dense order, so relocating an element can patch its slot
+	index_vector_type				mSparseIndices;			//Store stable ptrs to the dense storage associated with this index, and the element's dense position
+	index_ptr_vector_type			mUnoccupiedElements;	//Store a list of removed sparse indices so that we have constant-time insertion
+	typename iterator::vec_itr_type	mDenseEnd;				//Itr to the last dense element + cluster
+	uint32_t						mNextSlotGeneration;	//Generation of newly added sparse slots. No slot has had a later one, and erased slots are kept below it.
+	float							mShrinkLoadFactor;		//See set_shrink_load_factor
+};
+
+template<typename T>
+inline cluster_map_dense_storage_iterator<T>::cluster_map_dense_storage_iterator(vec_itr_type const& currentElement, vec_itr_type const & lastElement)
+	: mCurrentElement(currentElement)
+	, mLastElement(lastElement)
+{
+}
+
+template<typename T>
+inline typename cluster_map_dense_storage_iterator<T>::this_type&
+cluster_map_dense_storage_iterator<T>::operator=
+(
+	typename cluster_map_dense_storage_iterator<T>::vec_itr_type const& itr
+)
+{
+	mCurrentElement = itr;
+	return *this;
+}
+
+template<typename T>
+T*
+cluster_map_dense_storage_iterator<T>::operator->() const
+{
+	return reinterpret_cast<T*>(mCurrentElement->mData.mCharData);
+}
+
+template<typename T>
+T&
+cluster_map_dense_storage_iterator<T>::operator*() const
+{
+	return *reinterpret_cast<T*>(mCurrentElement->mData.mCharData);
+}
+
+template<typename T>
+cluster_map_dense_storage_iterator<T>&
+cluster_map_dense_storage_iterator<T>::operator++()
+{
+	if (CLUSTER_UNLIKELY(mCurrentElement.mCurrent + 1u == mLastElement.mCurrent))
+	{
+		mCurrentElement = mLastElement;
+	}
+	else
+	{
+		++mCurrentElement;
+	}
+	return *this;
+}
+
+template<typename T>
+cluster_map_dense_storage_iterator<T>
+cluster_map_dense_storage_iterator<T>::operator++(int)
+{
+	this_type i(*this);
+	operator++();
+	return i;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_map<T, Allocator, tStepSize, GrowthPolicy>::cluster_map(size_type initialClusterCapacity, const Allocator& allocator) :
+	mDenseStorage(initialClusterCapacity, allocator)
+	,mDenseSlots(initialClusterCapacity, allocator)
+	,mSparseIndices(initialClusterCapacity, allocator)
+	,mUnoccupiedElements(initialClusterCapacity, allocator)
+	,mDenseEnd{}
+	,mNextSlotGeneration(1u)
+	,mShrinkLoadFactor(0.0f)
+{}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_map<T, Allocator, tStepSize, GrowthPolicy>::cluster_map(this_type&& other) :
+	mDenseStorage(std::move(other.mDenseStorage))
+	,mDenseSlots(std::move(other.mDenseSlots))
+	,mSparseIndices(std::move(other.mSparseIndices))
+	,mUnoccupiedElements(std::move(other.mUnoccupiedElements))
+	,mDenseEnd(other.mDenseEnd)
+	,mNextSlotGeneration(other.mNextSlotGeneration)
+	,mShrinkLoadFactor(other.mShrinkLoadFactor)
+{
+	other.mDenseEnd = typename iterator::vec_itr_type{};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_map<T, Allocator, tStepSize, GrowthPolicy>::~cluster_map()
+{
+	DoDestroyElements(std::is_trivially_destructible<T>());
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::swap(this_type & other)
+{
+	mDenseStorage.swap(other.mDenseStorage);
+	mDenseSlots.swap(other.mDenseSlots);
+	mSparseIndices.swap(other.mSparseIndices);
+	mUnoccupiedElements.swap(other.mUnoccupiedElements);
+	std::swap(mDenseEnd, other.mDenseEnd);
+	std::swap(mNextSlotGeneration, other.mNextSlotGeneration);
+	std::swap(mShrinkLoadFactor, other.mShrinkLoadFactor);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::end()
+{
+	return iterator(mDenseEnd, mDenseEnd);
+}
+
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::end() const
+{	
+	return const_iterator(mDenseEnd, mDenseEnd);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::const_segment_range
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segments() const
+{
+	const_segment_range range{};
+	if (storage_cluster_type* lastCluster = mDenseEnd.mCluster)
+	{
+		range.mBegin.mSegment.mCluster = const_cast<storage_cluster_type*>(mDenseStorage.first_cluster());
+		range.mBegin.mSegment.mBegin = range.mBegin.mSegment.mCluster->begin();
+		range.mBegin.mSegment.mLastCluster = lastCluster;
+		range.mBegin.mSegment.mLastEnd = mDenseEnd.mCurrent;
+		range.mBegin.mLastElement = mDenseEnd;
+		range.mEnd.mLastElement = mDenseEnd;
+	}
+	return range;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segment_range
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segments()
+{
+	segment_range range{};
+	if (storage_cluster_type* lastCluster = mDenseEnd.mCluster)
+	{
+		range.mBegin.mSegment.mCluster = mDenseStorage.first_cluster();
+		range.mBegin.mSegment.mBegin = range.mBegin.mSegment.mCluster->begin();
+		range.mBegin.mSegment.mLastCluster = lastCluster;
+		range.mBegin.mSegment.mLastEnd = mDenseEnd.mCurrent;
+		range.mBegin.mLastElement = mDenseEnd;
+		range.mEnd.mLastElement = mDenseEnd;
+	}
+	return range;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::const_segment_range
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segments(size_type first, size_type last) const
+{
+	const_segment_range range{};
+	range.mBegin.mSegment = const_cast<storage_vector_type&>(mDenseStorage).segments(first, last).mBegin;
+	range.mBegin.mLastElement = mDenseEnd;
+	range.mEnd.mLastElement = mDenseEnd;
+	return range;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segment_range
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segments(size_type first, size_type last)
+{
+	segment_range range{};
+	range.mBegin.mSegment = mDenseStorage.segments(first, last).mBegin;
+	range.mBegin.mLastElement = mDenseEnd;
+	range.mEnd.mLastElement = mDenseEnd;
+	return range;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segment_count() const
+{
+	//Clusters past the one holding the last live element only hold free slots
+	return mDenseEnd.mCluster ? mDenseStorage.DoLocateClusterIndex(size() - 1u) + 1u : 0u;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_map_segment<const T>
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segment(size_type clusterIndex) const
+{
+	cluster_map_segment<const T> segment;
+	segment.mCluster = mDenseStorage.mClusterDirectory[clusterIndex];
+	segment.mBegin = reinterpret_cast<const T*>(segment.mCluster->begin());
+	segment.mEnd = reinterpret_cast<const T*>(segment.mCluster == mDenseEnd.mCluster ? mDenseEnd.mCurrent : segment.mCluster->end());
+	segment.mLastElement = mDenseEnd;
+	return segment;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_map_segment<T>
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::segment(size_type clusterIndex)
+{
+	cluster_map_segment<T> segment;
+	segment.mCluster = mDenseStorage.mClusterDirectory[clusterIndex];
+	segment.mBegin = reinterpret_cast<T*>(segment.mCluster->begin());
+	segment.mEnd = reinterpret_cast<T*>(segment.mCluster == mDenseEnd.mCluster ? mDenseEnd.mCurrent : segment.mCluster->end());
+	segment.mLastElement = mDenseEnd;
+	return segment;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::size() const
+{
+	if (storage_cluster_type* cluster = mDenseEnd.mCluster)
+	{
+		return cluster->mStartIndex + (mDenseEnd.mCurrent - cluster->begin());
+	}
+	return 0;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::capacity() const
+{
+	return mDenseStorage.capacity();
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::handle_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::front()
+{
+	return DoHandleAt(0u);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::handle_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::back()
+{
+	return DoHandleAt(size() - 1u);
+}
+
+//The dense slots name the element's sparse slot, which holds the element pointer
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::handle_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoHandleAt(size_type position)
+{
+	sparse_index_type& slot = mSparseIndices[mDenseSlots[position]];
+	return handle_type{&slot.mElement, slot.mElement};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::clear()
+{
+	DoDestroyElements(std::is_trivially_destructible<T>());
+	//No slot has a generation past mNextSlotGeneration, so moving it on once keeps keys into the dropped slots from matching the slots that replace them
+	mNextSlotGeneration = detail::next_generation(mNextSlotGeneration);
+	mDenseStorage.clear();
+	mDenseSlots.clear();
+	mSparseIndices.clear();
+	mUnoccupiedElements.clear();
+	mDenseEnd = typename iterator::vec_itr_type{};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::compact()
+{
+	size_type count = size();
+	//Slots past the dense end hold no objects, so they are dropped rather than carried into the new block
+	mDenseStorage.DoTruncate(count);
+	typename dense_slot_vector_type::iterator link = mDenseSlots.begin();
+	mDenseStorage.DoCompact([this, &link](storage_type* dest, storage_type* source, size_type runLength)
+	{
+		for (storage_type* e = source + runLength; source != e; ++source, ++dest, ++link)
+		{
+			detail::relocate(reinterpret_cast<T*>(&dest->mData), reinterpret_cast<T*>(&source->mData));
+			mSparseIndices[*link].mElement = reinterpret_cast<T*>(&dest->mData);
+		}
+	});
+	mDenseSlots.compact();
+
+	mDenseEnd = typename iterator::vec_itr_type{};
+	if (count)
+	{
+		mDenseEnd = mDenseStorage.begin();
+		mDenseEnd.mCurrent += count;
+	}
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::shrink_to_fit()
+{
+	//Slots past the dense end hold no objects
+	mDenseStorage.DoTruncate(size());
+	mDenseStorage.shrink_to_fit();
+	mDenseSlots.shrink_to_fit();
+
+	//Mark the free sparse slots, a live slot always points at its element
+	for (auto segment : mUnoccupiedElements.segments())
+	{
+		for (index_type** i = segment.begin(); i != segment.end(); ++i)
+		{
+			**i = nullptr;
+		}
+	}
+	size_type sparseCount = mSparseIndices.size();
+	while (sparseCount && !mSparseIndices[sparseCount - 1u].mElement)
+	{
+		--sparseCount;
+	}
+	if (sparseCount != mSparseIndices.size())
+	{
+		//Keep the free list in order, minus the dropped slots
+		size_type kept = 0u;
+		for (auto segment : mUnoccupiedElements.segments())
+		{
+			for (index_type** i = segment.begin(); i != segment.end(); ++i)
+			{
+				if (DoSlotOf(*i)->mDense < sparseCount)
+				{
+					mUnoccupiedElements[kept++] = *i;
+				}
+			}
+		}
+		mUnoccupiedElements.resize(kept);
+		mSparseIndices.resize(sparseCount);
+	}
+	mSparseIndices.shrink_to_fit();
+	mUnoccupiedElements.shrink_to_fit();
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::set_shrink_load_factor(float factor)
+{
+	mShrinkLoadFactor = factor;
+	DoShrinkIfSparse();
+}
+
+//Only shrinks when a dense cluster past the one holding the last live element can go, so the next erase does not shrink again
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoShrinkIfSparse()
+{
+	//The default never shrinks, so erase does not read the capacity at all
+	if (CLUSTER_LIKELY(mShrinkLoadFactor == 0.0f))
+	{
+		return;
+	}
+	size_type capacity = mDenseStorage.capacity();
+	if (CLUSTER_LIKELY(static_cast<float>(size()) >= mShrinkLoadFactor * static_cast<float>(capacity)))
+	{
+		return;
+	}
+	storage_cluster_type* cluster = mDenseEnd.mCluster;
+	if (!cluster || cluster->mStartIndex + cluster->capacity() < capacity)
+	{
+		shrink_to_fit();
+	}
+}
+
+//Destroys the live prefix of the dense storage, the slots past mDenseEnd hold no objects
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoDestroyElements(std::false_type)
+{
+	for (auto segment : segments())
+	{
+		for (T* i = segment.mBegin; i != segment.mEnd; ++i)
+		{
+			i->~T();
+		}
+	}
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::reserve(size_type count)
+{
+	mDenseStorage.reserve(count);
+	mDenseSlots.reserve(count);
+	mSparseIndices.reserve(count);
+	//Every live element could be erased before the next insert, so the free list needs the same room
+	mUnoccupiedElements.reserve(count);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::swap_pos(iterator lhs, iterator rhs)
+{
+	DoSwapPositions(lhs.operator->(), DoPositionOf(lhs.mCurrentElement.mCurrent, lhs.mCurrentElement.mCluster),
+		rhs.operator->(), DoPositionOf(rhs.mCurrentElement.mCurrent, rhs.mCurrentElement.mCluster));
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::swap_pos(handle_type& lhs, handle_type& rhs)
+{
+	validate(lhs);
+	validate(rhs);
+	DoSwapPositions(lhs.mElementPtr, DoSlotOf(lhs.mSparseIndexPtr)->mDense, rhs.mElementPtr, DoSlotOf(rhs.mSparseIndexPtr)->mDense);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoSwapPositions(T* lhs, size_type lhsPosition, T* rhs, size_type rhsPosition)
+{
+	detail::swap_elements(lhs, rhs);
+	uint32_t& lhsLink = mDenseSlots[lhsPosition];
+	uint32_t& rhsLink = mDenseSlots[rhsPosition];
+	std::swap(lhsLink, rhsLink);
+
+	//Patch up indexes for swapped elements
+	sparse_index_type& lhsSlot = mSparseIndices[lhsLink];
+	lhsSlot.mElement = lhs;
+	lhsSlot.mDense = static_cast<uint32_t>(lhsPosition);
+	sparse_index_type& rhsSlot = mSparseIndices[rhsLink];
+	rhsSlot.mElement = rhs;
+	rhsSlot.mDense = static_cast<uint32_t>(rhsPosition);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoCheckSize(size_type count) const
+{
+#if CLUSTER_EXCEPTIONS_ENABLED
+	if (CLUSTER_UNLIKELY(count >= kNoSlot))
+		throw std::length_error("cluster_map::insert -- 32-bit index space exhausted");
+#elif CLUSTER_ASSERT_ENABLED
+	if (CLUSTER_UNLIKELY(count >= kNoSlot))
+		CLUSTER_ASSERT("cluster_map::insert -- 32-bit index space exhausted");
+#else
+	CLUSTER_UNUSED(count);
+#endif
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template<typename ...Args>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::handle_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::insert(Args && ...args)
+{
+	uint32_t denseIndex = static_cast<uint32_t>(size());
+	DoCheckSize(size_type(denseIndex) + 1u);
+	index_type* index_ptr{};
+	index_type index{};
+	uint32_t slotNumber;
+
+	if(mUnoccupiedElements.empty())
+	{		
+		//No free space in our dense storage
+		typename storage_vector_type::iterator iter = mDenseStorage.push_back();
+		index = reinterpret_cast<T*>(&iter.mCurrent->mData);
+		slotNumber = static_cast<uint32_t>(mSparseIndices.size());
+		index_ptr = &mSparseIndices.push_back(sparse_index_type{index, denseIndex, mNextSlotGeneration}).mCurrent->mElement;
+		//Points to the element
+		mDenseEnd = iter;
+		//Increment past the end
+		mDenseEnd.mCurrent++;
+	}
+	else
+	{
+		//Free space to be reused
+		index_ptr = mUnoccupiedElements.back();
+		mUnoccupiedElements.pop_back();
+		//There is space after DenseEnd for every unoccupied element, unless compact() trimmed the dense storage
+		if (CLUSTER_UNLIKELY(size() == mDenseStorage.size()))
+		{
+			mDenseEnd = mDenseStorage.push_back();
+			mDenseEnd.mCurrent++;
+		}
+		else if (mDenseEnd.mCluster)
+		{
+			//We increment like this to account for iterating between clusters
+			mDenseEnd.mCurrent--;
+			mDenseEnd++;
+			mDenseEnd.mCurrent++;
+		}
+		else
+		{
+			//Every element was erased, so start again from the first dense element
+			mDenseEnd = mDenseStorage.begin();
+			mDenseEnd.mCurrent++;
+		}
+
+		index = reinterpret_cast<T*>(&(mDenseEnd.mCurrent - 1u)->mData);
+		sparse_index_type* slot = DoSlotOf(index_ptr);
+		slotNumber = slot->mDense;
+		slot->mElement = index;
+		slot->mDense = denseIndex;
+	}
+
+	mDenseSlots.push_back(slotNumber);
+	new (index) T(std::forward<Args>(args)...);
+
+	return handle_type{index_ptr, index};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template<typename OutputIterator, typename ...Args>
+inline OutputIterator
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::insert_n(size_type count, OutputIterator out, Args const& ...args)
+{
+	return DoInsertRun(count, [&args...](T* element) { new (element) T(args...); }, out);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template<typename ForwardIterator, typename OutputIterator>
+inline OutputIterator
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::insert_range(ForwardIterator first, ForwardIterator last, OutputIterator out)
+{
+	size_type count = static_cast<size_type>(std::distance(first, last));
+	return DoInsertRun(count, [&first](T* element) { new (element) T(*first); ++first; }, out);
+}
+
+//Fills dense positions [size(), size() + count), taking sparse slots from the back of the free list first and appending fresh ones after
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template<typename Construct, typename OutputIterator>
+inline OutputIterator
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoInsertRun(size_type count, Construct construct, OutputIterator out)
+{
+	if (!count)
+	{
+		return out;
+	}
+
+	size_type live = size();
+	size_type newLive = live + count;
+	DoCheckSize(newLive);
+	size_type freeCount = mUnoccupiedElements.size();
+	size_type reuseCount = count < freeCount ? count : freeCount;
+	size_type freshCount = count - reuseCount;
+
+	//The dense storage holds a slot past the end for each free sparse slot unless compact() trimmed them, so only the shortfall is appended
+	for (size_type missing = newLive > mDenseStorage.size() ? newLive - mDenseStorage.size() : 0u; missing; )
+	{
+		size_type runLength;
+		mDenseStorage.DoAppendRun(missing, runLength);
+		missing -= runLength;
+	}
+
+	size_type offset;
+	storage_cluster_type* denseCluster = mDenseStorage.DoLocate(live, offset);
+	storage_type* dense = denseCluster->begin() + offset;
+	storage_type* denseEnd = denseCluster->end();
+	uint32_t denseIndex = static_cast<uint32_t>(live);
+	uint32_t* link = nullptr;
+	size_type linkRun = 0u;
+	auto place = [&](index_type* index_ptr, uint32_t slotNumber)
+	{
+		if (dense == denseEnd)
+		{
+			denseCluster = denseCluster->next_cluster();
+			dense = denseCluster->begin();
+			denseEnd = denseCluster->end();
+		}
+		if (!linkRun)
+		{
+			link = mDenseSlots.DoAppendRun(newLive - denseIndex, linkRun);
+		}
+		T* element = reinterpret_cast<T*>(&dense->mData);
+		sparse_index_type* slot = DoSlotOf(index_ptr);
+		slot->mElement = element;
+		slot->mDense = denseIndex++;
+		*link++ = slotNumber;
+		--linkRun;
+		construct(element);
+		*out = handle_type{index_ptr, element};
+		++out;
+		++dense;
+	};
+
+	for (auto segment : mUnoccupiedElements.segments(freeCount - reuseCount, freeCount))
+	{
+		for (index_type** i = segment.begin(); i != segment.end(); ++i)
+		{
+			place(*i, DoSlotOf(*i)->mDense);
+		}
+	}
+	mUnoccupiedElements.resize(freeCount - reuseCount);
+
+	uint32_t slotNumber = static_cast<uint32_t>(mSparseIndices.size());
+	while (freshCount)
+	{
+		size_type runLength;
+		sparse_index_type* run = mSparseIndices.DoAppendRun(freshCount, runLength);
+		for (sparse_index_type* e = run + runLength; run != e; ++run)
+		{
+			new (run) sparse_index_type{nullptr, 0u, mNextSlotGeneration};
+			place(&run->mElement, slotNumber++);
+		}
+		freshCount -= runLength;
+	}
+
+	DoSetDenseEnd(newLive);
+	return out;
+}
+
+//Points mDenseEnd one past the dense element at position count - 1, the way insert and erase leave it
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoSetDenseEnd(size_type count)
+{
+	mDenseEnd = typename iterator::vec_itr_type{};
+	if (count)
+	{
+		size_type offset;
+		mDenseEnd.mCluster = mDenseStorage.DoLocate(count - 1u, offset);
+		mDenseEnd.mCurrent = mDenseEnd.mCluster->begin() + offset + 1u;
+		mDenseEnd.mEnd = mDenseEnd.mCluster->end();
+	}
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::erase(handle_type& handle)
+{
+	validate(handle);
+	T* target = handle.mElementPtr;
+	T* back = reinterpret_cast<T*>(&(mDenseEnd.mCurrent - 1u)->mData);
+	sparse_index_type* slot = DoSlotOf(handle.mSparseIndexPtr);
+	uint32_t position = slot->mDense;
+	uint32_t& link = mDenseSlots[position];
+	uint32_t slotNumber = link;
+
+	//Destruct, then relocate the back element into the hole to keep the dense storage packed
+	target->~T();
+	if (target != back)
+	{
+		detail::relocate(target, back);
+		//Patch up index for the relocated live element
+		link = mDenseSlots.back();
+		sparse_index_type& moved = mSparseIndices[link];
+		moved.mElement = target;
+		moved.mDense = position;
+	}
+	mDenseSlots.pop_back();
+	//A free slot remembers its own number in mDense
+	slot->mDense = slotNumber;
+	mUnoccupiedElements.push_back(handle.mSparseIndexPtr);
+	DoRetireSlot(slot);
+
+	//Decrement mDenseEnd
+	mDenseEnd.mCurrent--;
+	if (mDenseEnd.mCluster->begin() == mDenseEnd.mCurrent)
+	{
+		mDenseEnd.mCluster = (storage_cluster_type*)(mDenseEnd.mCluster->mPrev & (~storage_cluster_type::kIsLastCluster));
+		if (mDenseEnd.mCluster)
+		{
+			mDenseEnd.mCurrent = mDenseEnd.mEnd = mDenseEnd.mCluster->end();
+		}
+		else
+		{
+			mDenseEnd.mCurrent = mDenseEnd.mEnd = nullptr;
+		}
+	}
+	DoShrinkIfSparse();
+}
+
+//Keys to the erased element stop resolving. mNextSlotGeneration stays past the new generation, so shrink_to_fit() can drop
+//free slots without checking what keys into them still hold.
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoRetireSlot(sparse_index_type* slot)
+{
+	slot->mGeneration = detail::next_generation(slot->mGeneration);
+	if (slot->mGeneration >= mNextSlotGeneration)
+	{
+		mNextSlotGeneration = detail::next_generation(slot->mGeneration);
+	}
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::erase(iterator itr)
+{
+	handle_type handle = to_handle(itr);
+	erase(handle);
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template<typename HandleIterator>
+inline void cluster_map<T, Allocator, tStepSize, GrowthPolicy>::erase_batch(HandleIterator first, HandleIterator last)
+{
+	size_type eraseCount = static_cast<size_type>(std::distance(first, last));
+	if (!eraseCount)
+	{
+		return;
+	}
+	size_type live = size();
+	size_type newLive = live - eraseCount;
+
+	//First drop the targets in the tail past the new end, clearing their back links so the survivors there can be told apart,
+	//and nulling their element pointers so the second pass skips them.
+	for (HandleIterator i = first; i != last; ++i)
+	{
+		index_type* index_ptr = (*i).mSparseIndexPtr;
+		sparse_index_type* slot = DoSlotOf(index_ptr);
+		uint32_t position = slot->mDense;
+		if (position < newLive)
+		{
+			continue;
+		}
+		uint32_t& link = mDenseSlots[position];
+		slot->mElement->~T();
+		slot->mElement = nullptr;
+		slot->mDense = link;
+		link = kNoSlot;
+		mUnoccupiedElements.push_back(index_ptr);
+		DoRetireSlot(slot);
+	}
+
+	//Every other target leaves a hole, filled with the next survivor from the tail, so each survivor is relocated once
+	size_type survivor = newLive;
+	for (HandleIterator i = first; i != last; ++i)
+	{
+		index_type* index_ptr = (*i).mSparseIndexPtr;
+		sparse_index_type* slot = DoSlotOf(index_ptr);
+		T* target = slot->mElement;
+		if (!target)
+		{
+			continue;
+		}
+		uint32_t position = slot->mDense;
+		uint32_t& link = mDenseSlots[position];
+		target->~T();
+		slot->mDense = link;
+		mUnoccupiedElements.push_back(index_ptr);
+		DoRetireSlot(slot);
+
+		while (mDenseSlots[survivor] == kNoSlot)
+		{
+			++survivor;
+		}
+		link = mDenseSlots[survivor++];
+		sparse_index_type& moved = mSparseIndices[link];
+		detail::relocate(target, moved.mElement);
+		moved.mElement = target;
+		moved.mDense = position;
+	}
+	mDenseSlots.resize(newLive);
+	DoSetDenseEnd(newLive);
+	DoShrinkIfSparse();
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::key_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::key_of(handle_type const & handle) const
+{
+	sparse_index_type const * slot = DoSlotOf(handle.mSparseIndexPtr);
+	return key_type{mDenseSlots[slot->mDense], slot->mGeneration};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::sparse_index_type const *
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::DoFindSlot(key_type key) const
+{
+	if (key.mSlot >= mSparseIndices.size())
+	{
+		return nullptr;
+	}
+	sparse_index_type const & slot = mSparseIndices[key.mSlot];
+	return slot.mGeneration == key.mGeneration ? &slot : nullptr;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool cluster_map<T, Allocator, tStepSize, GrowthPolicy>::contains(key_type key) const
+{
+	return DoFindSlot(key) != nullptr;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T* cluster_map<T, Allocator, tStepSize, GrowthPolicy>::find(key_type key) const
+{
+	sparse_index_type const * slot = DoFindSlot(key);
+	return slot ? slot->mElement : nullptr;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T* cluster_map<T, Allocator, tStepSize, GrowthPolicy>::find(key_type key)
+{
+	sparse_index_type const * slot = DoFindSlot(key);
+	return slot ? slot->mElement : nullptr;
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::handle_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::to_handle(key_type key)
+{
+	sparse_index_type* slot = const_cast<sparse_index_type*>(DoFindSlot(key));
+	return slot ? handle_type{&slot->mElement, slot->mElement} : handle_type{};
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::handle_type
+cluster_map<T, Allocator, tStepSize, GrowthPolicy>::to_handle(iterator itr)
+{
+	return DoHandleAt(DoPositionOf(itr.mCurrentElement.mCurrent, itr.mCurrentElement.mCluster));
+}
+
+template<typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool cluster_map<T, Allocator, tStepSize, GrowthPolicy>::erase(key_type key)
+{
+	handle_type handle = to_handle(key);
+	if (!handle.mSparseIndexPtr)
+	{
+		return false;
+	}
+	erase(handle);
+	return true;
+}
+
+template<typename T>
+inline bool operator==(const cluster_map_dense_storage_iterator<const T>& a, const cluster_map_dense_storage_iterator<const T>& b)
+{
+	return a.mCurrentElement == b.mCurrentElement;
+}
+
+
+template<typename T>
+inline bool operator!=(const cluster_map_dense_storage_iterator<const T>& a, const cluster_map_dense_storage_iterator<const T>& b)
+{
+	return a.mCurrentElement != b.mCurrentElement;
+}
+
+template<typename T>
+inline bool operator==(const cluster_map_dense_storage_iterator<T>& a, const cluster_map_dense_storage_iterator<T>& b)
+{
+	return a.mCurrentElement == b.mCurrentElement;
+}
+
+
+template<typename T>
+inline bool operator!=(const cluster_map_dense_storage_iterator<T>& a, const cluster_map_dense_storage_iterator<T>& b)
+{
+	return a.mCurrentElement != b.mCurrentElement;
+}
+
+template<typename T>
+inline bool operator==(const cluster_map_dense_storage_iterator<T>& a, const cluster_vector_iterator<cluster_map_dense_storage<T>>& b)
+{
+	return a.mCurrentElement == b.mCurrent;
+}
+
+template<typename T>
+inline bool operator!=(const cluster_vector_iterator<cluster_map_dense_storage<T>>& a, const cluster_map_dense_storage_iterator<T>& b)
+{
+	return a.mCurrent != b.mCurrentElement;
+}
+
+}
+
@@ -0,0 +1,827 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	Parallel algorithms for cluster_vector and cluster_map.
+//
+//	The element range [0, size()) is cut into equal element-count chunks with
+//	no regard for where clusters start or end; each chunk is walked through
+//	segments(first, last) so a chunk spanning a cluster boundary is simply two
+//	contiguous runs. Chunks are handed to an executor, anything providing:
+//
+//	    size_t concurrency() const;
+//	    template <typename Task> void parallel_for(size_t taskCount, Task const& task);
+//
+//	where parallel_for calls task(i) exactly once for every i in [0, taskCount)
+//	and returns once they have all finished. thread_pool is the default,
+//	sequential_executor runs everything on the calling thread.
+//
+//	Example usage:
+//	    sw::cluster_vector<float, Allocator> weights;
+//	    sw::parallel_generate(weights, [](size_t i) { return float(i); });
+//	    sw::parallel_for_each(weights, [](float& w) { w *= 0.5f; });
+//	    float total = sw::parallel_reduce(weights, 0.0f, std::plus<float>());
+//	    sw::parallel_sort(weights);
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+#include "ClusterMap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Smallest number of elements worth handing to another thread
+#ifndef CLUSTER_PARALLEL_MIN_CHUNK_SIZE
+#define CLUSTER_PARALLEL_MIN_CHUNK_SIZE 2048u
+#endif
+
+//Chunks created per unit of executor concurrency, more gives work stealing room to even out uneven work
+#ifndef CLUSTER_PARALLEL_CHUNKS_PER_THREAD
+#define CLUSTER_PARALLEL_CHUNKS_PER_THREAD 4u
+#endif
+
+namespace sw
+{
+
+// sequential_executor
+//
+// Runs every task in order on the calling thread.
+//
+struct sequential_executor
+{
+	size_t				concurrency() const { return 1u; }
+
+	template <typename Task>
+	void				parallel_for(size_t taskCount, Task const & task) const
+	{
+		for (size_t i = 0; i < taskCount; ++i)
+		{
+			task(i);
+		}
+	}
+};
+
+// thread_pool
+//
+// A fixed set of worker threads which, together with the calling thread, run
+// the tasks of one parallel_for at a time. The task indices are dealt out in
+// contiguous blocks, one per thread; a thread that empties its own block
+// steals from the back of the others. Calls to parallel_for from several
+// threads are serialised, calling it from inside one of its own tasks is not
+// supported, and tasks must not throw.
+//
+class thread_pool
+{
+public:
+	explicit			thread_pool(size_t workerCount = default_worker_count());
+						~thread_pool();
+
+						thread_pool(thread_pool const &) = delete;
+	thread_pool&		operator=(thread_pool const &) = delete;
+
+	//The workers plus the thread calling parallel_for
+	size_t				concurrency() const { return mWorkerCount + 1u; }
+
+	template <typename Task>
+	void				parallel_for(size_t taskCount, Task const & task);
+
+	static size_t		default_worker_count()
+	{
+		unsigned hardwareThreads = std::thread::hardware_concurrency();
+		return hardwareThreads > 1u ? hardwareThreads - 1u : 0u;
+	}
+
+protected:
+	using task_function = void (*)(void const *, size_t);
+
+	struct task_queue
+	{
+		std::mutex		mMutex;
+		size_t			mGeneration = 0u;	//The parallel_for the block below belongs to
+		size_t			mBegin = 0u;		//Owner takes from the front
+		size_t			mEnd = 0u;			//Thieves take from the back
+	};
+
+	template <typename Task>
+	static void			DoInvoke(void const * task, size_t index) { (*static_cast<Task const *>(task))(index); }
+
+	void				DoWorkerLoop(size_t queueIndex);
+	void				DoRunTasks(size_t queueIndex, size_t generation, task_function function, void const * task);
+	bool				DoPopTask(size_t queueIndex, size_t generation, size_t& index);
+	bool				DoStealTask(size_t queueIndex, size_t generation, size_t& index);
+
+	size_t							mWorkerCount;
+	std::unique_ptr<task_queue[]>	mQueues;			//One per worker, then one for the calling thread
+	std::vector<std::thread>		mWorkers;
+
+	std::mutex						mSubmitMutex;		//Serialises parallel_for callers
+	std::mutex						mMutex;				//Guards everything below
+	std::condition_variable			mWake;
+	std::condition_variable			mDone;
+	size_t							mGeneration = 0u;
+	task_function					mFunction = nullptr;
+	void const *					mTask = nullptr;
+	std::atomic<size_t>				mRemaining{0u};
+	bool							mStop = false;
+};
+
+inline thread_pool::thread_pool(size_t workerCount)
+	: mWorkerCount(workerCount)
+	, mQueues(new task_queue[workerCount + 1u])
+{
+	mWorkers.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; ++i)
+	{
+		mWorkers.emplace_back(&thread_pool::DoWorkerLoop, this, i);
+	}
+}
+
+inline thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mWake.notify_all();
+	for (std::thread& worker : mWorkers)
+	{
+		worker.join();
+	}
+}
+
+template <typename Task>
+inline void thread_pool::parallel_for(size_t taskCount, Task const & task)
+{
+	if (mWorkerCount == 0u || taskCount <= 1u)
+	{
+		for (size_t i = 0; i < taskCount; ++i)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> submit(mSubmitMutex);
+	size_t queueCount = mWorkerCount + 1u;
+	size_t generation;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		generation = ++mGeneration;
+		mFunction = &DoInvoke<Task>;
+		mTask = &task;
+		mRemaining.store(taskCount, std::memory_order_relaxed);
+		for (size_t q = 0; q < queueCount; ++q)
+		{
+			task_queue& queue = mQueues[q];
+			std::lock_guard<std::mutex> queueLock(queue.mMutex);
+			queue.mGeneration = generation;
+			queue.mBegin = taskCount * q / queueCount;
+			queue.mEnd = taskCount * (q + 1u) / queueCount;
+		}
+	}
+	mWake.notify_all();
+
+	DoRunTasks(mWorkerCount, generation, &DoInvoke<Task>, &task);
+
+	//Once every task has finished no worker can pop another for this generation, so task may go out of scope
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [this] { return mRemaining.load(std::memory_order_acquire) == 0u; });
+}
+
+inline void thread_pool::DoWorkerLoop(size_t queueIndex)
+{
+	size_t seenGeneration = 0u;
+	for (;;)
+	{
+		task_function function;
+		void const * task;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [&] { return mStop || mGeneration != seenGeneration; });
+			if (mStop)
+			{
+				return;
+			}
+			seenGeneration = mGeneration;
+			function = mFunction;
+			task = mTask;
+		}
+		DoRunTasks(queueIndex, seenGeneration, function, task);
+	}
+}
+
+inline void thread_pool::DoRunTasks(size_t queueIndex, size_t generation, task_function function, void const * task)
+{
+	size_t index;
+	while (DoPopTask(queueIndex, generation, index) || DoStealTask(queueIndex, generation, index))
+	{
+		function(task, index);
+		if (mRemaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mDone.notify_all();
+		}
+	}
+}
+
+inline bool thread_pool::DoPopTask(size_t queueIndex, size_t generation, size_t& index)
+{
+	task_queue& queue = mQueues[queueIndex];
+	std::lock_guard<std::mutex> lock(queue.mMutex);
+	if (queue.mGeneration != generation || queue.mBegin == queue.mEnd)
+	{
+		return false;
+	}
+	index = queue.mBegin++;
+	return true;
+}
+
+inline bool thread_pool::DoStealTask(size_t queueIndex, size_t generation, size_t& index)
+{
+	size_t queueCount = mWorkerCount + 1u;
+	for (size_t i = 1; i < queueCount; ++i)
+	{
+		task_queue& queue = mQueues[(queueIndex + i) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mMutex);
+		if (queue.mGeneration == generation && queue.mBegin != queue.mEnd)
+		{
+			index = --queue.mEnd;
+			return true;
+		}
+	}
+	return false;
+}
+
+// default_thread_pool
+//
+// The pool used by the parallel algorithms when no executor is given, started on first use.
+//
+inline thread_pool& default_thread_pool()
+{
+	static thread_pool pool;
+	return pool;
+}
+
+namespace detail
+{
+	template <typename Executor>
+	inline size_t parallel_chunk_count(Executor const & executor, size_t count)
+	{
+		size_t chunkCount = executor.concurrency() * CLUSTER_PARALLEL_CHUNKS_PER_THREAD;
+		size_t maxChunkCount = (count + CLUSTER_PARALLEL_MIN_CHUNK_SIZE - 1u) / CLUSTER_PARALLEL_MIN_CHUNK_SIZE;
+		return chunkCount < maxChunkCount ? chunkCount : maxChunkCount;
+	}
+
+	//Calls function(chunk, first, last) for equal, non-empty [first, last) slices of [0, count)
+	template <typename Executor, typename ChunkFunction>
+	inline void parallel_chunks(Executor& executor, size_t count, size_t chunkCount, ChunkFunction function)
+	{
+		executor.parallel_for(chunkCount, [&](size_t chunk)
+		{
+			function(chunk, count * chunk / chunkCount, count * (chunk + 1u) / chunkCount);
+		});
+	}
+}
+
+// parallel_for_each
+//
+// Calls function(element) for every element, from several threads at once.
+//
+template <typename Container, typename Function, typename Executor>
+inline void parallel_for_each(Container& container, Function function, Executor&& executor)
+{
+	size_t count = container.size();
+	detail::parallel_chunks(executor, count, detail::parallel_chunk_count(executor, count),
+		[&](size_t, size_t first, size_t last)
+	{
+		for (auto segment : container.segments(first, last))
+		{
+			for (auto i = segment.begin(), e = segment.end(); i != e; ++i)
+			{
+				function(*i);
+			}
+		}
+	});
+}
+
+template <typename Container, typename Function>
+inline void parallel_for_each(Container& container, Function function)
+{
+	parallel_for_each(container, function, default_thread_pool());
+}
+
+// parallel_generate
+//
+// Assigns generator(index) to the element at each index. The generator is
+// given the index rather than being called in sequence, as there is no
+// sequence once the calls are spread across threads.
+//
+template <typename Container, typename Generator, typename Executor>
+inline void parallel_generate(Container& container, Generator generator, Executor&& executor)
+{
+	size_t count = container.size();
+	detail::parallel_chunks(executor, count, detail::parallel_chunk_count(executor, count),
+		[&](size_t, size_t first, size_t last)
+	{
+		size_t index = first;
+		for (auto segment : container.segments(first, last))
+		{
+			for (auto i = segment.begin(), e = segment.end(); i != e; ++i)
+			{
+				*i = generator(index++);
+			}
+		}
+	});
+}
+
+template <typename Container, typename Generator>
+inline void parallel_generate(Container& container, Generator generator)
+{
+	parallel_generate(container, generator, default_thread_pool());
+}
+
+// parallel_transform
+//
+// Assigns operation(source[i]) to destination[i] for every i. The two
+// containers must be the same size but needn't share a cluster layout, or
+// even be the same container type; they may be the same container.
+//
+template <typename SourceContainer, typename DestinationContainer, typename UnaryOperation, typename Executor>
+inline void parallel_transform(SourceContainer& source, DestinationContainer& destination, UnaryOperation operation, Executor&& executor)
+{
+	size_t count = source.size();
+	CLUSTER_ASSERT(destination.size() == count);
+	detail::parallel_chunks(executor, count, detail::parallel_chunk_count(executor, count),
+		[&](size_t, size_t first, size_t last)
+	{
+		auto destinationRange = destination.segments(first, last);
+		auto destinationSegment = destinationRange.begin();
+		auto output = (*destinationSegment).begin();
+		auto outputEnd = (*destinationSegment).end();
+		for (auto segment : source.segments(first, last))
+		{
+			auto input = segment.begin();
+			auto inputEnd = segment.end();
+			while (input != inputEnd)
+			{
+				if (output == outputEnd)
+				{
+					++destinationSegment;
+					output = (*destinationSegment).begin();
+					outputEnd = (*destinationSegment).end();
+				}
+				//Both runs are contiguous, so transform the overlap in one go
+				auto run = std::min(inputEnd - input, outputEnd - output);
+				output = std::transform(input, input + run, output, operation);
+				input += run;
+			}
+		}
+	});
+}
+
+template <typename SourceContainer, typename DestinationContainer, typename UnaryOperation>
+inline void parallel_transform(SourceContainer& source, DestinationContainer& destination, UnaryOperation operation)
+{
+	parallel_transform(source, destination, operation, default_thread_pool());
+}
+
+// parallel_reduce
+//
+// Folds every element into init with operation, which must be associative
+// and commutative as the grouping and order are unspecified. init is folded
+// in exactly once, each chunk starting from its own first element.
+//
+template <typename Container, typename T, typename BinaryOperation, typename Executor>
+inline T parallel_reduce(Container const & container, T init, BinaryOperation operation, Executor&& executor)
+{
+	size_t count = container.size();
+	size_t chunkCount = detail::parallel_chunk_count(executor, count);
+	if (chunkCount == 0u)
+	{
+		return init;
+	}
+
+	//Each chunk's partial is constructed from the chunk's first element, so T needn't be default constructible
+	using partial_storage = typename std::aligned_storage<sizeof(T), CLUSTER_ALIGN_OF(T)>::type;
+	std::vector<partial_storage> partials(chunkCount);
+	std::vector<char> filled(chunkCount, 0);
+	detail::parallel_chunks(executor, count, chunkCount,
+		[&](size_t chunk, size_t first, size_t last)
+	{
+		T* partial = nullptr;
+		for (auto segment : container.segments(first, last))
+		{
+			auto i = segment.begin();
+			auto e = segment.end();
+			if (!partial)
+			{
+				partial = ::new (&partials[chunk]) T(*i++);
+				filled[chunk] = 1;
+			}
+			for (; i != e; ++i)
+			{
+				*partial = operation(*partial, *i);
+			}
+		}
+	});
+
+	for (size_t chunk = 0u; chunk < chunkCount; ++chunk)
+	{
+		if (filled[chunk])
+		{
+			T* partial = reinterpret_cast<T*>(&partials[chunk]);
+			init = operation(init, *partial);
+			partial->~T();
+		}
+	}
+	return init;
+}
+
+template <typename Container, typename T, typename BinaryOperation>
+inline T parallel_reduce(Container const & container, T init, BinaryOperation operation)
+{
+	return parallel_reduce(container, init, operation, default_thread_pool());
+}
+
+namespace detail
+{
+	//A contiguous run of elements sorted as one piece
+	template <typename T>
+	struct sort_run
+	{
+		T*						mBegin;
+		T*						mEnd;
+	};
+
+	//Raw storage for count elements from a copy of the container's allocator, constructing and destroying them is up to the user
+	template <typename T, typename Allocator>
+	class uninitialized_buffer
+	{
+	public:
+		uninitialized_buffer(size_t count, Allocator const & allocator)
+			: mAllocator(allocator)
+			, mCount(count)
+			, mStorage(count ? static_cast<T*>(sw_allocate_memory(mAllocator, count * sizeof(T), CLUSTER_ALIGN_OF(T), 0)) : nullptr)
+		{
+		}
+
+		~uninitialized_buffer()
+		{
+			if (mStorage)
+			{
+				CLUSTERFree(mAllocator, mStorage, mCount * sizeof(T));
+			}
+		}
+
+		uninitialized_buffer(uninitialized_buffer const &) = delete;
+		uninitialized_buffer& operator=(uninitialized_buffer const &) = delete;
+
+		T*						data() const { return mStorage; }
+
+	private:
+		Allocator				mAllocator;
+		size_t					mCount;
+		T*						mStorage;
+	};
+
+	template <typename Executor, typename T, typename Compare>
+	inline void sort_runs(Executor& executor, std::vector<sort_run<T>>& runs, Compare& compare, bool stable)
+	{
+		executor.parallel_for(runs.size(), [&](size_t r)
+		{
+			if (stable)
+			{
+				std::stable_sort(runs[r].mBegin, runs[r].mEnd, compare);
+			}
+			else
+			{
+				std::sort(runs[r].mBegin, runs[r].mEnd, compare);
+			}
+		});
+	}
+
+	//Stable k-way merge of [bounds[r], bounds[r + 1]) sub-runs, equal elements are taken from the earlier run first.
+	//Each element is move constructed into the uninitialized dest and its source is left moved-from.
+	template <typename T, typename Compare>
+	inline void merge_sub_runs(std::vector<std::pair<T*, T*>>& cursors, T* dest, Compare& compare)
+	{
+		//Run indices ordered so that the heap's top is the run holding the next element
+		auto later = [&](size_t a, size_t b)
+		{
+			return compare(*cursors[b].first, *cursors[a].first) || (!compare(*cursors[a].first, *cursors[b].first) && b < a);
+		};
+
+		std::vector<size_t> heap;
+		for (size_t r = 0; r < cursors.size(); ++r)
+		{
+			if (cursors[r].first != cursors[r].second)
+			{
+				heap.push_back(r);
+			}
+		}
+		std::make_heap(heap.begin(), heap.end(), later);
+
+		while (heap.size() > 1u)
+		{
+			std::pop_heap(heap.begin(), heap.end(), later);
+			std::pair<T*, T*>& cursor = cursors[heap.back()];
+			::new (dest++) T(std::move(*cursor.first++));
+			if (cursor.first == cursor.second)
+			{
+				heap.pop_back();
+			}
+			else
+			{
+				std::push_heap(heap.begin(), heap.end(), later);
+			}
+		}
+		if (!heap.empty())
+		{
+			//Only one run left, so the rest of it follows in order
+			for (std::pair<T*, T*>& cursor = cursors[heap.back()]; cursor.first != cursor.second; ++cursor.first)
+			{
+				::new (dest++) T(std::move(*cursor.first));
+			}
+		}
+	}
+
+	//Merges the sorted runs, which hold count elements between them, into the uninitialized dest. Sample splitters cut the
+	//output into partitionCount pieces that are merged on their own tasks; every element equal to a splitter falls on the
+	//splitter's side, so the merge is stable however the pieces come out.
+	template <typename Executor, typename T, typename Compare>
+	inline void merge_runs(Executor& executor, std::vector<sort_run<T>> const & runs, size_t count, size_t partitionCount, T* dest, Compare& compare)
+	{
+		size_t const runCount = runs.size();
+		if (partitionCount < 1u)
+		{
+			partitionCount = 1u;
+		}
+
+		std::vector<T const*> samples;
+		for (sort_run<T> const & run : runs)
+		{
+			size_t const length = run.mEnd - run.mBegin;
+			for (size_t s = 1u; s < partitionCount && length; ++s)
+			{
+				samples.push_back(run.mBegin + length * s / partitionCount);
+			}
+		}
+		std::sort(samples.begin(), samples.end(), [&](T const* a, T const* b) { return compare(*a, *b); });
+
+		//bounds[j * runCount + r] is where partition j starts within run r
+		std::vector<T*> bounds((partitionCount + 1u) * runCount);
+		executor.parallel_for(runCount, [&](size_t r)
+		{
+			sort_run<T> const & run = runs[r];
+			bounds[r] = run.mBegin;
+			bounds[partitionCount * runCount + r] = run.mEnd;
+			T* low = run.mBegin;
+			for (size_t j = 1u; j < partitionCount; ++j)
+			{
+				T const & splitter = *samples[samples.size() * j / partitionCount];
+				low = std::lower_bound(low, run.mEnd, splitter, compare);
+				bounds[j * runCount + r] = low;
+			}
+		});
+
+		std::vector<size_t> starts(partitionCount + 1u, 0u);
+		for (size_t j = 0; j < partitionCount; ++j)
+		{
+			size_t length = 0u;
+			for (size_t r = 0; r < runCount; ++r)
+			{
+				length += bounds[(j + 1u) * runCount + r] - bounds[j * runCount + r];
+			}
+			starts[j + 1u] = starts[j] + length;
+		}
+		CLUSTER_ASSERT(starts[partitionCount] == count);
+		CLUSTER_UNUSED(count);
+
+		executor.parallel_for(partitionCount, [&](size_t j)
+		{
+			std::vector<std::pair<T*, T*>> cursors(runCount);
+			for (size_t r = 0; r < runCount; ++r)
+			{
+				cursors[r] = std::make_pair(bounds[j * runCount + r], bounds[(j + 1u) * runCount + r]);
+			}
+			merge_sub_runs(cursors, dest + starts[j], compare);
+		});
+	}
+
+	template <typename Container, typename Compare, typename Executor>
+	inline void parallel_sort(Container& container, Compare compare, Executor& executor, bool stable)
+	{
+		using value_type = typename Container::value_type;
+
+		size_t count = container.size();
+		if (count < 2u)
+		{
+			return;
+		}
+		size_t chunkCount = parallel_chunk_count(executor, count);
+
+		//Every cluster within every chunk is sorted in place as its own run
+		std::vector<sort_run<value_type>> runs;
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			for (auto segment : container.segments(count * chunk / chunkCount, count * (chunk + 1u) / chunkCount))
+			{
+				runs.push_back(sort_run<value_type>{ segment.begin(), segment.end() });
+			}
+		}
+		sort_runs(executor, runs, compare, stable);
+		if (runs.size() == 1u)
+		{
+			return;
+		}
+
+		uninitialized_buffer<value_type, typename Container::allocator_type> buffer(count, container.get_allocator());
+		value_type* merged = buffer.data();
+		merge_runs(executor, runs, count, chunkCount, merged, compare);
+
+		parallel_chunks(executor, count, chunkCount, [&](size_t, size_t first, size_t last)
+		{
+			value_type* source = merged + first;
+			for (auto segment : container.segments(first, last))
+			{
+				for (auto i = segment.begin(), e = segment.end(); i != e; ++i, ++source)
+				{
+					*i = std::move(*source);
+					source->~value_type();
+				}
+			}
+		});
+	}
+}
+
+// parallel_sort
+//
+// Sorts a cluster_vector. Each cluster's share of every chunk is sorted on
+// its own task, then the sorted runs are merged into a scratch buffer with a
+// k-way merge that is itself split across tasks, and moved back. Needs
+// count extra elements of scratch space, taken from the container's
+// allocator; compare must not throw.
+//
+template <typename Container, typename Compare, typename Executor>
+inline void parallel_sort(Container& container, Compare compare, Executor&& executor)
+{
+	detail::parallel_sort(container, compare, executor, false);
+}
+
+template <typename Container, typename Compare>
+inline void parallel_sort(Container& container, Compare compare)
+{
+	detail::parallel_sort(container, compare, default_thread_pool(), false);
+}
+
+template <typename Container>
+inline void parallel_sort(Container& container)
+{
+	detail::parallel_sort(container, std::less<typename Container::value_type>(), default_thread_pool(), false);
+}
+
+// parallel_stable_sort
+//
+// As parallel_sort, but equal elements keep their relative order.
+//
+template <typename Container, typename Compare, typename Executor>
+inline void parallel_stable_sort(Container& container, Compare compare, Executor&& executor)
+{
+	detail::parallel_sort(container, compare, executor, true);
+}
+
+template <typename Container, typename Compare>
+inline void parallel_stable_sort(Container& container, Compare compare)
+{
+	detail::parallel_sort(container, compare, default_thread_pool(), true);
+}
+
+template <typename Container>
+inline void parallel_stable_sort(Container& container)
+{
+	detail::parallel_sort(container, std::less<typename Container::value_type>(), default_thread_pool(), true);
+}
+
+namespace detail
+{
+	//The cluster_map internals that parallel_sort_by_key needs, kept out of its public interface
+	struct parallel_access
+	{
+		template <typename Map, typename KeyOf, typename Executor>
+		static void sort_by_key(Map& map, KeyOf& keyOf, Executor& executor)
+		{
+			using T = typename Map::value_type;
+			using allocator_type = typename Map::allocator_type;
+			using key_type = typename std::decay<decltype(keyOf(std::declval<T const &>()))>::type;
+			using entry_type = std::pair<key_type, size_t>;
+
+			size_t count = map.size();
+			if (count < 2u)
+			{
+				return;
+			}
+			size_t chunkCount = parallel_chunk_count(executor, count);
+
+			uninitialized_buffer<entry_type, allocator_type> entries(count, map.get_allocator());
+			parallel_chunks(executor, count, chunkCount, [&](size_t, size_t first, size_t last)
+			{
+				entry_type* entry = entries.data() + first;
+				size_t position = first;
+				for (auto segment : map.segments(first, last))
+				{
+					for (T const * i = segment.begin(); i != segment.end(); ++i, ++entry, ++position)
+					{
+						::new (entry) entry_type(keyOf(*i), position);
+					}
+				}
+			});
+
+			//Each chunk of keys is one run, already in dense order so a stable sort keeps equal keys in place
+			auto compare = [](entry_type const & a, entry_type const & b) { return a.first < b.first; };
+			std::vector<sort_run<entry_type>> runs;
+			for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				runs.push_back(sort_run<entry_type>{ entries.data() + count * chunk / chunkCount, entries.data() + count * (chunk + 1u) / chunkCount });
+			}
+			sort_runs(executor, runs, compare, true);
+
+			uninitialized_buffer<entry_type, allocator_type> merged(runs.size() > 1u ? count : 0u, map.get_allocator());
+			entry_type* sorted = entries.data();
+			if (runs.size() > 1u)
+			{
+				merge_runs(executor, runs, count, chunkCount, merged.data(), compare);
+				parallel_chunks(executor, count, chunkCount, [&](size_t, size_t first, size_t last)
+				{
+					destroy_run(entries.data() + first, entries.data() + last);
+				});
+				sorted = merged.data();
+			}
+
+			//The elements and their back links move out in key order
+			uninitialized_buffer<T, allocator_type> scratch(count, map.get_allocator());
+			uninitialized_buffer<uint32_t, allocator_type> links(count, map.get_allocator());
+			parallel_chunks(executor, count, chunkCount, [&](size_t, size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; ++i)
+				{
+					size_t position = sorted[i].second;
+					relocate(scratch.data() + i, reinterpret_cast<T*>(&map.mDenseStorage[position].mData));
+					links.data()[i] = map.mDenseSlots[position];
+				}
+				destroy_run(sorted + first, sorted + last);
+			});
+
+			//Each slot is named by one position, so the chunks patch disjoint slots
+			parallel_chunks(executor, count, chunkCount, [&](size_t, size_t first, size_t last)
+			{
+				size_t position = first;
+				for (auto segment : map.segments(first, last))
+				{
+					for (T* dest = segment.begin(); dest != segment.end(); ++dest, ++position)
+					{
+						relocate(dest, scratch.data() + position);
+						uint32_t link = links.data()[position];
+						map.mDenseSlots[position] = link;
+						typename Map::sparse_index_type& slot = map.mSparseIndices[link];
+						slot.mElement = dest;
+						slot.mDense = static_cast<uint32_t>(position);
+					}
+				}
+			});
+		}
+	};
+}
+
+// parallel_sort_by_key
+//
+// Stably reorders a cluster_map's dense storage by keyOf(element), ascending.
+// The keys are sorted alongside the dense position of their element, the
+// elements are then relocated into a scratch buffer in key order and back
+// into the dense storage, rewriting each element's back link and sparse
+// slot as it lands, so handles keep referring to the same elements.
+// Iteration afterwards visits the elements in key order until the next
+// insert or erase. The key and scratch buffers are taken from the map's
+// allocator.
+//
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy, typename KeyOf, typename Executor>
+inline void parallel_sort_by_key(cluster_map<T, Allocator, tStepSize, GrowthPolicy>& map, KeyOf keyOf, Executor&& executor)
+{
+	detail::parallel_access::sort_by_key(map, keyOf, executor);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy, typename KeyOf>
+inline void parallel_sort_by_key(cluster_map<T, Allocator, tStepSize, GrowthPolicy>& map, KeyOf keyOf)
+{
+	parallel_sort_by_key(map, keyOf, default_thread_pool());
+}
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	A cluster_vector with one writer thread and any number of reader threads.
+//
+//	The writer appends through published_cluster_vector, which stores the new
+//	size with release semantics once the element is constructed. Readers take
+//	a view(), which loads that size with acquire semantics and walks the
+//	cluster chain up to it. Every element and every cluster link below the
+//	published size was written before the size was stored, and elements never
+//	move, so readers see them complete without taking a lock.
+//
+//	A reader never looks at the size or last-cluster flag kept in the tail
+//	cluster, which the writer is still changing; it bounds each cluster by
+//	its capacity and the view's own size instead. Only appends may run while
+//	readers are active. clear() and destruction need the readers to have
+//	finished.
+//
+//	Example usage:
+//	    sw::published_cluster_vector<Sample, Allocator> log(1024);
+//	    //Writer thread
+//	    log.push_back(sample);
+//	    //Any reader thread
+//	    for (Sample const & s : log.view()) { export(s); }
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+
+#include <atomic>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace sw
+{
+
+template <typename T>
+struct published_cluster_vector_iterator
+{
+public:
+	using this_type			= published_cluster_vector_iterator<T>;
+	using cluster_type		= cluster<typename std::remove_const<T>::type>;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= typename std::remove_const<T>::type;
+	using difference_type	= ptrdiff_t;
+	using pointer			= T*;
+	using reference			= T&;
+
+	reference				operator*() const { return *mCurrent; }
+	pointer					operator->() const { return mCurrent; }
+
+	this_type&				operator++();
+	this_type				operator++(int) { this_type i(*this); operator++(); return i; }
+
+	bool					operator==(this_type const & other) const { return mCurrent == other.mCurrent; }
+	bool					operator!=(this_type const & other) const { return mCurrent != other.mCurrent; }
+
+	//Points the iterator at the first of remaining elements starting at cluster, or at the end if there are none
+	void					DoEnterCluster(cluster_type const * cluster, size_t remaining);
+
+	T*						mCurrent;
+	T*						mEnd;
+	cluster_type const *	mCluster;
+	size_t					mRemaining;		//Published elements past this cluster
+};
+
+template <typename T>
+inline void
+published_cluster_vector_iterator<T>::DoEnterCluster(cluster_type const * cluster, size_t remaining)
+{
+	mCluster = cluster;
+	if (!remaining)
+	{
+		mCurrent = nullptr;
+		return;
+	}
+	size_t const capacity = cluster->capacity();
+	size_t const count = remaining < capacity ? remaining : capacity;
+	mCurrent = const_cast<cluster_type*>(cluster)->begin();
+	mEnd = mCurrent + count;
+	mRemaining = remaining - count;
+}
+
+template <typename T>
+inline typename published_cluster_vector_iterator<T>::this_type&
+published_cluster_vector_iterator<T>::operator++()
+{
+	if (CLUSTER_UNLIKELY(++mCurrent == mEnd))
+	{
+		//mNext is only read once the cluster is known to be full, after which the writer never touches it again
+		DoEnterCluster(mRemaining ? mCluster->mNext : nullptr, mRemaining);
+	}
+	return *this;
+}
+
+// published_cluster_view
+//
+// The elements a reader can see, fixed at the size published when the view
+// was taken. Later appends do not change a view; take a new one to see them.
+//
+template <typename T>
+class published_cluster_view
+{
+public:
+	using size_type			= size_t;
+	using cluster_type		= cluster<typename std::remove_const<T>::type>;
+	using iterator			= published_cluster_vector_iterator<T>;
+	using const_iterator	= iterator;
+	using value_type		= typename std::remove_const<T>::type;
+
+	published_cluster_view(cluster_type const * first, size_type size) : mFirstcluster(first), mSize(size) {}
+
+	iterator				begin() const { iterator i; i.DoEnterCluster(mFirstcluster, mSize); return i; }
+	iterator				end() const { iterator i; i.mCurrent = nullptr; return i; }
+
+	size_type				size() const { return mSize; }
+	bool					empty() const { return mSize == 0u; }
+
+protected:
+	cluster_type const *	mFirstcluster;
+	size_type				mSize;
+};
+
+template <typename T, typename Allocator, size_t tStepSize = 2u, typename GrowthPolicy = geometric_growth<tStepSize>>
+class published_cluster_vector
+{
+public:
+	using size_type				= size_t;
+	using this_type				= published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>;
+	using container_type		= cluster_vector<T, Allocator, tStepSize, GrowthPolicy>;
+	using cluster_type			= cluster<T>;
+	using view_type				= published_cluster_view<const T>;
+	using value_type			= T;
+
+	published_cluster_vector(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
+	published_cluster_vector() : published_cluster_vector(64u) {}
+
+	published_cluster_vector(this_type const &) = delete;
+	this_type& operator=(this_type const &) = delete;
+
+	//Reader side, safe from any thread
+	view_type				view() const;
+	size_type				published_size() const;
+
+	//Writer side, from one thread only. Each append is visible to readers as soon as it returns.
+	void					push_back(const T& value);
+	void					push_back(T&& value);
+	template <typename... Args>
+	void					emplace_back(Args&&... args);
+	//Publishes the whole range at once, after the last element is constructed
+	template <typename InputIterator>
+	void					append(InputIterator first, InputIterator last);
+	//Allocates clusters ahead of the writer so that appends up to count never allocate
+	void					reserve(size_type count);
+
+	//The writer's own view of the elements, not for use from reader threads
+	container_type const &	elements() const;
+
+	//Needs every reader to have finished
+	void					clear();
+
+protected:
+	void					DoPublish();
+
+	container_type				mElements;
+	std::atomic<cluster_type*>	mPublishedFirstcluster;
+	std::atomic<size_type>		mPublishedSize;
+};
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::published_cluster_vector(size_type initialClusterCapacity, const Allocator& allocator)
+	:	mElements(initialClusterCapacity, allocator)
+	,	mPublishedFirstcluster(nullptr)
+	,	mPublishedSize(0u)
+{
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::view_type
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::view() const
+{
+	size_type const size = mPublishedSize.load(std::memory_order_acquire);
+	//The first cluster was stored before any size that counts its elements
+	return view_type(mPublishedFirstcluster.load(std::memory_order_relaxed), size);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::published_size() const
+{
+	return mPublishedSize.load(std::memory_order_acquire);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back(const T& value)
+{
+	mElements.push_back(value);
+	DoPublish();
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back(T&& value)
+{
+	mElements.push_back(std::move(value));
+	DoPublish();
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename... Args>
+inline void
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::emplace_back(Args&&... args)
+{
+	mElements.emplace_back(std::forward<Args>(args)...);
+	DoPublish();
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename InputIterator>
+inline void
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::append(InputIterator first, InputIterator last)
+{
+	mElements.append(first, last);
+	DoPublish();
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::reserve(size_type count)
+{
+	//Reserved clusters are not reachable from the published chain until appends link them, so readers are unaffected
+	mElements.reserve(count);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::container_type const &
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::elements() const
+{
+	return mElements;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::clear()
+{
+	mPublishedSize.store(0u, std::memory_order_relaxed);
+	mPublishedFirstcluster.store(nullptr, std::memory_order_relaxed);
+	mElements.clear();
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+published_cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoPublish()
+{
+	mPublishedFirstcluster.store(mElements.first_cluster(), std::memory_order_relaxed);
+	mPublishedSize.store(mElements.size(), std::memory_order_release);
+}
+
+}
@@ -0,0 +1,475 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	A FIFO queue built on the same cluster chain as cluster_vector.
+//
+//	Elements are pushed into the tail cluster and popped from the head
+//	cluster. Once the head cluster is drained it is unlinked and released in
+//	O(1), so a long running stream holds only the clusters that still have
+//	elements in them, and elements never move while they are queued.
+//
+//	Cluster capacities follow the growth policy by the number of clusters
+//	currently held rather than by how many have ever been allocated, so a
+//	deep queue grows into large clusters and a shallow one keeps to small
+//	ones. One drained cluster is kept as a spare so that a queue hovering
+//	around a cluster boundary does not allocate and free on every crossing.
+//
+//	trim_front() and pop_front_cluster() drop the oldest elements a whole
+//	cluster at a time, which is constant time for trivially destructible
+//	elements and is the cheap way to keep a buffered stream to a retention
+//	limit.
+//
+//	Example usage:
+//	    sw::cluster_queue<Event, Allocator> events(256);
+//	    events.push_back(event);
+//	    events.trim_front(kMaxBufferedEvents);
+//	    while (!events.empty()) { handle(events.front()); events.pop_front(); }
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sw
+{
+
+template <typename T, typename Allocator, size_t tStepSize = 2u, typename GrowthPolicy = geometric_growth<tStepSize>>
+class cluster_queue
+{
+public:
+	using size_type				= size_t;
+	using this_type				= cluster_queue<T, Allocator, tStepSize, GrowthPolicy>;
+	using cluster_type			= cluster<T>;
+	using cluster_helper_type	= typename detail::cluster_helper<T>;
+	using allocator_type		= Allocator;
+	using growth_policy_type	= GrowthPolicy;
+	using iterator				= cluster_vector_iterator<T>;
+	using const_iterator		= cluster_vector_iterator<const T>;
+	using value_type			= T;
+
+	cluster_queue(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
+	cluster_queue() : cluster_queue(64u) {}
+	~cluster_queue();
+
+	cluster_queue(cluster_queue && other);
+
+	cluster_queue(cluster_queue const &) = delete;
+	cluster_queue& operator=(cluster_queue const &) = delete;
+
+	allocator_type&			get_allocator();
+
+	//Front to back
+	const_iterator			begin() const;
+	iterator				begin();
+	const_iterator			end() const;
+	iterator				end();
+
+	size_type				size() const;
+	bool					empty() const;
+	size_type				cluster_count() const;
+
+	const T&				front() const;
+	T&						front();
+	const T&				back() const;
+	T&						back();
+
+	void					push_back(const T& value);
+	void					push_back(T&& value);
+	template <typename... Args>
+	T&						emplace_back(Args&&... args);
+
+	void					pop_front();
+	//Drops every element of the head cluster, returns how many were dropped
+	size_type				pop_front_cluster();
+	//Drops whole head clusters while at least maxSize elements would remain, so the queue keeps its newest maxSize elements plus at most one cluster's worth more. Returns how many were dropped.
+	size_type				trim_front(size_type maxSize);
+
+	void					clear();
+	//Frees the spare cluster
+	void					shrink_to_fit();
+
+	void					swap(this_type& other);
+
+protected:
+	T*						DoBackSlot();
+	void					DoAppendCluster();
+	void					DoPopFrontCluster();
+	void					DoReleaseCluster(cluster_type* cluster);
+	size_type				DoHeadCount() const;
+	size_type				DoClusterCapacity(size_type clusterIndex) const;
+
+	allocator_type			mAllocator;
+	cluster_type*			mHead;
+	cluster_type*			mTail;
+	T*						mFront;					//First element in mHead, everything before it has been popped
+	size_type				mSize;
+	size_type				mClusterCount;
+	size_type const			mInitialClusterCapacity;
+	cluster_type*			mSpare;					//A drained cluster kept for the next append, or null
+};
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::cluster_queue(size_type initialClusterCapacity, const Allocator& allocator)
+	:	mAllocator(allocator)
+	,	mHead(nullptr)
+	,	mTail(nullptr)
+	,	mFront(nullptr)
+	,	mSize(0u)
+	,	mClusterCount(0u)
+	,	mInitialClusterCapacity(initialClusterCapacity)
+	,	mSpare(nullptr)
+{
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::cluster_queue(cluster_queue && other)
+	:	mAllocator(other.mAllocator)
+	,	mHead(other.mHead)
+	,	mTail(other.mTail)
+	,	mFront(other.mFront)
+	,	mSize(other.mSize)
+	,	mClusterCount(other.mClusterCount)
+	,	mInitialClusterCapacity(other.mInitialClusterCapacity)
+	,	mSpare(other.mSpare)
+{
+	other.mHead = nullptr;
+	other.mTail = nullptr;
+	other.mFront = nullptr;
+	other.mSize = 0u;
+	other.mClusterCount = 0u;
+	other.mSpare = nullptr;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::~cluster_queue()
+{
+	clear();
+	shrink_to_fit();
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::allocator_type&
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::get_allocator()
+{
+	return mAllocator;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::begin() const
+{
+	const_iterator i;
+	i.mCluster = mHead;
+	if (mSize)
+	{
+		i.mCurrent = mFront;
+		i.mEnd = mHead->end();
+	}
+	else
+	{
+		i.mCurrent = 0;
+	}
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::begin()
+{
+	iterator i;
+	i.mCluster = mHead;
+	if (mSize)
+	{
+		i.mCurrent = mFront;
+		i.mEnd = mHead->end();
+	}
+	else
+	{
+		i.mCurrent = 0;
+	}
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::end() const
+{
+	const_iterator i;
+	i.mCurrent = 0;
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::end()
+{
+	iterator i;
+	i.mCurrent = 0;
+	return i;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::size() const
+{
+	return mSize;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::empty() const
+{
+	return mSize == 0u;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::cluster_count() const
+{
+	return mClusterCount;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T&
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::front() const
+{
+	return *mFront;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::front()
+{
+	return *mFront;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T&
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::back() const
+{
+	return mTail->begin()[mTail->mSize - 1u];
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::back()
+{
+	return mTail->begin()[mTail->mSize - 1u];
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::push_back(const T& value)
+{
+	emplace_back(value);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::push_back(T&& value)
+{
+	emplace_back(std::move(value));
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename... Args>
+inline T&
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::emplace_back(Args&&... args)
+{
+	T* slot = ::new (DoBackSlot()) T(std::forward<Args>(args)...);
+	++mTail->mSize;
+	++mSize;
+	return *slot;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::pop_front()
+{
+	mFront->~T();
+	--mSize;
+	if (CLUSTER_UNLIKELY(++mFront == mHead->end()))
+	{
+		DoPopFrontCluster();
+	}
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::pop_front_cluster()
+{
+	if (!mHead)
+	{
+		return 0u;
+	}
+	T* const last = mHead->end();
+	size_type const count = last - mFront;
+	detail::destroy_run(mFront, last);
+	mSize -= count;
+	DoPopFrontCluster();
+	return count;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::trim_front(size_type maxSize)
+{
+	size_type dropped = 0u;
+	while (mSize && mSize - DoHeadCount() >= maxSize)
+	{
+		dropped += pop_front_cluster();
+	}
+	return dropped;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::clear()
+{
+	while (mSize)
+	{
+		pop_front_cluster();
+	}
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::shrink_to_fit()
+{
+	if (mSpare)
+	{
+		CLUSTERFree(mAllocator, mSpare, cluster_type::allocation_size(mSpare->capacity()));
+		mSpare = nullptr;
+	}
+	//An empty queue keeps its head cluster for reuse, so release that too
+	if (!mSize && mHead)
+	{
+		CLUSTERFree(mAllocator, mHead, cluster_type::allocation_size(mHead->capacity()));
+		mHead = nullptr;
+		mTail = nullptr;
+		mFront = nullptr;
+		mClusterCount = 0u;
+	}
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::swap(this_type& other)
+{
+	std::swap(mAllocator, other.mAllocator);
+	std::swap(mHead, other.mHead);
+	std::swap(mTail, other.mTail);
+	std::swap(mFront, other.mFront);
+	std::swap(mSize, other.mSize);
+	std::swap(mClusterCount, other.mClusterCount);
+	std::swap(mSpare, other.mSpare);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T*
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::DoBackSlot()
+{
+	if (CLUSTER_UNLIKELY(!mTail || mTail->mSize == mTail->capacity()))
+	{
+		DoAppendCluster();
+	}
+	return mTail->begin() + mTail->mSize;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::DoAppendCluster()
+{
+	size_type const capacity = DoClusterCapacity(mClusterCount);
+	cluster_type* newcluster = mSpare;
+	mSpare = nullptr;
+	if (newcluster && newcluster->capacity() < capacity)
+	{
+		//Too small for where the queue has grown to
+		CLUSTERFree(mAllocator, newcluster, cluster_type::allocation_size(newcluster->capacity()));
+		newcluster = nullptr;
+	}
+	if (!newcluster)
+	{
+		newcluster = (cluster_type*)sw_allocate_memory(mAllocator, cluster_type::allocation_size(capacity), CLUSTER_ALIGN_OF(cluster_helper_type), 0);
+		newcluster->mDataEnd = newcluster->begin() + capacity;
+	}
+
+	newcluster->mPrev = uintptr_t(mTail) | cluster_type::kIsLastCluster;
+	newcluster->mSize = 0u;
+	if (mTail)
+	{
+		newcluster->mStartIndex = mTail->mStartIndex + mTail->capacity();
+		//Only a full cluster is ever followed by another, so its size is implied by its capacity
+		mTail->mPrev &= ~cluster_type::kIsLastCluster;
+		mTail->mNext = newcluster;
+	}
+	else
+	{
+		newcluster->mStartIndex = 0u;
+		mHead = newcluster;
+		mFront = newcluster->begin();
+	}
+	mTail = newcluster;
+	++mClusterCount;
+}
+
+//Unlinks the head cluster once its elements are gone. The last cluster is kept and rewound instead, so an emptied queue does not reallocate on the next push.
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::DoPopFrontCluster()
+{
+	cluster_type* head = mHead;
+	if (head == mTail)
+	{
+		head->mSize = 0u;
+		mFront = head->begin();
+		return;
+	}
+
+	mHead = head->mNext;
+	mHead->mPrev &= cluster_type::kIsLastCluster;
+	mFront = mHead->begin();
+	--mClusterCount;
+	DoReleaseCluster(head);
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::DoReleaseCluster(cluster_type* cluster)
+{
+	//Keep the larger of the two as the spare
+	if (mSpare && mSpare->capacity() < cluster->capacity())
+	{
+		std::swap(mSpare, cluster);
+	}
+	if (mSpare)
+	{
+		CLUSTERFree(mAllocator, cluster, cluster_type::allocation_size(cluster->capacity()));
+	}
+	else
+	{
+		mSpare = cluster;
+	}
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::DoHeadCount() const
+{
+	return mHead ? size_type(mHead->end() - mFront) : 0u;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_queue<T, Allocator, tStepSize, GrowthPolicy>::DoClusterCapacity(size_type clusterIndex) const
+{
+	return GrowthPolicy::cluster_capacity(mInitialClusterCapacity, clusterIndex, sizeof(T), cluster_type::allocation_size(0u));
+}
+
+}
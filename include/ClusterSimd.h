@@ -0,0 +1,633 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	Vectorised reductions and searches over cluster_vector<float>,
+//	cluster_vector<double>, cluster_vector<int32_t> and cluster_vector<int64_t>.
+//
+//	Each kernel runs over one cluster's contiguous [begin, end) with SSE2,
+//	AVX2 or AVX-512 loads, and finishes the few elements left at the cluster
+//	edge with a scalar loop. The instruction set is picked once at runtime
+//	from what the CPU and OS support, capped by CLUSTER_SIMD_MAX_LEVEL.
+//	Non x86 targets use the scalar kernels.
+//
+//	Floating point sums and dot products are accumulated in several lanes,
+//	so they round differently from a left to right loop. Results involving
+//	NaNs are unspecified and integer overflow is not allowed.
+//
+//	Example usage:
+//	    sw::cluster_vector<float, Allocator> prices;
+//	    float total = sw::simd_sum(prices);
+//	    size_t cheapest = sw::simd_argmin(prices);
+//	    size_t zeroes = sw::simd_count(prices, 0.0f);
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define CLUSTER_SIMD_X86 1
+	#include <immintrin.h>
+	#if defined(CLUSTER_COMPILER_MSVC)
+		#include <intrin.h>
+	#endif
+#else
+	#define CLUSTER_SIMD_X86 0
+#endif
+
+// CLUSTER_SIMD_TARGET
+//
+// Lets a function use an instruction set the translation unit isn't compiled for.
+// MSVC makes every intrinsic available everywhere so needs nothing.
+//
+#if defined(CLUSTER_COMPILER_GNUC)
+	#define CLUSTER_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define CLUSTER_SIMD_TARGET(isa)
+#endif
+
+// CLUSTER_SIMD_MAX_LEVEL
+//
+// Highest simd_level the kernels may use, e.g. 2 to keep AVX-512 frequency drops away.
+//
+#ifndef CLUSTER_SIMD_MAX_LEVEL
+#define CLUSTER_SIMD_MAX_LEVEL 3
+#endif
+
+namespace sw
+{
+
+enum class simd_level
+{
+	scalar	= 0,
+	sse2	= 1,
+	avx2	= 2,
+	avx512	= 3,	//AVX-512F and AVX-512DQ
+};
+
+// detect_simd_level
+//
+// The best level the running CPU and OS support, ignoring CLUSTER_SIMD_MAX_LEVEL.
+//
+inline simd_level detect_simd_level()
+{
+#if CLUSTER_SIMD_X86 && defined(CLUSTER_COMPILER_GNUC)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+	{
+		return simd_level::avx512;
+	}
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return simd_level::avx2;
+	}
+	if (__builtin_cpu_supports("sse2"))
+	{
+		return simd_level::sse2;
+	}
+#elif CLUSTER_SIMD_X86 && defined(CLUSTER_COMPILER_MSVC)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool hasSse2 = (info[3] & (1 << 26)) != 0;
+	bool hasOsSave = (info[2] & (1 << 27)) != 0;
+	//The OS has to save the wider registers on a context switch as well as the CPU having them
+	unsigned long long enabledState = hasOsSave ? _xgetbv(0) : 0u;
+	bool hasAvxState = (enabledState & 0x06) == 0x06;
+	bool hasAvx512State = (enabledState & 0xE6) == 0xE6;
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		if (hasAvx512State && (info[1] & (1 << 16)) && (info[1] & (1 << 17)))
+		{
+			return simd_level::avx512;
+		}
+		if (hasAvxState && (info[1] & (1 << 5)))
+		{
+			return simd_level::avx2;
+		}
+	}
+	if (hasSse2)
+	{
+		return simd_level::sse2;
+	}
+#endif
+	return simd_level::scalar;
+}
+
+// active_simd_level
+//
+// The level the simd_ functions run at, detected on first use.
+//
+inline simd_level active_simd_level()
+{
+	static const simd_level level = static_cast<simd_level>(
+		std::min(static_cast<int>(detect_simd_level()), static_cast<int>(CLUSTER_SIMD_MAX_LEVEL)));
+	return level;
+}
+
+namespace detail
+{
+	template <typename T>
+	struct is_simd_type : std::integral_constant<bool,
+		std::is_same<T, float>::value || std::is_same<T, double>::value ||
+		std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value> {};
+
+	//The kernels for one element type at one simd_level, all taking a single contiguous run
+	template <typename T>
+	struct simd_kernel_table
+	{
+		T				(*mSum)(T const * first, T const * last);
+		T				(*mDot)(T const * first, T const * last, T const * other);
+		T				(*mMin)(T const * first, T const * last);
+		T				(*mMax)(T const * first, T const * last);
+		size_t			(*mArgMin)(T const * first, T const * last);
+		size_t			(*mArgMax)(T const * first, T const * last);
+		T const *		(*mFind)(T const * first, T const * last, T value);
+		size_t			(*mCount)(T const * first, T const * last, T value);
+	};
+
+	template <typename T>
+	struct scalar_traits
+	{
+		using scalar = T;
+		using vec = T;
+		static constexpr size_t kLanes = 1u;
+
+		static vec			zero() { return T(0); }
+		static vec			set1(T value) { return value; }
+		static vec			load(T const * p) { return *p; }
+		static void			store(T* p, vec v) { *p = v; }
+		static vec			add(vec a, vec b) { return a + b; }
+		static vec			mul(vec a, vec b) { return a * b; }
+		static vec			min(vec a, vec b) { return b < a ? b : a; }
+		static vec			max(vec a, vec b) { return a < b ? b : a; }
+		static unsigned		eq_mask(vec a, vec b) { return a == b ? 1u : 0u; }
+	};
+
+#if CLUSTER_SIMD_X86
+	#define CLUSTER_SIMD_SSE2 CLUSTER_SIMD_TARGET("sse2")
+
+	//int64_t needs SSE4.2 for comparisons, so it stays scalar at this level
+	template <typename T>
+	struct sse2_traits : scalar_traits<T> {};
+
+	template <>
+	struct sse2_traits<float>
+	{
+		using scalar = float;
+		using vec = __m128;
+		static constexpr size_t kLanes = 4u;
+
+		static CLUSTER_SIMD_SSE2 vec		zero() { return _mm_setzero_ps(); }
+		static CLUSTER_SIMD_SSE2 vec		set1(float value) { return _mm_set1_ps(value); }
+		static CLUSTER_SIMD_SSE2 vec		load(float const * p) { return _mm_loadu_ps(p); }
+		static CLUSTER_SIMD_SSE2 void		store(float* p, vec v) { _mm_storeu_ps(p, v); }
+		static CLUSTER_SIMD_SSE2 vec		add(vec a, vec b) { return _mm_add_ps(a, b); }
+		static CLUSTER_SIMD_SSE2 vec		mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+		static CLUSTER_SIMD_SSE2 vec		min(vec a, vec b) { return _mm_min_ps(a, b); }
+		static CLUSTER_SIMD_SSE2 vec		max(vec a, vec b) { return _mm_max_ps(a, b); }
+		static CLUSTER_SIMD_SSE2 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(a, b))); }
+	};
+
+	template <>
+	struct sse2_traits<double>
+	{
+		using scalar = double;
+		using vec = __m128d;
+		static constexpr size_t kLanes = 2u;
+
+		static CLUSTER_SIMD_SSE2 vec		zero() { return _mm_setzero_pd(); }
+		static CLUSTER_SIMD_SSE2 vec		set1(double value) { return _mm_set1_pd(value); }
+		static CLUSTER_SIMD_SSE2 vec		load(double const * p) { return _mm_loadu_pd(p); }
+		static CLUSTER_SIMD_SSE2 void		store(double* p, vec v) { _mm_storeu_pd(p, v); }
+		static CLUSTER_SIMD_SSE2 vec		add(vec a, vec b) { return _mm_add_pd(a, b); }
+		static CLUSTER_SIMD_SSE2 vec		mul(vec a, vec b) { return _mm_mul_pd(a, b); }
+		static CLUSTER_SIMD_SSE2 vec		min(vec a, vec b) { return _mm_min_pd(a, b); }
+		static CLUSTER_SIMD_SSE2 vec		max(vec a, vec b) { return _mm_max_pd(a, b); }
+		static CLUSTER_SIMD_SSE2 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(a, b))); }
+	};
+
+	template <>
+	struct sse2_traits<int32_t>
+	{
+		using scalar = int32_t;
+		using vec = __m128i;
+		static constexpr size_t kLanes = 4u;
+
+		static CLUSTER_SIMD_SSE2 vec		zero() { return _mm_setzero_si128(); }
+		static CLUSTER_SIMD_SSE2 vec		set1(int32_t value) { return _mm_set1_epi32(value); }
+		static CLUSTER_SIMD_SSE2 vec		load(int32_t const * p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+		static CLUSTER_SIMD_SSE2 void		store(int32_t* p, vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		static CLUSTER_SIMD_SSE2 vec		add(vec a, vec b) { return _mm_add_epi32(a, b); }
+		//No 32 bit multiply before SSE4.1, so multiply the even and odd lanes as 64 bit and keep the low halves
+		static CLUSTER_SIMD_SSE2 vec		mul(vec a, vec b)
+		{
+			__m128i even = _mm_mul_epu32(a, b);
+			__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+			return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+		}
+		static CLUSTER_SIMD_SSE2 vec		min(vec a, vec b) { __m128i greater = _mm_cmpgt_epi32(a, b); return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a)); }
+		static CLUSTER_SIMD_SSE2 vec		max(vec a, vec b) { __m128i greater = _mm_cmpgt_epi32(a, b); return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b)); }
+		static CLUSTER_SIMD_SSE2 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)))); }
+	};
+
+	#define CLUSTER_SIMD_AVX2 CLUSTER_SIMD_TARGET("avx2")
+
+	template <typename T>
+	struct avx2_traits;
+
+	template <>
+	struct avx2_traits<float>
+	{
+		using scalar = float;
+		using vec = __m256;
+		static constexpr size_t kLanes = 8u;
+
+		static CLUSTER_SIMD_AVX2 vec		zero() { return _mm256_setzero_ps(); }
+		static CLUSTER_SIMD_AVX2 vec		set1(float value) { return _mm256_set1_ps(value); }
+		static CLUSTER_SIMD_AVX2 vec		load(float const * p) { return _mm256_loadu_ps(p); }
+		static CLUSTER_SIMD_AVX2 void		store(float* p, vec v) { _mm256_storeu_ps(p, v); }
+		static CLUSTER_SIMD_AVX2 vec		add(vec a, vec b) { return _mm256_add_ps(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		min(vec a, vec b) { return _mm256_min_ps(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		max(vec a, vec b) { return _mm256_max_ps(a, b); }
+		static CLUSTER_SIMD_AVX2 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))); }
+	};
+
+	template <>
+	struct avx2_traits<double>
+	{
+		using scalar = double;
+		using vec = __m256d;
+		static constexpr size_t kLanes = 4u;
+
+		static CLUSTER_SIMD_AVX2 vec		zero() { return _mm256_setzero_pd(); }
+		static CLUSTER_SIMD_AVX2 vec		set1(double value) { return _mm256_set1_pd(value); }
+		static CLUSTER_SIMD_AVX2 vec		load(double const * p) { return _mm256_loadu_pd(p); }
+		static CLUSTER_SIMD_AVX2 void		store(double* p, vec v) { _mm256_storeu_pd(p, v); }
+		static CLUSTER_SIMD_AVX2 vec		add(vec a, vec b) { return _mm256_add_pd(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		min(vec a, vec b) { return _mm256_min_pd(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		max(vec a, vec b) { return _mm256_max_pd(a, b); }
+		static CLUSTER_SIMD_AVX2 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))); }
+	};
+
+	template <>
+	struct avx2_traits<int32_t>
+	{
+		using scalar = int32_t;
+		using vec = __m256i;
+		static constexpr size_t kLanes = 8u;
+
+		static CLUSTER_SIMD_AVX2 vec		zero() { return _mm256_setzero_si256(); }
+		static CLUSTER_SIMD_AVX2 vec		set1(int32_t value) { return _mm256_set1_epi32(value); }
+		static CLUSTER_SIMD_AVX2 vec		load(int32_t const * p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+		static CLUSTER_SIMD_AVX2 void		store(int32_t* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static CLUSTER_SIMD_AVX2 vec		add(vec a, vec b) { return _mm256_add_epi32(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		mul(vec a, vec b) { return _mm256_mullo_epi32(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		min(vec a, vec b) { return _mm256_min_epi32(a, b); }
+		static CLUSTER_SIMD_AVX2 vec		max(vec a, vec b) { return _mm256_max_epi32(a, b); }
+		static CLUSTER_SIMD_AVX2 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)))); }
+	};
+
+	template <>
+	struct avx2_traits<int64_t>
+	{
+		using scalar = int64_t;
+		using vec = __m256i;
+		static constexpr size_t kLanes = 4u;
+
+		static CLUSTER_SIMD_AVX2 vec		zero() { return _mm256_setzero_si256(); }
+		static CLUSTER_SIMD_AVX2 vec		set1(int64_t value) { return _mm256_set1_epi64x(value); }
+		static CLUSTER_SIMD_AVX2 vec		load(int64_t const * p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+		static CLUSTER_SIMD_AVX2 void		store(int64_t* p, vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static CLUSTER_SIMD_AVX2 vec		add(vec a, vec b) { return _mm256_add_epi64(a, b); }
+		//No 64 bit multiply before AVX-512DQ, so build the low 64 bits from 32 bit halves
+		static CLUSTER_SIMD_AVX2 vec		mul(vec a, vec b)
+		{
+			__m256i low = _mm256_mul_epu32(a, b);
+			__m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+			return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+		}
+		static CLUSTER_SIMD_AVX2 vec		min(vec a, vec b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+		static CLUSTER_SIMD_AVX2 vec		max(vec a, vec b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+		static CLUSTER_SIMD_AVX2 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)))); }
+	};
+
+	#define CLUSTER_SIMD_AVX512 CLUSTER_SIMD_TARGET("avx512f,avx512dq")
+
+	template <typename T>
+	struct avx512_traits;
+
+	template <>
+	struct avx512_traits<float>
+	{
+		using scalar = float;
+		using vec = __m512;
+		static constexpr size_t kLanes = 16u;
+
+		static CLUSTER_SIMD_AVX512 vec		zero() { return _mm512_setzero_ps(); }
+		static CLUSTER_SIMD_AVX512 vec		set1(float value) { return _mm512_set1_ps(value); }
+		static CLUSTER_SIMD_AVX512 vec		load(float const * p) { return _mm512_loadu_ps(p); }
+		static CLUSTER_SIMD_AVX512 void		store(float* p, vec v) { _mm512_storeu_ps(p, v); }
+		static CLUSTER_SIMD_AVX512 vec		add(vec a, vec b) { return _mm512_add_ps(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		min(vec a, vec b) { return _mm512_min_ps(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		max(vec a, vec b) { return _mm512_max_ps(a, b); }
+		static CLUSTER_SIMD_AVX512 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)); }
+	};
+
+	template <>
+	struct avx512_traits<double>
+	{
+		using scalar = double;
+		using vec = __m512d;
+		static constexpr size_t kLanes = 8u;
+
+		static CLUSTER_SIMD_AVX512 vec		zero() { return _mm512_setzero_pd(); }
+		static CLUSTER_SIMD_AVX512 vec		set1(double value) { return _mm512_set1_pd(value); }
+		static CLUSTER_SIMD_AVX512 vec		load(double const * p) { return _mm512_loadu_pd(p); }
+		static CLUSTER_SIMD_AVX512 void		store(double* p, vec v) { _mm512_storeu_pd(p, v); }
+		static CLUSTER_SIMD_AVX512 vec		add(vec a, vec b) { return _mm512_add_pd(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		mul(vec a, vec b) { return _mm512_mul_pd(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		min(vec a, vec b) { return _mm512_min_pd(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		max(vec a, vec b) { return _mm512_max_pd(a, b); }
+		static CLUSTER_SIMD_AVX512 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)); }
+	};
+
+	template <>
+	struct avx512_traits<int32_t>
+	{
+		using scalar = int32_t;
+		using vec = __m512i;
+		static constexpr size_t kLanes = 16u;
+
+		static CLUSTER_SIMD_AVX512 vec		zero() { return _mm512_setzero_si512(); }
+		static CLUSTER_SIMD_AVX512 vec		set1(int32_t value) { return _mm512_set1_epi32(value); }
+		static CLUSTER_SIMD_AVX512 vec		load(int32_t const * p) { return _mm512_loadu_si512(p); }
+		static CLUSTER_SIMD_AVX512 void		store(int32_t* p, vec v) { _mm512_storeu_si512(p, v); }
+		static CLUSTER_SIMD_AVX512 vec		add(vec a, vec b) { return _mm512_add_epi32(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		mul(vec a, vec b) { return _mm512_mullo_epi32(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		min(vec a, vec b) { return _mm512_min_epi32(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		max(vec a, vec b) { return _mm512_max_epi32(a, b); }
+		static CLUSTER_SIMD_AVX512 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm512_cmpeq_epi32_mask(a, b)); }
+	};
+
+	template <>
+	struct avx512_traits<int64_t>
+	{
+		using scalar = int64_t;
+		using vec = __m512i;
+		static constexpr size_t kLanes = 8u;
+
+		static CLUSTER_SIMD_AVX512 vec		zero() { return _mm512_setzero_si512(); }
+		static CLUSTER_SIMD_AVX512 vec		set1(int64_t value) { return _mm512_set1_epi64(value); }
+		static CLUSTER_SIMD_AVX512 vec		load(int64_t const * p) { return _mm512_loadu_si512(p); }
+		static CLUSTER_SIMD_AVX512 void		store(int64_t* p, vec v) { _mm512_storeu_si512(p, v); }
+		static CLUSTER_SIMD_AVX512 vec		add(vec a, vec b) { return _mm512_add_epi64(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		mul(vec a, vec b) { return _mm512_mullo_epi64(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		min(vec a, vec b) { return _mm512_min_epi64(a, b); }
+		static CLUSTER_SIMD_AVX512 vec		max(vec a, vec b) { return _mm512_max_epi64(a, b); }
+		static CLUSTER_SIMD_AVX512 unsigned	eq_mask(vec a, vec b) { return static_cast<unsigned>(_mm512_cmpeq_epi64_mask(a, b)); }
+	};
+#endif
+}
+}
+
+#define CLUSTER_SIMD_KERNEL_NAMESPACE scalar_kernels
+#define CLUSTER_SIMD_KERNEL_TARGET
+#include "ClusterSimdKernels.inl"
+#undef CLUSTER_SIMD_KERNEL_NAMESPACE
+#undef CLUSTER_SIMD_KERNEL_TARGET
+
+#if CLUSTER_SIMD_X86
+#define CLUSTER_SIMD_KERNEL_NAMESPACE sse2_kernels
+#define CLUSTER_SIMD_KERNEL_TARGET CLUSTER_SIMD_SSE2
+#include "ClusterSimdKernels.inl"
+#undef CLUSTER_SIMD_KERNEL_NAMESPACE
+#undef CLUSTER_SIMD_KERNEL_TARGET
+
+#define CLUSTER_SIMD_KERNEL_NAMESPACE avx2_kernels
+#define CLUSTER_SIMD_KERNEL_TARGET CLUSTER_SIMD_AVX2
+#include "ClusterSimdKernels.inl"
+#undef CLUSTER_SIMD_KERNEL_NAMESPACE
+#undef CLUSTER_SIMD_KERNEL_TARGET
+
+#define CLUSTER_SIMD_KERNEL_NAMESPACE avx512_kernels
+#define CLUSTER_SIMD_KERNEL_TARGET CLUSTER_SIMD_AVX512
+#include "ClusterSimdKernels.inl"
+#undef CLUSTER_SIMD_KERNEL_NAMESPACE
+#undef CLUSTER_SIMD_KERNEL_TARGET
+#endif
+
+namespace sw
+{
+namespace detail
+{
+	//The kernels for T at exactly the given level, which the CPU must support
+	template <typename T>
+	inline simd_kernel_table<T> simd_kernels(simd_level level)
+	{
+		switch (level)
+		{
+#if CLUSTER_SIMD_X86
+		case simd_level::avx512:	return avx512_kernels::kernel_table<avx512_traits<T>>();
+		case simd_level::avx2:		return avx2_kernels::kernel_table<avx2_traits<T>>();
+		case simd_level::sse2:		return sse2_kernels::kernel_table<sse2_traits<T>>();
+#endif
+		default:					return scalar_kernels::kernel_table<scalar_traits<T>>();
+		}
+	}
+
+	template <typename T>
+	inline simd_kernel_table<T> const & active_simd_kernels()
+	{
+		static_assert(is_simd_type<T>::value, "simd_ functions support float, double, int32_t and int64_t elements");
+		static const simd_kernel_table<T> table = simd_kernels<T>(active_simd_level());
+		return table;
+	}
+}
+
+// simd_sum
+//
+// The sum of every element, 0 when empty.
+//
+template <typename Container>
+inline typename Container::value_type simd_sum(Container const & container)
+{
+	using value_type = typename Container::value_type;
+	auto const & kernels = detail::active_simd_kernels<value_type>();
+	value_type result = value_type(0);
+	for (auto segment : container.segments())
+	{
+		result += kernels.mSum(segment.begin(), segment.end());
+	}
+	return result;
+}
+
+// simd_min / simd_max
+//
+// The smallest / largest element. The container must not be empty.
+//
+template <typename Container>
+inline typename Container::value_type simd_min(Container const & container)
+{
+	using value_type = typename Container::value_type;
+	auto const & kernels = detail::active_simd_kernels<value_type>();
+	CLUSTER_ASSERT(!container.empty());
+	auto segment = container.segments().begin();
+	auto segmentEnd = container.segments().end();
+	value_type result = kernels.mMin((*segment).begin(), (*segment).end());
+	for (++segment; segment != segmentEnd; ++segment)
+	{
+		value_type candidate = kernels.mMin((*segment).begin(), (*segment).end());
+		result = candidate < result ? candidate : result;
+	}
+	return result;
+}
+
+template <typename Container>
+inline typename Container::value_type simd_max(Container const & container)
+{
+	using value_type = typename Container::value_type;
+	auto const & kernels = detail::active_simd_kernels<value_type>();
+	CLUSTER_ASSERT(!container.empty());
+	auto segment = container.segments().begin();
+	auto segmentEnd = container.segments().end();
+	value_type result = kernels.mMax((*segment).begin(), (*segment).end());
+	for (++segment; segment != segmentEnd; ++segment)
+	{
+		value_type candidate = kernels.mMax((*segment).begin(), (*segment).end());
+		result = result < candidate ? candidate : result;
+	}
+	return result;
+}
+
+// simd_argmin / simd_argmax
+//
+// Index of the first smallest / largest element, size() when empty.
+//
+template <typename Container>
+inline size_t simd_argmin(Container const & container)
+{
+	using value_type = typename Container::value_type;
+	auto const & kernels = detail::active_simd_kernels<value_type>();
+	size_t result = container.size();
+	size_t segmentStart = 0u;
+	value_type best = value_type(0);
+	for (auto segment : container.segments())
+	{
+		size_t offset = kernels.mArgMin(segment.begin(), segment.end());
+		if (result == container.size() || segment.begin()[offset] < best)
+		{
+			best = segment.begin()[offset];
+			result = segmentStart + offset;
+		}
+		segmentStart += segment.size();
+	}
+	return result;
+}
+
+template <typename Container>
+inline size_t simd_argmax(Container const & container)
+{
+	using value_type = typename Container::value_type;
+	auto const & kernels = detail::active_simd_kernels<value_type>();
+	size_t result = container.size();
+	size_t segmentStart = 0u;
+	value_type best = value_type(0);
+	for (auto segment : container.segments())
+	{
+		size_t offset = kernels.mArgMax(segment.begin(), segment.end());
+		if (result == container.size() || best < segment.begin()[offset])
+		{
+			best = segment.begin()[offset];
+			result = segmentStart + offset;
+		}
+		segmentStart += segment.size();
+	}
+	return result;
+}
+
+// simd_find
+//
+// Index of the first element equal to value, size() if there is none.
+//
+template <typename Container>
+inline size_t simd_find(Container const & container, typename Container::value_type value)
+{
+	auto const & kernels = detail::active_simd_kernels<typename Container::value_type>();
+	size_t segmentStart = 0u;
+	for (auto segment : container.segments())
+	{
+		auto found = kernels.mFind(segment.begin(), segment.end(), value);
+		if (found != segment.end())
+		{
+			return segmentStart + static_cast<size_t>(found - segment.begin());
+		}
+		segmentStart += segment.size();
+	}
+	return segmentStart;
+}
+
+// simd_count
+//
+// Number of elements equal to value.
+//
+template <typename Container>
+inline size_t simd_count(Container const & container, typename Container::value_type value)
+{
+	auto const & kernels = detail::active_simd_kernels<typename Container::value_type>();
+	size_t result = 0u;
+	for (auto segment : container.segments())
+	{
+		result += kernels.mCount(segment.begin(), segment.end(), value);
+	}
+	return result;
+}
+
+// simd_dot
+//
+// Sum of the products of the elements at each index. The containers must
+// be the same size but needn't share a cluster layout.
+//
+template <typename ContainerA, typename ContainerB>
+inline typename ContainerA::value_type simd_dot(ContainerA const & a, ContainerB const & b)
+{
+	using value_type = typename ContainerA::value_type;
+	static_assert(std::is_same<value_type, typename ContainerB::value_type>::value, "simd_dot needs matching element types");
+	auto const & kernels = detail::active_simd_kernels<value_type>();
+	CLUSTER_ASSERT(a.size() == b.size());
+	value_type result = value_type(0);
+	auto otherSegment = b.segments().begin();
+	value_type const * other = nullptr;
+	value_type const * otherEnd = nullptr;
+	for (auto segment : a.segments())
+	{
+		value_type const * first = segment.begin();
+		value_type const * last = segment.end();
+		while (first != last)
+		{
+			if (other == otherEnd)
+			{
+				other = (*otherSegment).begin();
+				otherEnd = (*otherSegment).end();
+				++otherSegment;
+			}
+			//Both runs are contiguous, so take the overlap in one go
+			ptrdiff_t run = std::min(last - first, otherEnd - other);
+			result += kernels.mDot(first, first + run, other);
+			first += run;
+			other += run;
+		}
+	}
+	return result;
+}
+
+}
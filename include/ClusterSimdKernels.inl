@@ -0,0 +1,261 @@
+//-----------------------------------------------------------------------------
+//	Kernel bodies for ClusterSimd.h, deliberately without include guards.
+//
+//	ClusterSimd.h includes this once per instruction set, each time with
+//	CLUSTER_SIMD_KERNEL_NAMESPACE naming the namespace to define the kernels
+//	in and CLUSTER_SIMD_KERNEL_TARGET holding the matching target attribute.
+//	Intrinsics can only be inlined into functions compiled for their
+//	instruction set, so the shared bodies have to be stamped out per target
+//	rather than written once as templates over the traits.
+//
+//	Every kernel is written against a traits type V providing:
+//	    scalar, vec, kLanes
+//	    zero(), set1(s), load(p), store(p, v)
+//	    add(a, b), mul(a, b), min(a, b), max(a, b)
+//	    eq_mask(a, b)    one bit per equal lane, lane 0 in bit 0
+//-----------------------------------------------------------------------------
+
+#if !defined(CLUSTER_SIMD_KERNEL_NAMESPACE) || !defined(CLUSTER_SIMD_KERNEL_TARGET)
+#error Include ClusterSimd.h rather than ClusterSimdKernels.inl
+#endif
+
+namespace sw
+{
+namespace detail
+{
+namespace CLUSTER_SIMD_KERNEL_NAMESPACE
+{
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET inline typename V::scalar fold_add(typename V::vec v)
+	{
+		typename V::scalar lanes[V::kLanes];
+		V::store(lanes, v);
+		typename V::scalar result = lanes[0];
+		for (size_t i = 1; i < V::kLanes; ++i)
+		{
+			result += lanes[i];
+		}
+		return result;
+	}
+
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET inline typename V::scalar fold_min(typename V::vec v)
+	{
+		typename V::scalar lanes[V::kLanes];
+		V::store(lanes, v);
+		typename V::scalar result = lanes[0];
+		for (size_t i = 1; i < V::kLanes; ++i)
+		{
+			result = lanes[i] < result ? lanes[i] : result;
+		}
+		return result;
+	}
+
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET inline typename V::scalar fold_max(typename V::vec v)
+	{
+		typename V::scalar lanes[V::kLanes];
+		V::store(lanes, v);
+		typename V::scalar result = lanes[0];
+		for (size_t i = 1; i < V::kLanes; ++i)
+		{
+			result = result < lanes[i] ? lanes[i] : result;
+		}
+		return result;
+	}
+
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET typename V::scalar sum(typename V::scalar const * first, typename V::scalar const * last)
+	{
+		const ptrdiff_t lanes = static_cast<ptrdiff_t>(V::kLanes);
+		typename V::vec a0 = V::zero(), a1 = V::zero(), a2 = V::zero(), a3 = V::zero();
+		//Four independent accumulators keep the adds from serialising on their latency
+		for (; last - first >= 4 * lanes; first += 4 * lanes)
+		{
+			a0 = V::add(a0, V::load(first));
+			a1 = V::add(a1, V::load(first + lanes));
+			a2 = V::add(a2, V::load(first + 2 * lanes));
+			a3 = V::add(a3, V::load(first + 3 * lanes));
+		}
+		a0 = V::add(V::add(a0, a1), V::add(a2, a3));
+		for (; last - first >= lanes; first += lanes)
+		{
+			a0 = V::add(a0, V::load(first));
+		}
+		typename V::scalar result = fold_add<V>(a0);
+		for (; first != last; ++first)
+		{
+			result += *first;
+		}
+		return result;
+	}
+
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET typename V::scalar dot(typename V::scalar const * first, typename V::scalar const * last, typename V::scalar const * other)
+	{
+		const ptrdiff_t lanes = static_cast<ptrdiff_t>(V::kLanes);
+		typename V::vec a0 = V::zero(), a1 = V::zero();
+		for (; last - first >= 2 * lanes; first += 2 * lanes, other += 2 * lanes)
+		{
+			a0 = V::add(a0, V::mul(V::load(first), V::load(other)));
+			a1 = V::add(a1, V::mul(V::load(first + lanes), V::load(other + lanes)));
+		}
+		a0 = V::add(a0, a1);
+		for (; last - first >= lanes; first += lanes, other += lanes)
+		{
+			a0 = V::add(a0, V::mul(V::load(first), V::load(other)));
+		}
+		typename V::scalar result = fold_add<V>(a0);
+		for (; first != last; ++first, ++other)
+		{
+			result += *first * *other;
+		}
+		return result;
+	}
+
+	//Requires first != last
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET typename V::scalar min(typename V::scalar const * first, typename V::scalar const * last)
+	{
+		const ptrdiff_t lanes = static_cast<ptrdiff_t>(V::kLanes);
+		typename V::scalar result = *first;
+		if (last - first >= 2 * lanes)
+		{
+			typename V::vec m0 = V::load(first), m1 = V::load(first + lanes);
+			for (first += 2 * lanes; last - first >= 2 * lanes; first += 2 * lanes)
+			{
+				m0 = V::min(m0, V::load(first));
+				m1 = V::min(m1, V::load(first + lanes));
+			}
+			result = fold_min<V>(V::min(m0, m1));
+		}
+		for (; first != last; ++first)
+		{
+			result = *first < result ? *first : result;
+		}
+		return result;
+	}
+
+	//Requires first != last
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET typename V::scalar max(typename V::scalar const * first, typename V::scalar const * last)
+	{
+		const ptrdiff_t lanes = static_cast<ptrdiff_t>(V::kLanes);
+		typename V::scalar result = *first;
+		if (last - first >= 2 * lanes)
+		{
+			typename V::vec m0 = V::load(first), m1 = V::load(first + lanes);
+			for (first += 2 * lanes; last - first >= 2 * lanes; first += 2 * lanes)
+			{
+				m0 = V::max(m0, V::load(first));
+				m1 = V::max(m1, V::load(first + lanes));
+			}
+			result = fold_max<V>(V::max(m0, m1));
+		}
+		for (; first != last; ++first)
+		{
+			result = result < *first ? *first : result;
+		}
+		return result;
+	}
+
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET typename V::scalar const * find(typename V::scalar const * first, typename V::scalar const * last, typename V::scalar value)
+	{
+		const ptrdiff_t lanes = static_cast<ptrdiff_t>(V::kLanes);
+		typename V::vec needle = V::set1(value);
+		for (; last - first >= lanes; first += lanes)
+		{
+			if (unsigned mask = V::eq_mask(V::load(first), needle))
+			{
+				return first + CLUSTER_COUNT_TRAILING_ZEROES(mask);
+			}
+		}
+		for (; first != last; ++first)
+		{
+			if (*first == value)
+			{
+				return first;
+			}
+		}
+		return last;
+	}
+
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET size_t count(typename V::scalar const * first, typename V::scalar const * last, typename V::scalar value)
+	{
+		const ptrdiff_t lanes = static_cast<ptrdiff_t>(V::kLanes);
+		typename V::vec needle = V::set1(value);
+		size_t result = 0u;
+		for (; last - first >= lanes; first += lanes)
+		{
+			result += static_cast<size_t>(CLUSTER_POPULATION_COUNT(V::eq_mask(V::load(first), needle)));
+		}
+		for (; first != last; ++first)
+		{
+			result += *first == value ? 1u : 0u;
+		}
+		return result;
+	}
+
+	//Offset of the first smallest element, requires first != last. Each block's
+	//minimum is found with the vector kernel and only a block that improves on
+	//the best so far is searched again, while it is still in L1.
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET size_t argmin(typename V::scalar const * first, typename V::scalar const * last)
+	{
+		const ptrdiff_t blockSize = 1024;
+		typename V::scalar best = *first;
+		size_t bestOffset = 0u;
+		for (typename V::scalar const * block = first; block != last; )
+		{
+			typename V::scalar const * blockEnd = last - block > blockSize ? block + blockSize : last;
+			typename V::scalar blockBest = min<V>(block, blockEnd);
+			if (blockBest < best)
+			{
+				best = blockBest;
+				bestOffset = static_cast<size_t>(find<V>(block, blockEnd, blockBest) - first);
+			}
+			block = blockEnd;
+		}
+		return bestOffset;
+	}
+
+	//Offset of the first largest element, requires first != last
+	template <typename V>
+	CLUSTER_SIMD_KERNEL_TARGET size_t argmax(typename V::scalar const * first, typename V::scalar const * last)
+	{
+		const ptrdiff_t blockSize = 1024;
+		typename V::scalar best = *first;
+		size_t bestOffset = 0u;
+		for (typename V::scalar const * block = first; block != last; )
+		{
+			typename V::scalar const * blockEnd = last - block > blockSize ? block + blockSize : last;
+			typename V::scalar blockBest = max<V>(block, blockEnd);
+			if (best < blockBest)
+			{
+				best = blockBest;
+				bestOffset = static_cast<size_t>(find<V>(block, blockEnd, blockBest) - first);
+			}
+			block = blockEnd;
+		}
+		return bestOffset;
+	}
+
+	template <typename V>
+	inline simd_kernel_table<typename V::scalar> kernel_table()
+	{
+		simd_kernel_table<typename V::scalar> table;
+		table.mSum = &sum<V>;
+		table.mDot = &dot<V>;
+		table.mMin = &min<V>;
+		table.mMax = &max<V>;
+		table.mArgMin = &argmin<V>;
+		table.mArgMax = &argmax<V>;
+		table.mFind = &find<V>;
+		table.mCount = &count<V>;
+		return table;
+	}
+}
+}
+}
@@ -0,0 +1,523 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	Binary snapshots of cluster_vector and cluster_map for trivially copyable
+//	elements, loaded by mapping the file instead of rebuilding the container
+//	element by element.
+//
+//	A snapshot is a snapshot_header followed by a single cluster image at a
+//	page aligned offset: room for the cluster header, then the elements laid
+//	out exactly as a cluster holds them. load_mapped() maps the file privately,
+//	writes the cluster header in place and hands the image to the container
+//	as its first cluster, so iteration and lookups read straight from the
+//	mapping. Writes through the container land on copy-on-write pages and
+//	never reach the file. Growing past the snapshot appends ordinary clusters,
+//	and the mapping is released once that first cluster is freed.
+//
+//	A cluster_map's dense elements are stored just as a cluster_vector's are,
+//	followed by the sparse slot number of each one, so loading leaves the
+//	element pages untouched. The dense slot numbers, the sparse indices and
+//	the free list are rebuilt on the heap, with each slot's generation
+//	restored so that cluster_map_keys taken before saving still resolve after
+//	loading.
+//
+//	The format is native rather than portable: the header records byte order,
+//	pointer size, element size and alignment and the cluster header size, and
+//	loading refuses a file that does not match. A cluster_map file is also
+//	refused unless each sparse slot is named exactly once, by a dense element
+//	or by the free list.
+//
+//	Example usage:
+//	    int fd = open("positions.bin", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+//	    sw::save(fd, positions);
+//	    close(fd);
+//
+//	    sw::cluster_vector<vec3, Allocator> restored;
+//	    if (sw::load_mapped("positions.bin", restored)) { ... }
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+#include "ClusterMap.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#include <io.h>
+#else
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace sw
+{
+
+enum class snapshot_kind : uint32_t
+{
+	vector	= 1,
+	map		= 2,
+};
+
+struct snapshot_header
+{
+	static const uint32_t	kVersion = 3u;
+	static const uint32_t	kByteOrderMark = 0x01020304u;
+	static const uint64_t	kClusterAlignment = 4096u;	//The cluster image starts on a page so that the mapping keeps it aligned
+
+	char					mMagic[8];
+	uint32_t				mVersion;
+	uint32_t				mByteOrder;					//kByteOrderMark as the saving machine stores it
+	snapshot_kind			mKind;
+	uint32_t				mPointerSize;
+	uint64_t				mElementSize;
+	uint64_t				mElementAlignment;
+	uint64_t				mClusterHeaderSize;			//Offset of the first element within the cluster image
+	uint64_t				mCount;						//Live elements in the cluster image
+	uint64_t				mClusterOffset;				//File offset of the cluster image
+	uint64_t				mIndexCount;				//cluster_map only: sparse indices, live and free
+	uint64_t				mDenseSlotOffset;			//cluster_map only: file offset of each dense element's sparse slot number, as uint32_t
+	uint64_t				mFreeCount;					//cluster_map only: entries in the free list
+	uint64_t				mFreeOffset;				//cluster_map only: file offset of the free list, as uint64_t sparse slot numbers
+	uint64_t				mGenerationOffset;			//cluster_map only: file offset of every sparse slot's generation, as uint32_t
+};
+
+namespace detail
+{
+	static const char kSnapshotMagic[8] = { 'S', 'W', 'C', 'L', 'S', 'N', 'A', 'P' };
+
+	inline uint64_t align_offset(uint64_t offset, uint64_t alignment)
+	{
+		return (offset + alignment - 1u) / alignment * alignment;
+	}
+
+	inline bool write_all(int fd, void const * data, uint64_t size)
+	{
+		char const * bytes = static_cast<char const *>(data);
+		while (size)
+		{
+#if defined(_WIN32)
+			int written = _write(fd, bytes, static_cast<unsigned>(size < 0x40000000u ? size : 0x40000000u));
+#else
+			ssize_t written = ::write(fd, bytes, static_cast<size_t>(size));
+			if (written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+#endif
+			if (written <= 0)
+			{
+				return false;
+			}
+			bytes += written;
+			size -= static_cast<uint64_t>(written);
+		}
+		return true;
+	}
+
+	inline bool write_zeroes(int fd, uint64_t size)
+	{
+		static const char zeroes[256] = {};
+		while (size)
+		{
+			uint64_t chunk = size < sizeof(zeroes) ? size : sizeof(zeroes);
+			if (!write_all(fd, zeroes, chunk))
+			{
+				return false;
+			}
+			size -= chunk;
+		}
+		return true;
+	}
+
+	struct mapped_file
+	{
+		void*	mBase;
+		size_t	mLength;
+	};
+
+	inline void unmap_file(void* base, size_t length)
+	{
+#if defined(_WIN32)
+		CLUSTER_UNUSED(length);
+		UnmapViewOfFile(base);
+#else
+		munmap(base, length);
+#endif
+	}
+
+	//Maps the whole file copy-on-write, so the pages can be written without changing the file
+	inline bool map_file_private(char const * path, mapped_file& mapping)
+	{
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER fileSize;
+		HANDLE fileMapping = nullptr;
+		mapping.mBase = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			fileMapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		}
+		if (fileMapping)
+		{
+			mapping.mBase = MapViewOfFile(fileMapping, FILE_MAP_COPY, 0, 0, 0);
+			mapping.mLength = static_cast<size_t>(fileSize.QuadPart);
+			//The view keeps the mapping alive on its own
+			CloseHandle(fileMapping);
+		}
+		CloseHandle(file);
+		return mapping.mBase != nullptr;
+#else
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+		{
+			return false;
+		}
+		struct stat fileStat;
+		void* base = MAP_FAILED;
+		if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+		{
+			base = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		}
+		close(fd);
+		if (base == MAP_FAILED)
+		{
+			return false;
+		}
+		mapping.mBase = base;
+		mapping.mLength = static_cast<size_t>(fileStat.st_size);
+		return true;
+#endif
+	}
+
+	template <typename Element, typename ClusterElement>
+	inline snapshot_header make_snapshot_header(snapshot_kind kind, uint64_t count)
+	{
+		snapshot_header header{};
+		memcpy(header.mMagic, kSnapshotMagic, sizeof(kSnapshotMagic));
+		header.mVersion = snapshot_header::kVersion;
+		header.mByteOrder = snapshot_header::kByteOrderMark;
+		header.mKind = kind;
+		header.mPointerSize = sizeof(void*);
+		header.mElementSize = sizeof(Element);
+		header.mElementAlignment = CLUSTER_ALIGN_OF(Element);
+		header.mClusterHeaderSize = CLUSTER_OFFSETOF(cluster_helper<ClusterElement>, mDummyData);
+		header.mCount = count;
+		header.mClusterOffset = align_offset(sizeof(snapshot_header), snapshot_header::kClusterAlignment);
+		return header;
+	}
+
+	//Checks that the mapping holds a snapshot this build can serve in place, including every range the header points at
+	template <typename Element, typename ClusterElement>
+	inline bool check_snapshot_header(mapped_file const & mapping, snapshot_kind kind)
+	{
+		static_assert(CLUSTER_ALIGN_OF(cluster_helper<ClusterElement>) <= snapshot_header::kClusterAlignment, "Cluster images must be aligned by their page aligned offset");
+
+		if (mapping.mLength < sizeof(snapshot_header))
+		{
+			return false;
+		}
+		snapshot_header const & header = *static_cast<snapshot_header const *>(mapping.mBase);
+		snapshot_header const expected = make_snapshot_header<Element, ClusterElement>(kind, 0u);
+		if (memcmp(header.mMagic, expected.mMagic, sizeof(expected.mMagic)) != 0 ||
+			header.mVersion != expected.mVersion ||
+			header.mByteOrder != expected.mByteOrder ||
+			header.mKind != expected.mKind ||
+			header.mPointerSize != expected.mPointerSize ||
+			header.mElementSize != expected.mElementSize ||
+			header.mElementAlignment != expected.mElementAlignment ||
+			header.mClusterHeaderSize != expected.mClusterHeaderSize ||
+			header.mClusterOffset % snapshot_header::kClusterAlignment != 0u)
+		{
+			return false;
+		}
+
+		uint64_t const length = mapping.mLength;
+		if (header.mClusterOffset > length || header.mClusterHeaderSize > length - header.mClusterOffset ||
+			header.mCount > (length - header.mClusterOffset - header.mClusterHeaderSize) / header.mElementSize)
+		{
+			return false;
+		}
+		if (kind == snapshot_kind::map)
+		{
+			//Every sparse slot is either live or free, and slot numbers must fit the map's 32-bit dense and slot links
+			if (header.mIndexCount >= (uint64_t(1) << 32u) ||
+				header.mCount > header.mIndexCount || header.mFreeCount != header.mIndexCount - header.mCount ||
+				header.mDenseSlotOffset > length || header.mDenseSlotOffset % sizeof(uint32_t) != 0u ||
+				header.mCount > (length - header.mDenseSlotOffset) / sizeof(uint32_t) ||
+				header.mFreeOffset > length || header.mFreeOffset % sizeof(uint64_t) != 0u ||
+				header.mFreeCount > (length - header.mFreeOffset) / sizeof(uint64_t) ||
+				header.mGenerationOffset > length || header.mGenerationOffset % sizeof(uint32_t) != 0u ||
+				header.mIndexCount > (length - header.mGenerationOffset) / sizeof(uint32_t))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//The containers' internals that loading and saving need, kept out of their public interfaces
+	struct snapshot_access
+	{
+		template <typename Vector>
+		static void adopt_cluster(Vector& vector, void* image, size_t count, mapped_file const & mapping)
+		{
+			external_cluster external{};
+			external.mBase = mapping.mBase;
+			external.mLength = mapping.mLength;
+			external.mRelease = &unmap_file;
+			vector.DoAdoptCluster(image, count, external);
+		}
+
+		template <typename Map>
+		static bool save(int fd, Map const & map)
+		{
+			using storage_type = typename Map::storage_type;
+			using index_type = typename Map::index_type;
+			using sparse_index_type = typename Map::sparse_index_type;
+
+			uint64_t const count = map.size();
+			snapshot_header header = make_snapshot_header<storage_type, storage_type>(snapshot_kind::map, count);
+			uint64_t const elementsEnd = header.mClusterOffset + header.mClusterHeaderSize + count * sizeof(storage_type);
+			header.mIndexCount = map.mSparseIndices.size();
+			header.mDenseSlotOffset = align_offset(elementsEnd, sizeof(uint32_t));
+			uint64_t const denseSlotsEnd = header.mDenseSlotOffset + count * sizeof(uint32_t);
+			header.mFreeCount = map.mUnoccupiedElements.size();
+			header.mFreeOffset = align_offset(denseSlotsEnd, sizeof(uint64_t));
+			header.mGenerationOffset = header.mFreeOffset + header.mFreeCount * sizeof(uint64_t);
+
+			if (!write_all(fd, &header, sizeof(header)) ||
+				!write_zeroes(fd, header.mClusterOffset + header.mClusterHeaderSize - sizeof(header)))
+			{
+				return false;
+			}
+			for (auto segment : map.segments())
+			{
+				if (!write_all(fd, segment.begin(), segment.size() * sizeof(storage_type)))
+				{
+					return false;
+				}
+			}
+			if (!write_zeroes(fd, header.mDenseSlotOffset - elementsEnd))
+			{
+				return false;
+			}
+			for (auto segment : map.mDenseSlots.segments())
+			{
+				if (!write_all(fd, segment.begin(), segment.size() * sizeof(uint32_t)))
+				{
+					return false;
+				}
+			}
+			if (!write_zeroes(fd, header.mFreeOffset - denseSlotsEnd))
+			{
+				return false;
+			}
+
+			//A free slot holds its own number
+			for (index_type* freeSlot : map.mUnoccupiedElements)
+			{
+				uint64_t slot = Map::DoSlotOf(freeSlot)->mDense;
+				if (!write_all(fd, &slot, sizeof(slot)))
+				{
+					return false;
+				}
+			}
+			for (auto segment : map.mSparseIndices.segments())
+			{
+				for (sparse_index_type const * slot = segment.begin(); slot != segment.end(); ++slot)
+				{
+					if (!write_all(fd, &slot->mGeneration, sizeof(slot->mGeneration)))
+					{
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		template <typename Map>
+		static bool load(Map& map, mapped_file const & mapping)
+		{
+			using storage_type = typename Map::storage_type;
+			using index_type = typename Map::index_type;
+			using T = typename Map::value_type;
+
+			snapshot_header const & header = *static_cast<snapshot_header const *>(mapping.mBase);
+			char* const base = static_cast<char*>(mapping.mBase);
+			size_t const count = static_cast<size_t>(header.mCount);
+
+			map.clear();
+			map.mSparseIndices.resize(static_cast<size_t>(header.mIndexCount));
+			uint32_t const * generations = reinterpret_cast<uint32_t const *>(base + header.mGenerationOffset);
+			uint32_t slotNumber = 0u;
+			for (auto segment : map.mSparseIndices.segments())
+			{
+				for (auto slot = segment.begin(); slot != segment.end(); ++slot, ++slotNumber)
+				{
+					slot->mElement = nullptr;
+					slot->mDense = slotNumber;
+					slot->mGeneration = generations[slotNumber] ? generations[slotNumber] : 1u;
+					if (slot->mGeneration >= map.mNextSlotGeneration)
+					{
+						map.mNextSlotGeneration = detail::next_generation(slot->mGeneration);
+					}
+				}
+			}
+			//Each slot must be named once, by the free list or by a dense element. Free slots hold a placeholder
+			//until the dense elements are linked, so that a slot named twice is seen as already taken.
+			T* const claimed = reinterpret_cast<T*>(base);
+			uint64_t const * freeSlots = reinterpret_cast<uint64_t const *>(base + header.mFreeOffset);
+			for (uint64_t const * i = freeSlots, *e = freeSlots + header.mFreeCount; i != e; ++i)
+			{
+				if (*i >= header.mIndexCount || map.mSparseIndices[static_cast<size_t>(*i)].mElement)
+				{
+					map.clear();
+					unmap_file(mapping.mBase, mapping.mLength);
+					return false;
+				}
+				index_type* slotPtr = &map.mSparseIndices[static_cast<size_t>(*i)].mElement;
+				*slotPtr = claimed;
+				map.mUnoccupiedElements.push_back(slotPtr);
+			}
+
+			//Link each dense element and its sparse slot before handing the image over, so a bad slot can still back out
+			storage_type* elements = reinterpret_cast<storage_type*>(base + header.mClusterOffset + header.mClusterHeaderSize);
+			uint32_t const * denseSlots = reinterpret_cast<uint32_t const *>(base + header.mDenseSlotOffset);
+			map.mDenseSlots.reserve(count);
+			for (size_t position = 0u; position != count; ++position)
+			{
+				uint32_t slot = denseSlots[position];
+				if (slot >= header.mIndexCount || map.mSparseIndices[slot].mElement)
+				{
+					map.clear();
+					unmap_file(mapping.mBase, mapping.mLength);
+					return false;
+				}
+				map.mSparseIndices[slot].mElement = reinterpret_cast<T*>(&elements[position].mData);
+				map.mSparseIndices[slot].mDense = static_cast<uint32_t>(position);
+				map.mDenseSlots.push_back(slot);
+			}
+			for (index_type* freeSlot : map.mUnoccupiedElements)
+			{
+				*freeSlot = nullptr;
+			}
+
+			if (!count)
+			{
+				unmap_file(mapping.mBase, mapping.mLength);
+				return true;
+			}
+
+			adopt_cluster(map.mDenseStorage, base + header.mClusterOffset, count, mapping);
+			map.mDenseEnd = map.mDenseStorage.begin();
+			map.mDenseEnd.mCurrent += count;
+			return true;
+		}
+	};
+}
+
+// save
+//
+// Writes the container to fd as a snapshot that load_mapped() can serve in
+// place. Returns false if a write fails, leaving fd at an unspecified offset.
+//
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool save(int fd, cluster_vector<T, Allocator, tStepSize, GrowthPolicy> const & container)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Snapshots store elements as raw bytes");
+
+	snapshot_header header = detail::make_snapshot_header<T, T>(snapshot_kind::vector, container.size());
+	if (!detail::write_all(fd, &header, sizeof(header)) ||
+		!detail::write_zeroes(fd, header.mClusterOffset + header.mClusterHeaderSize - sizeof(header)))
+	{
+		return false;
+	}
+	for (auto segment : container.segments())
+	{
+		if (!detail::write_all(fd, segment.begin(), segment.size() * sizeof(T)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool save(int fd, cluster_map<T, Allocator, tStepSize, GrowthPolicy> const & container)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Snapshots store elements as raw bytes");
+	return detail::snapshot_access::save(fd, container);
+}
+
+// load_mapped
+//
+// Replaces the container's contents with the snapshot at path, mapped
+// copy-on-write and served in place. Returns false and leaves the container
+// empty if the file cannot be mapped or was saved for a different element
+// type, pointer size or byte order.
+//
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool load_mapped(char const * path, cluster_vector<T, Allocator, tStepSize, GrowthPolicy>& container)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "Snapshots store elements as raw bytes");
+
+	container.clear();
+	detail::mapped_file mapping;
+	if (!detail::map_file_private(path, mapping))
+	{
+		return false;
+	}
+	if (!detail::check_snapshot_header<T, T>(mapping, snapshot_kind::vector))
+	{
+		detail::unmap_file(mapping.mBase, mapping.mLength);
+		return false;
+	}
+
+	snapshot_header const & header = *static_cast<snapshot_header const *>(mapping.mBase);
+	if (!header.mCount)
+	{
+		detail::unmap_file(mapping.mBase, mapping.mLength);
+		return true;
+	}
+	detail::snapshot_access::adopt_cluster(container, static_cast<char*>(mapping.mBase) + header.mClusterOffset, static_cast<size_t>(header.mCount), mapping);
+	return true;
+}
+
+template <typename T, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool load_mapped(char const * path, cluster_map<T, Allocator, tStepSize, GrowthPolicy>& container)
+{
+	using storage_type = typename cluster_map<T, Allocator, tStepSize, GrowthPolicy>::storage_type;
+	static_assert(std::is_trivially_copyable<T>::value, "Snapshots store elements as raw bytes");
+
+	container.clear();
+	detail::mapped_file mapping;
+	if (!detail::map_file_private(path, mapping))
+	{
+		return false;
+	}
+	if (!detail::check_snapshot_header<storage_type, storage_type>(mapping, snapshot_kind::map))
+	{
+		detail::unmap_file(mapping.mBase, mapping.mLength);
+		return false;
+	}
+	return detail::snapshot_access::load(container, mapping);
+}
+
+}
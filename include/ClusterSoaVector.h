@@ -0,0 +1,794 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	cluster_soa_vector, a structure of arrays sibling of cluster_vector.
+//
+//	The fields are given as a std::tuple. Each cluster is a single allocation
+//	holding its header followed by one contiguous column per field, so a loop
+//	that reads one field only pulls that field through the cache. Clusters
+//	are sized by the same growth policies as cluster_vector, and elements
+//	never move once pushed.
+//
+//	Example usage:
+//	    sw::cluster_soa_vector<std::tuple<Vec3, Vec3, float>, Allocator> particles;
+//	    particles.push_back(position, velocity, 1.0f);
+//	    for (auto segment : particles.segments())
+//	    {
+//	        auto positions = segment.column<0>();
+//	        auto velocities = segment.column<1>();
+//	        for (size_t i = 0; i < segment.size(); ++i)
+//	            positions[i] += velocities[i] * dt;
+//	    }
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include "ClusterVector.h"
+
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sw
+{
+
+namespace detail
+{
+	template <typename Fields>
+	struct soa_fields;
+
+	template <typename... Ts>
+	struct soa_fields<std::tuple<Ts...>>
+	{
+		static_assert(sizeof...(Ts) > 0u, "cluster_soa_vector needs at least one field");
+
+		using reference			= std::tuple<Ts&...>;
+		using const_reference	= std::tuple<Ts const &...>;
+
+		static constexpr size_t max_alignment()
+		{
+			size_t const alignments[] = { alignof(Ts)... };
+			size_t result = 1u;
+			for (size_t alignment : alignments)
+			{
+				result = alignment > result ? alignment : result;
+			}
+			return result;
+		}
+
+		//Total size of one element across every column
+		static constexpr size_t row_size()
+		{
+			size_t const sizes[] = { sizeof(Ts)... };
+			size_t result = 0u;
+			for (size_t size : sizes)
+			{
+				result += size;
+			}
+			return result;
+		}
+
+		//Byte offset of each column from the start of a cluster holding capacity elements, returns the allocation size
+		static size_t column_offsets(size_t headerSize, size_t capacity, size_t (&offsets)[sizeof...(Ts)])
+		{
+			size_t const sizes[] = { sizeof(Ts)... };
+			size_t const alignments[] = { alignof(Ts)... };
+			size_t offset = headerSize;
+			for (size_t i = 0; i < sizeof...(Ts); ++i)
+			{
+				offset = (offset + alignments[i] - 1u) & ~(alignments[i] - 1u);
+				offsets[i] = offset;
+				offset += sizes[i] * capacity;
+			}
+			return offset;
+		}
+	};
+}
+
+template<typename Fields>
+class soa_cluster
+{
+public:
+	using size_type			= size_t;
+	using this_type			= soa_cluster<Fields>;
+
+	template <size_t I>
+	using column_type		= typename std::tuple_element<I, Fields>::type;
+
+	static constexpr size_t	kColumnCount = std::tuple_size<Fields>::value;
+
+	const this_type*		next_cluster() const { return mNext; }
+	this_type*				next_cluster() { return mNext; }
+
+	template <size_t I>
+	const column_type<I>*	column() const { return static_cast<const column_type<I>*>(mColumns[I]); }
+	template <size_t I>
+	column_type<I>*			column() { return static_cast<column_type<I>*>(mColumns[I]); }
+
+	size_type				capacity() const { return mCapacity; }
+	size_type				size() const { return mSize; }
+
+	static size_type		allocation_size(size_type capacity)
+	{
+		size_t offsets[kColumnCount];
+		return detail::soa_fields<Fields>::column_offsets(sizeof(this_type), capacity, offsets);
+	}
+
+	this_type*				mPrev;
+	this_type*				mNext;
+	size_type				mSize;
+	size_type				mCapacity;
+	//Index of this cluster's first element within the whole container
+	size_type				mStartIndex;
+	//Each column is allocated inline following this object, in field order
+	void*					mColumns[kColumnCount];
+};
+
+// cluster_column
+//
+// One field of one cluster's elements, contiguous in memory.
+//
+template <typename T>
+struct cluster_column
+{
+public:
+	using iterator			= T*;
+
+	T*						begin() const { return mBegin; }
+	T*						end() const { return mEnd; }
+	size_t					size() const { return static_cast<size_t>(mEnd - mBegin); }
+	bool					empty() const { return mBegin == mEnd; }
+	T&						operator[](size_t index) const { return mBegin[index]; }
+
+	T*						mBegin;
+	T*						mEnd;
+};
+
+// cluster_soa_segment
+//
+// The elements of one cluster, as a cluster_column per field.
+//
+template <typename Cluster>
+struct cluster_soa_segment
+{
+public:
+	using cluster_type		= typename std::remove_const<Cluster>::type;
+
+	template <size_t I>
+	using column_type		= typename std::conditional<std::is_const<Cluster>::value,
+								const typename cluster_type::template column_type<I>,
+								typename cluster_type::template column_type<I>>::type;
+
+	template <size_t I>
+	cluster_column<column_type<I>>	column() const
+	{
+		column_type<I>* first = mCluster->template column<I>();
+		return cluster_column<column_type<I>>{ first, first + mCluster->mSize };
+	}
+
+	size_t					size() const { return mCluster->mSize; }
+	bool					empty() const { return mCluster->mSize == 0u; }
+	//Container index of the segment's first element
+	size_t					start_index() const { return mCluster->mStartIndex; }
+
+	Cluster*				mCluster;
+};
+
+template <typename Cluster>
+struct cluster_soa_segment_iterator
+{
+public:
+	using this_type			= cluster_soa_segment_iterator<Cluster>;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= cluster_soa_segment<Cluster>;
+	using difference_type	= ptrdiff_t;
+	using pointer			= const value_type*;
+	using reference			= value_type;
+
+	value_type				operator*() const { return value_type{ mCluster }; }
+
+	this_type&				operator++() { mCluster = mCluster->mNext; return *this; }
+	this_type				operator++(int) { this_type i(*this); mCluster = mCluster->mNext; return i; }
+
+	bool					operator==(this_type const & other) const { return mCluster == other.mCluster; }
+	bool					operator!=(this_type const & other) const { return mCluster != other.mCluster; }
+
+	Cluster*				mCluster;
+};
+
+template <typename Fields, typename Allocator, size_t tStepSize = 2u, typename GrowthPolicy = geometric_growth<tStepSize>>
+class cluster_soa_vector
+{
+public:
+	using size_type				= size_t;
+	using this_type				= cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>;
+	using cluster_type			= soa_cluster<Fields>;
+	using allocator_type		= Allocator;
+	using growth_policy_type	= GrowthPolicy;
+	using reference				= typename detail::soa_fields<Fields>::reference;
+	using const_reference		= typename detail::soa_fields<Fields>::const_reference;
+	using segment_range			= cluster_segment_range<cluster_soa_segment_iterator<cluster_type>>;
+	using const_segment_range	= cluster_segment_range<cluster_soa_segment_iterator<const cluster_type>>;
+
+	template <size_t I>
+	using column_type			= typename cluster_type::template column_type<I>;
+
+	static constexpr size_t		kColumnCount = cluster_type::kColumnCount;
+
+	cluster_soa_vector(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
+	cluster_soa_vector() : cluster_soa_vector(64u) {}
+	~cluster_soa_vector();
+
+	cluster_soa_vector(cluster_soa_vector && other);
+	cluster_soa_vector& operator=(cluster_soa_vector && other);
+
+	cluster_soa_vector(cluster_soa_vector const &) = delete;
+	cluster_soa_vector& operator=(cluster_soa_vector const &) = delete;
+
+	allocator_type&			get_allocator() { return mAllocator; }
+
+	//Each cluster's columns, see cluster_soa_segment
+	const_segment_range		segments() const;
+	segment_range			segments();
+
+	size_type				size() const;
+	size_type				capacity() const;
+	size_type				cluster_count() const { return mClusterCount; }
+	bool					empty() const { return mLastcluster == nullptr; }
+	void					clear();
+	//Pre-allocates clusters so that growing to count elements never allocates, they stay allocated until the container is destroyed
+	void					reserve(size_type count);
+
+	//A tuple of references to every field of the element
+	const_reference			operator[](size_type index) const;
+	reference				operator[](size_type index);
+	const_reference			at(size_type index) const;
+	reference				at(size_type index);
+
+	//A single field of the element
+	template <size_t I>
+	const column_type<I>&	get(size_type index) const;
+	template <size_t I>
+	column_type<I>&			get(size_type index);
+
+	//Constructs each column from the matching argument, or value initialises every column when given none
+	template <typename... Args>
+	reference				push_back(Args&&... values);
+
+	//Adds an element without constructing any column, the caller constructs each field in place through the returned references
+	reference				push_back_uninitialized();
+
+	void					pop_back();
+
+	//Relocates the last element into index, then pops the back
+	void					erase_unsorted(size_type index);
+
+	void					swap(this_type& other);
+
+protected:
+	using column_sequence	= std::make_index_sequence<kColumnCount>;
+
+	cluster_type*			DoAllocCluster(size_type clusterIndex, size_type capacity);
+	void					DoFreeSpareClusters(size_type keepCount);
+	void					DoTrimSpareClusters();
+	cluster_type*			DoAppendCluster();
+	void					DoPopCluster();
+	cluster_type*			DoPushBack();
+
+	template <size_t... Is, typename... Args>
+	static void				DoConstruct(cluster_type* cluster, size_type offset, std::index_sequence<Is...>, std::false_type, Args&&... values);
+	template <size_t... Is>
+	static void				DoConstruct(cluster_type* cluster, size_type offset, std::index_sequence<Is...>, std::true_type);
+	template <size_t... Is>
+	static void				DoDestroy(cluster_type* cluster, size_type first, size_type last, std::index_sequence<Is...>);
+	template <size_t... Is>
+	static void				DoRelocate(cluster_type* destination, size_type destinationOffset, cluster_type* source, size_type sourceOffset, std::index_sequence<Is...>);
+	template <size_t... Is>
+	static reference		DoReference(cluster_type* cluster, size_type offset, std::index_sequence<Is...>);
+
+	cluster_type*			DoLocate(size_type index, size_type& offset) const;
+	size_type				DoLocateClusterIndex(size_type index, std::true_type) const;
+	size_type				DoLocateClusterIndex(size_type index, std::false_type) const;
+	size_type				DoClusterCapacity(size_type clusterIndex) const;
+	void					DoGrowDirectory(size_type minCapacity);
+
+	allocator_type			mAllocator;
+	cluster_type*			mFirstcluster;
+	cluster_type*			mLastcluster;
+	size_type				mClusterCount;
+	size_type				mInitialClusterCapacity;
+	cluster_type**			mClusterDirectory;		//Every cluster in chain order. Entries past mClusterCount are allocated but unused.
+	size_type				mDirectoryCapacity;
+	size_type				mAllocatedClusterCount;	//In use plus at most one spare, so pushing and popping across a cluster boundary does not allocate and free each time
+	size_type				mReservedClusterCount;	//Clusters that reserve() asked to keep allocated
+};
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::cluster_soa_vector(size_type initialClusterCapacity, const Allocator& allocator)
+	:	mAllocator(allocator)
+	,	mFirstcluster(nullptr)
+	,	mLastcluster(nullptr)
+	,	mClusterCount(0)
+	,	mInitialClusterCapacity(initialClusterCapacity)
+	,	mClusterDirectory(nullptr)
+	,	mDirectoryCapacity(0)
+	,	mAllocatedClusterCount(0)
+	,	mReservedClusterCount(0)
+{
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::cluster_soa_vector(cluster_soa_vector && other)
+	:	mAllocator(other.mAllocator)
+	,	mFirstcluster(other.mFirstcluster)
+	,	mLastcluster(other.mLastcluster)
+	,	mClusterCount(other.mClusterCount)
+	,	mInitialClusterCapacity(other.mInitialClusterCapacity)
+	,	mClusterDirectory(other.mClusterDirectory)
+	,	mDirectoryCapacity(other.mDirectoryCapacity)
+	,	mAllocatedClusterCount(other.mAllocatedClusterCount)
+	,	mReservedClusterCount(other.mReservedClusterCount)
+{
+	other.mFirstcluster = nullptr;
+	other.mLastcluster = nullptr;
+	other.mClusterCount = 0;
+	other.mClusterDirectory = nullptr;
+	other.mDirectoryCapacity = 0;
+	other.mAllocatedClusterCount = 0;
+	other.mReservedClusterCount = 0;
+}
+
+//Takes other's clusters and releases this vector's own, leaving other empty
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>&
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::operator=(cluster_soa_vector && other)
+{
+	if (this != &other)
+	{
+		cluster_soa_vector(std::move(other)).swap(*this);
+	}
+	return *this;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::~cluster_soa_vector()
+{
+	clear();
+	DoFreeSpareClusters(0u);
+	if (mClusterDirectory)
+	{
+		CLUSTERFree(mAllocator, mClusterDirectory, mDirectoryCapacity * sizeof(cluster_type*));
+	}
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::const_segment_range
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::segments() const
+{
+	const_segment_range range{};
+	range.mBegin.mCluster = mFirstcluster;
+	return range;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::segment_range
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::segments()
+{
+	segment_range range{};
+	range.mBegin.mCluster = mFirstcluster;
+	return range;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::size() const
+{
+	return mLastcluster ? mLastcluster->mStartIndex + mLastcluster->mSize : 0u;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::capacity() const
+{
+	if (!mAllocatedClusterCount)
+	{
+		return 0u;
+	}
+	cluster_type* lastAllocated = mClusterDirectory[mAllocatedClusterCount - 1u];
+	return lastAllocated->mStartIndex + lastAllocated->mCapacity;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::clear()
+{
+	for (cluster_type* cluster = mFirstcluster; cluster; cluster = cluster->mNext)
+	{
+		DoDestroy(cluster, 0u, cluster->mSize, column_sequence());
+	}
+	mFirstcluster = nullptr;
+	mLastcluster = nullptr;
+	mClusterCount = 0;
+	DoTrimSpareClusters();
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::reserve(size_type count)
+{
+	while (capacity() < count)
+	{
+		DoAllocCluster(mAllocatedClusterCount, DoClusterCapacity(mAllocatedClusterCount));
+	}
+
+	if (mReservedClusterCount < mAllocatedClusterCount)
+	{
+		mReservedClusterCount = mAllocatedClusterCount;
+	}
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::const_reference
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::operator[](size_type index) const
+{
+	size_type offset;
+	cluster_type* cluster = DoLocate(index, offset);
+	return DoReference(cluster, offset, column_sequence());
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::reference
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::operator[](size_type index)
+{
+	size_type offset;
+	cluster_type* cluster = DoLocate(index, offset);
+	return DoReference(cluster, offset, column_sequence());
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::const_reference
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::at(size_type index) const
+{
+#if CLUSTER_EXCEPTIONS_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		throw std::out_of_range("cluster_soa_vector::at -- out of range");
+#elif CLUSTER_ASSERT_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		CLUSTER_ASSERT("cluster_soa_vector::at -- out of range");
+#endif
+	return operator[](index);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::reference
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::at(size_type index)
+{
+#if CLUSTER_EXCEPTIONS_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		throw std::out_of_range("cluster_soa_vector::at -- out of range");
+#elif CLUSTER_ASSERT_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		CLUSTER_ASSERT("cluster_soa_vector::at -- out of range");
+#endif
+	return operator[](index);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <size_t I>
+inline const typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::template column_type<I>&
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::get(size_type index) const
+{
+	size_type offset;
+	cluster_type* cluster = DoLocate(index, offset);
+	return cluster->template column<I>()[offset];
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <size_t I>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::template column_type<I>&
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::get(size_type index)
+{
+	size_type offset;
+	cluster_type* cluster = DoLocate(index, offset);
+	return cluster->template column<I>()[offset];
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename... Args>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::reference
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::push_back(Args&&... values)
+{
+	static_assert(sizeof...(Args) == 0u || sizeof...(Args) == kColumnCount, "cluster_soa_vector::push_back takes one value per field, or none");
+	cluster_type* cluster = DoPushBack();
+	size_type offset = cluster->mSize - 1u;
+	DoConstruct(cluster, offset, column_sequence(), std::integral_constant<bool, sizeof...(Args) == 0u>(), std::forward<Args>(values)...);
+	return DoReference(cluster, offset, column_sequence());
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::reference
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::push_back_uninitialized()
+{
+	cluster_type* cluster = DoPushBack();
+	return DoReference(cluster, cluster->mSize - 1u, column_sequence());
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::pop_back()
+{
+	cluster_type* lastcluster = mLastcluster;
+#if CLUSTER_ASSERT_ENABLED
+	if(CLUSTER_UNLIKELY(!lastcluster))
+		CLUSTER_ASSERT("cluster_soa_vector::pop_back -- container is empty");
+#endif
+	--lastcluster->mSize;
+	DoDestroy(lastcluster, lastcluster->mSize, lastcluster->mSize + 1u, column_sequence());
+
+	if (!lastcluster->mSize)
+	{
+		DoPopCluster();
+	}
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::erase_unsorted(size_type index)
+{
+	size_type offset;
+	cluster_type* cluster = DoLocate(index, offset);
+	cluster_type* lastcluster = mLastcluster;
+	size_type lastOffset = lastcluster->mSize - 1u;
+	DoDestroy(cluster, offset, offset + 1u, column_sequence());
+	if (cluster != lastcluster || offset != lastOffset)
+	{
+		DoRelocate(cluster, offset, lastcluster, lastOffset, column_sequence());
+	}
+
+	if (!--lastcluster->mSize)
+	{
+		DoPopCluster();
+	}
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::swap(this_type& other)
+{
+	std::swap(mAllocator, other.mAllocator);
+	std::swap(mFirstcluster, other.mFirstcluster);
+	std::swap(mLastcluster, other.mLastcluster);
+	std::swap(mClusterCount, other.mClusterCount);
+	std::swap(mInitialClusterCapacity, other.mInitialClusterCapacity);
+	std::swap(mClusterDirectory, other.mClusterDirectory);
+	std::swap(mDirectoryCapacity, other.mDirectoryCapacity);
+	std::swap(mAllocatedClusterCount, other.mAllocatedClusterCount);
+	std::swap(mReservedClusterCount, other.mReservedClusterCount);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoAllocCluster(size_type clusterIndex, size_type capacity)
+{
+	if (clusterIndex >= mDirectoryCapacity)
+	{
+		DoGrowDirectory(clusterIndex + 1u);
+	}
+
+	size_t offsets[kColumnCount];
+	size_t allocationSize = detail::soa_fields<Fields>::column_offsets(sizeof(cluster_type), capacity, offsets);
+	size_t alignment = detail::soa_fields<Fields>::max_alignment();
+	alignment = alignment > CLUSTER_ALIGN_OF(cluster_type) ? alignment : CLUSTER_ALIGN_OF(cluster_type);
+	cluster_type* cluster = (cluster_type*)sw_allocate_memory(mAllocator, allocationSize, alignment, 0);
+	for (size_t i = 0; i < kColumnCount; ++i)
+	{
+		cluster->mColumns[i] = reinterpret_cast<char*>(cluster) + offsets[i];
+	}
+	cluster->mCapacity = capacity;
+	if (clusterIndex)
+	{
+		cluster_type* prevcluster = mClusterDirectory[clusterIndex - 1u];
+		cluster->mStartIndex = prevcluster->mStartIndex + prevcluster->mCapacity;
+	}
+	else
+	{
+		cluster->mStartIndex = 0u;
+	}
+	mClusterDirectory[clusterIndex] = cluster;
+	mAllocatedClusterCount = clusterIndex + 1u;
+	return cluster;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoFreeSpareClusters(size_type keepCount)
+{
+	if (keepCount < mClusterCount)
+	{
+		keepCount = mClusterCount;
+	}
+
+	while (mAllocatedClusterCount > keepCount)
+	{
+		cluster_type* cluster = mClusterDirectory[--mAllocatedClusterCount];
+		CLUSTERFree(mAllocator, cluster, cluster_type::allocation_size(cluster->mCapacity));
+	}
+}
+
+//Keeps one spare past the clusters in use, or every reserved cluster
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoTrimSpareClusters()
+{
+	size_type keepCount = mClusterCount + 1u;
+	DoFreeSpareClusters(keepCount < mReservedClusterCount ? mReservedClusterCount : keepCount);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoAppendCluster()
+{
+	cluster_type* lastcluster = mLastcluster;
+	size_type clusterIndex = mClusterCount++;
+	cluster_type* newcluster = clusterIndex < mAllocatedClusterCount ? mClusterDirectory[clusterIndex] : DoAllocCluster(clusterIndex, DoClusterCapacity(clusterIndex));
+	newcluster->mPrev = lastcluster;
+	newcluster->mNext = nullptr;
+	newcluster->mSize = 0;
+	if (lastcluster)
+	{
+		lastcluster->mNext = newcluster;
+	}
+	else
+	{
+		mFirstcluster = newcluster;
+	}
+	mLastcluster = newcluster;
+	return newcluster;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoPopCluster()
+{
+	--mClusterCount;
+	mLastcluster = mLastcluster->mPrev;
+	if (mLastcluster)
+	{
+		mLastcluster->mNext = nullptr;
+	}
+	else
+	{
+		mFirstcluster = nullptr;
+	}
+	DoTrimSpareClusters();
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoPushBack()
+{
+	cluster_type* cluster = mLastcluster;
+	if (!cluster || cluster->mSize == cluster->mCapacity)
+	{
+		cluster = DoAppendCluster();
+	}
+	++cluster->mSize;
+	return cluster;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <size_t... Is, typename... Args>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoConstruct(cluster_type* cluster, size_type offset, std::index_sequence<Is...>, std::false_type, Args&&... values)
+{
+	int expand[] = { (new (cluster->template column<Is>() + offset) column_type<Is>(std::forward<Args>(values)), 0)... };
+	CLUSTER_UNUSED(expand);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <size_t... Is>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoConstruct(cluster_type* cluster, size_type offset, std::index_sequence<Is...>, std::true_type)
+{
+	int expand[] = { (new (cluster->template column<Is>() + offset) column_type<Is>(), 0)... };
+	CLUSTER_UNUSED(expand);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <size_t... Is>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoDestroy(cluster_type* cluster, size_type first, size_type last, std::index_sequence<Is...>)
+{
+	int expand[] = { (detail::destroy_run(cluster->template column<Is>() + first, cluster->template column<Is>() + last), 0)... };
+	CLUSTER_UNUSED(expand);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <size_t... Is>
+inline void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoRelocate(cluster_type* destination, size_type destinationOffset, cluster_type* source, size_type sourceOffset, std::index_sequence<Is...>)
+{
+	int expand[] = { (detail::relocate(destination->template column<Is>() + destinationOffset, source->template column<Is>() + sourceOffset), 0)... };
+	CLUSTER_UNUSED(expand);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <size_t... Is>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::reference
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoReference(cluster_type* cluster, size_type offset, std::index_sequence<Is...>)
+{
+	return reference(cluster->template column<Is>()[offset]...);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoLocate(size_type index, size_type& offset) const
+{
+	cluster_type* cluster = mClusterDirectory[DoLocateClusterIndex(index, std::integral_constant<bool, GrowthPolicy::kHasClusterIndex>())];
+	offset = index - cluster->mStartIndex;
+	return cluster;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoLocateClusterIndex(size_type index, std::true_type) const
+{
+	return GrowthPolicy::cluster_index(mInitialClusterCapacity, index);
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoLocateClusterIndex(size_type index, std::false_type) const
+{
+	//Binary search the directory for the last cluster starting at or before the index
+	size_type low = 0u;
+	size_type high = mClusterCount - 1u;
+	while (low < high)
+	{
+		size_type mid = (low + high + 1u) / 2u;
+		if (mClusterDirectory[mid]->mStartIndex <= index)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1u;
+		}
+	}
+	return low;
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoClusterCapacity(size_type clusterIndex) const
+{
+	//Alignment padding between columns is not counted, so page_rounded_growth can spill a few bytes past its page
+	return GrowthPolicy::cluster_capacity(mInitialClusterCapacity, clusterIndex, detail::soa_fields<Fields>::row_size(), sizeof(cluster_type));
+}
+
+template <typename Fields, typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_soa_vector<Fields, Allocator, tStepSize, GrowthPolicy>::DoGrowDirectory(size_type minCapacity)
+{
+	size_type newCapacity = mDirectoryCapacity ? mDirectoryCapacity * 2u : 8u;
+	while (newCapacity < minCapacity)
+	{
+		newCapacity *= 2u;
+	}
+
+	cluster_type** newDirectory = (cluster_type**)sw_allocate_memory(mAllocator, newCapacity * sizeof(cluster_type*), CLUSTER_ALIGN_OF(cluster_type*), 0);
+	if (mClusterDirectory)
+	{
+		for (size_type i = 0; i < mDirectoryCapacity; ++i)
+		{
+			newDirectory[i] = mClusterDirectory[i];
+		}
+		CLUSTERFree(mAllocator, mClusterDirectory, mDirectoryCapacity * sizeof(cluster_type*));
+	}
+	mClusterDirectory = newDirectory;
+	mDirectoryCapacity = newCapacity;
+}
+
+}
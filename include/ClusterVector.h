@@ -1,737 +1,2251 @@
-#pragma once
-
-//-----------------------------------------------------------------------------
-//	The contents of this file is modified versions of EASTL source --
-//	https://github.com/electronicarts/EASTL
-//-----------------------------------------------------------------------------
-//	BSD 3-Clause License
-//	
-//	Copyright (c) 2019, Electronic Arts
-//	All rights reserved.
-//	
-//	Redistribution and use in source and binary forms, with or without
-//	modification, are permitted provided that the following conditions are met:
-//	
-//	1. Redistributions of source code must retain the above copyright notice, this
-//	list of conditions and the following disclaimer.
-//	
-//	2. Redistributions in binary form must reproduce the above copyright notice,
-//	this list of conditions and the following disclaimer in the documentation
-//	and/or other materials provided with the distribution.
-//	
-//	3. Neither the name of the copyright holder nor the names of its
-//	contributors may be used to endorse or promote products derived from
-//	this software without specific prior written permission.
-//	
-//	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
-//	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
-//	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
-//	DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
-//	FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
-//	DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
-//	SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
-//	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
-//	OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
-//	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-//-----------------------------------------------------------------------------
-
-#include "Common.h"
-
-namespace sw
-{
-
-namespace detail
-{
-
-template<typename T>
-struct cluster_helper
-{
-	static const uintptr_t	kIsLastCluster = 1 << 0;
-	uintptr_t				mPrev;
-
-	union
-	{
-		//If there is not another cluster, then mSize stores how many elements are in this container
-		cluster_helper*		mNext;
-		size_t				mSize;
-	};
-	//Data is allocated inline following this object
-	T*						mDataEnd;
-	T						mDummyData[2];
-};
-
-template<size_t t_base>
-struct pow_table
-{
-	inline static constexpr size_t const_pow(size_t base, size_t exponent)
-	{
-		return exponent == 0u ? 1u : base * const_pow(base, exponent - 1u);
-	}
-
-	static constexpr size_t val[64] =
-	{
-		const_pow(t_base, 0),
-		const_pow(t_base, 1),
-		const_pow(t_base, 2),
-		const_pow(t_base, 3),
-		const_pow(t_base, 4),
-		const_pow(t_base, 5),
-		const_pow(t_base, 6),
-		const_pow(t_base, 7),
-		const_pow(t_base, 8),
-		const_pow(t_base, 9),
-		const_pow(t_base, 10),
-		const_pow(t_base, 11),
-		const_pow(t_base, 12),
-		const_pow(t_base, 13),
-		const_pow(t_base, 14),
-		const_pow(t_base, 15),
-		const_pow(t_base, 16),
-		const_pow(t_base, 17),
-		const_pow(t_base, 18),
-		const_pow(t_base, 19),
-		const_pow(t_base, 20),
-		const_pow(t_base, 21),
-		const_pow(t_base, 22),
-		const_pow(t_base, 23),
-		const_pow(t_base, 24),
-		const_pow(t_base, 25),
-		const_pow(t_base, 26),
-		const_pow(t_base, 27),
-		const_pow(t_base, 28),
-		const_pow(t_base, 29),
-		const_pow(t_base, 30),
-		const_pow(t_base, 31),
-		const_pow(t_base, 32),
-		const_pow(t_base, 33),
-		const_pow(t_base, 34),
-		const_pow(t_base, 35),
-		const_pow(t_base, 36),
-		const_pow(t_base, 37),
-		const_pow(t_base, 38),
-		const_pow(t_base, 39),
-		const_pow(t_base, 40),
-		const_pow(t_base, 41),
-		const_pow(t_base, 42),
-		const_pow(t_base, 43),
-		const_pow(t_base, 44),
-		const_pow(t_base, 45),
-		const_pow(t_base, 46),
-		const_pow(t_base, 47),
-		const_pow(t_base, 48),
-		const_pow(t_base, 49),
-		const_pow(t_base, 50),
-		const_pow(t_base, 51),
-		const_pow(t_base, 52),
-		const_pow(t_base, 53),
-		const_pow(t_base, 54),
-		const_pow(t_base, 55),
-		const_pow(t_base, 56),
-		const_pow(t_base, 57),
-		const_pow(t_base, 58),
-		const_pow(t_base, 59),
-		const_pow(t_base, 60),
-		const_pow(t_base, 61),
-		const_pow(t_base, 62),
-		const_pow(t_base, 63),
-	};
-};
-
-}
-
-template<typename T>
-class cluster
-{
-public:
-	using size_type			= size_t;
-	using this_type			= cluster<T>;
-	using iterator			= T*;
-	using const_iterator	= T const *;
-
-	const this_type*		next_cluster() const;
-	this_type*				next_cluster();
-
-	const_iterator			begin() const;
-	iterator				begin();
-
-	const_iterator			end() const;
-	iterator				end();
-
-	size_type				capacity() const;
-	size_type				size() const;
-
-	static size_type		allocation_size(size_type num_elements);
-	bool					is_last_cluster() const;
-
-	static const uintptr_t	kIsLastCluster = 1 << 0;
-	uintptr_t				mPrev;
-
-	union
-	{
-		//If there is not another cluster, then mSize stores how many elements are in this container
-		this_type*			mNext;
-		size_type			mSize;
-	};
-	//Data is allocated inline following this object
-	T*						mDataEnd;
-	template<typename, typename, size_t> friend class cluster_vector;
-	template<typename> friend struct cluster_vector_iterator;
-};
-
-
-template <typename T>
-struct cluster_vector_iterator
-{
-public:
-	using this_type			= cluster_vector_iterator<T>;
-	using cluster_type		= cluster<T>;
-
-	T*						operator->() const;
-	T&						operator*() const;
-
-	this_type&				operator++();
-	this_type				operator++(int);
-
-public:
-	T*						mCurrent;
-	T*						mEnd;
-	cluster_type*			mCluster;
-};
-
-
-template <typename T, typename Allocator, size_t tStepSize = 2u>
-class cluster_vector
-{
-public:
-	template <typename U, typename OtherAllocator, size_t tOtherStepSize>
-	friend class cluster_map;
-
-	using size_type				= size_t;
-	using this_type				= cluster_vector<T, Allocator, tStepSize>;
-	using cluster_type			= cluster<T>;
-	using cluster_helper_type	= typename detail::cluster_helper<T>;
-	using allocator_type		= Allocator;
-	using iterator				= cluster_vector_iterator<T>;
-	using const_iterator		= cluster_vector_iterator<const T>;
-
-	using value_type			= T;
-
-	cluster_vector(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
-	cluster_vector() : cluster_vector(64u) {}
-	~cluster_vector();
-
-	cluster_vector(cluster_vector &&) = default;
-	cluster_vector& operator=(cluster_vector &&) = default;
-
-	cluster_vector(cluster_vector const &) = delete;
-	cluster_vector& operator=(cluster_vector const &) = delete;
-
-	allocator_type&			get_allocator();
-
-	const cluster_type*		first_cluster() const;
-	cluster_type*			first_cluster();
-	const_iterator			begin() const;
-	iterator				begin();
-
-	const_iterator			end() const;
-	iterator				end();
-
-	size_type				size() const;
-	size_type				cluster_count() const;
-	T&						front();
-	T&						back();
-
-	bool					empty() const;
-	void					clear();
-
-	iterator				push_back();
-	iterator				push_back(const T& value);
-	iterator				push_back_uninitialized();
-
-	void					pop_back();
-
-	void					erase_unsorted(cluster_type& cluster, typename cluster_type::iterator it);
-	iterator				erase_unsorted(const iterator& i);
-
-	void					swap(this_type& other);
-
-protected:
-	cluster_type*			DoAlloccluster(cluster_type* prevcluster, size_t numElements);
-	iterator				DoPushBack();
-
-	allocator_type			mAllocator;
-	cluster_type*			mFirstcluster;
-	cluster_type*			mLastcluster;
-	size_type				mClusterCount;
-	size_type const			mInitialClusterCapacity;
-};
-
-
-template<typename T>
-inline const cluster<T>*
-cluster<T>::next_cluster() const
-{
-	if (mPrev & kIsLastCluster)
-	{
-		return nullptr;
-	}
-	else
-	{
-		return mNext;
-	}
-}
-
-template<typename T>
-inline cluster<T>*
-cluster<T>::next_cluster()
-{
-	if (mPrev & kIsLastCluster)
-	{
-		return nullptr;
-	}
-	else
-	{
-		return mNext;
-	}
-}
-
-template<typename T>
-inline typename cluster<T>::const_iterator
-cluster<T>::begin() const
-{
-	char const * dataOffset = reinterpret_cast<char const *>(this) + CLUSTER_OFFSETOF(detail::cluster_helper<T>, mDummyData);
-	return (cluster<T>::iterator)(dataOffset);
-}
-
-template<typename T>
-inline typename cluster<T>::iterator
-cluster<T>::begin()
-{
-	char* dataOffset = reinterpret_cast<char*>(this) + CLUSTER_OFFSETOF(detail::cluster_helper<T>, mDummyData);
-	return (cluster<T>::iterator)(dataOffset);
-}
-
-template<typename T>
-inline typename cluster<T>::const_iterator
-cluster<T>::end() const
-{
-	if (mPrev & this_type::kIsLastCluster)
-	{
-		return begin() + mSize;
-	}
-	else
-	{
-		return mDataEnd;
-	}
-}
-
-template<typename T>
-inline typename cluster<T>::iterator
-cluster<T>::end()
-{
-	if (mPrev & kIsLastCluster)
-	{
-		return begin() + mSize;
-	}
-	else
-	{
-		return mDataEnd;
-	}
-}
-
-template<typename T>
-inline typename cluster<T>::size_type 
-cluster<T>::capacity() const
-{
-	return mDataEnd - begin();
-}
-
-template<typename T>
-inline typename cluster<T>::size_type
-cluster<T>::size() const
-{
-	if (mPrev & this_type::kIsLastCluster)
-	{
-		return mSize;
-	}
-	else
-	{
-		return capacity();
-	}
-}
-
-template<typename T>
-inline typename cluster<T>::size_type 
-cluster<T>::allocation_size(size_type num_elements)
-{
-	return sizeof(detail::cluster_helper<T>) + (sizeof(T) * num_elements) - (sizeof(T) * 2u);
-}
-
-template<typename T>
-inline bool cluster<T>::is_last_cluster() const
-{
-	return mPrev & this_type::kIsLastCluster;
-}
-
-template<typename T>
-T*
-cluster_vector_iterator<T>::operator->() const
-{
-	return mCurrent;
-}
-
-template<typename T>
-T&
-cluster_vector_iterator<T>::operator*() const
-{
-	return *mCurrent;
-}
-
-template<typename T>
-cluster_vector_iterator<T>&
-cluster_vector_iterator<T>::operator++()
-{
-	++mCurrent;
-	if(CLUSTER_UNLIKELY(mCurrent == mEnd))
-	{
-		if (!(mCluster->mPrev & cluster_type::kIsLastCluster))
-		{
-			mCluster = mCluster->mNext;
-			mCurrent = mCluster->begin();
-			mEnd = mCluster->end();
-		}
-		else
-		{
-			mCurrent = 0;
-		}
-	}
-	return *this;
-}
-
-template<typename T>
-cluster_vector_iterator<T>
-cluster_vector_iterator<T>::operator++(int)
-{
-	this_type i(*this);
-	operator++();
-	return i;
-}
-
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline cluster_vector<T, Allocator, tStepSize>::cluster_vector(size_type initialClusterCapacity, const Allocator& allocator)
-	:	mAllocator(allocator)
-	,	mFirstcluster(nullptr)
-	,	mLastcluster(nullptr)
-	,	mClusterCount(0)
-	,	mInitialClusterCapacity(initialClusterCapacity)
-{
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline cluster_vector<T, Allocator, tStepSize>::~cluster_vector()
-{
-	clear();
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::allocator_type&
-cluster_vector<T, Allocator, tStepSize>::get_allocator()
-{
-	return mAllocator;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline const typename cluster_vector<T, Allocator, tStepSize>::cluster_type*
-cluster_vector<T, Allocator, tStepSize>::first_cluster() const
-{
-	return mFirstcluster;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::cluster_type*
-cluster_vector<T, Allocator, tStepSize>::first_cluster()
-{
-	return mFirstcluster;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::const_iterator
-cluster_vector<T, Allocator, tStepSize>::begin() const
-{
-	iterator i;
-	i.mCluster = mFirstcluster;
-	if (mFirstcluster)
-	{
-		i.mCurrent = mFirstcluster->begin();
-		i.mEnd = mFirstcluster->end();
-	}
-	else
-	{
-		i.mCurrent = 0;
-	}
-	return (const_iterator&)i;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::iterator
-cluster_vector<T, Allocator, tStepSize>::begin()
-{
-	iterator i;
-	i.mCluster = mFirstcluster;
-	if (mFirstcluster)
-	{
-		i.mCurrent = mFirstcluster->begin();
-		i.mEnd = mFirstcluster->end();
-	}
-	else
-	{
-		i.mCurrent = 0;
-	}
-	return i;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::const_iterator
-cluster_vector<T, Allocator, tStepSize>::end() const
-{
-	iterator i;
-	i.mCurrent = 0;
-	return (const_iterator&)i;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::iterator
-cluster_vector<T, Allocator, tStepSize>::end()
-{
-	iterator i;
-	i.mCurrent = 0;
-	return i;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::size_type
-cluster_vector<T, Allocator, tStepSize>::size() const
-{
-	if (cluster_type* cluster = mLastcluster)
-	{
-		//Geometric Series formula: Sn = a1(1-r^n) / (1-r)
-		size_t series_sum = detail::pow_table<tStepSize>::val[mClusterCount - 1u];
-		size_t numerator = (mInitialClusterCapacity * (series_sum - 1));
-		size_t denominator = (tStepSize - 1);
-		size_t result = (numerator / denominator) + cluster->mSize;
-		return result;
-	}
-	return 0;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::size_type
-cluster_vector<T, Allocator, tStepSize>::cluster_count() const
-{
-	return mClusterCount;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline T&
-cluster_vector<T, Allocator, tStepSize>::front()
-{
-	return *mFirstcluster->begin();
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline T&
-cluster_vector<T, Allocator, tStepSize>::back()
-{
-	cluster_type* lastcluster = mLastcluster;
-	return *(lastcluster->end() - 1u);
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline bool
-cluster_vector<T, Allocator, tStepSize>::empty() const
-{
-	return mFirstcluster == 0;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline void
-cluster_vector<T, Allocator, tStepSize>::clear()
-{
-	if (cluster_type* clust = mFirstcluster)
-	{
-		while (clust != mLastcluster)
-		{
-			cluster_type* nextcluster = clust->mNext;
-			clust->~cluster_type();
-			CLUSTERFree(mAllocator, clust, cluster_type::allocation_size(clust->capacity()));
-			clust = nextcluster;
-		}
-		for (T* i = clust->begin(), *e = clust->begin() + clust->mSize; i!=e; ++i)
-		{
-			i->~T();
-		}
-		CLUSTERFree(mAllocator, clust, cluster_type::allocation_size(clust->capacity()));
-		mFirstcluster = 0;
-		mLastcluster = 0;
-		mClusterCount = 0;
-	}
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::iterator
-cluster_vector<T, Allocator, tStepSize>::push_back()
-{
-	iterator itr = DoPushBack();
-	new (itr.mCurrent) T();
-	return itr;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::iterator
-cluster_vector<T, Allocator, tStepSize>::push_back(const T& value)
-{
-	iterator itr = DoPushBack();
-	new (itr.mCurrent) T(value);
-	return itr;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::iterator
-cluster_vector<T, Allocator, tStepSize>::push_back_uninitialized()
-{
-	return DoPushBack();
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline void
-cluster_vector<T, Allocator, tStepSize>::pop_back()
-{
-	cluster_type* lastcluster = mLastcluster;
-#if CLUSTER_ASSERT_ENABLED
-	if(CLUSTER_UNLIKELY(!lastcluster))
-		CLUSTER_ASSERT("cluster_vector::pop_back -- clustered vector is empty");
-#endif
-	--lastcluster->mSize;
-	(lastcluster->begin() + lastcluster->mSize)->T::~T();
-
-	if (!lastcluster->mSize)
-	{
-		--mClusterCount;
-		mLastcluster = (cluster_type*)(lastcluster->mPrev & (~cluster_type::kIsLastCluster));
-		CLUSTERFree(mAllocator, lastcluster, cluster_type::allocation_size(lastcluster->capacity()));
-		if (mLastcluster)
-		{
-			mLastcluster->mPrev |= cluster_type::kIsLastCluster;
-			mLastcluster->mSize = mLastcluster->capacity();
-		}
-		else
-		{
-			mFirstcluster = 0;
-		}
-	}
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline void
-cluster_vector<T, Allocator, tStepSize>::erase_unsorted(cluster_type& cluster, typename cluster_type::iterator it)
-{
-	EA_UNUSED(cluster);
-
-	*it = back();
-	pop_back();
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::iterator
-cluster_vector<T, Allocator, tStepSize>::erase_unsorted(const iterator& i)
-{
-	iterator ret(i);
-	*i = back();
-	if (i.mCluster == mLastcluster && mLastcluster->mSize == 1)
-		ret.mCurrent = 0;
-	pop_back();
-	return ret;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-void
-cluster_vector<T, Allocator, tStepSize>::swap(this_type& other)
-{
-	allocator_type tempAllocator(mAllocator);
-	cluster_type* tempFirstcluster = mFirstcluster;
-	cluster_type* tempLastcluster = mLastcluster;
-	size_type tempclusterCount = mClusterCount;
-
-	mAllocator = other.mAllocator;
-	mFirstcluster = other.mFirstcluster;
-	mLastcluster = other.mLastcluster;
-	mClusterCount = other.mClusterCount;
-
-	other.mAllocator = tempAllocator;
-	other.mFirstcluster = tempFirstcluster;
-	other.mLastcluster = tempLastcluster;
-	other.mClusterCount = tempclusterCount;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-cluster<T>*
-cluster_vector<T, Allocator, tStepSize>::DoAlloccluster(cluster_type* prevcluster, size_t numElements)
-{
-	++mClusterCount;
-
-	size_t allocationSize = cluster_type::allocation_size(numElements);
-	cluster_type* cluster = (cluster_type*)sw_allocate_memory(mAllocator, allocationSize, CLUSTER_ALIGN_OF(cluster_helper_type), 0);
-	cluster->mPrev = uintptr_t(prevcluster) | cluster_type::kIsLastCluster;
-	cluster->mSize = 1;
-	cluster->mDataEnd = (T*)((char*)cluster + allocationSize);
-	return cluster;
-}
-
-template <typename T,  typename Allocator, size_t tStepSize>
-inline typename cluster_vector<T, Allocator, tStepSize>::iterator
-cluster_vector<T, Allocator, tStepSize>::DoPushBack()
-{
-	iterator itr{};
-	if (cluster_type* cluster = mLastcluster)
-	{
-		size_type size = cluster->mSize;
-		if (size < cluster->capacity())
-		{
-			++cluster->mSize;
-		}
-		else
-		{
-			cluster_type* lastcluster = mLastcluster;
-			cluster_type* newcluster = mLastcluster = DoAlloccluster(mLastcluster, lastcluster->capacity() * 2u);
-			lastcluster->mPrev &= ~cluster_type::kIsLastCluster;
-			lastcluster->mNext = newcluster;
-		}
-	}
-	else
-	{
-		cluster = mFirstcluster = mLastcluster = DoAlloccluster(0, mInitialClusterCapacity);
-	}
-
-	itr.mCurrent = mLastcluster->begin() + mLastcluster->mSize - 1u;
-	itr.mCluster = mLastcluster;
-	itr.mEnd = mLastcluster->end();
-
-	return itr;
-}
-
-template<typename T>
-inline bool operator==(const cluster_vector_iterator<T>& a, const cluster_vector_iterator<T>& b)
-{
-	return a.mCurrent == b.mCurrent;
-}
-
-
-template<typename T>
-inline bool operator!=(const cluster_vector_iterator<T>& a, const cluster_vector_iterator<T>& b)
-{
-	return a.mCurrent != b.mCurrent;
-}
-
-}
-
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	The contents of this file is modified versions of EASTL source --
+//	https://github.com/electronicarts/EASTL
+//-----------------------------------------------------------------------------
+//	BSD 3-Clause License
+//	
+//	Copyright (c) 2019, Electronic Arts
+//	All rights reserved.
+//	
+//	Redistribution and use in source and binary forms, with or without
+//	modification, are permitted provided that the following conditions are met:
+//	
+//	1. Redistributions of source code must retain the above copyright notice, this
+//	list of conditions and the following disclaimer.
+//	
+//	2. Redistributions in binary form must reproduce the above copyright notice,
+//	this list of conditions and the following disclaimer in the documentation
+//	and/or other materials provided with the distribution.
+//	
+//	3. Neither the name of the copyright holder nor the names of its
+//	contributors may be used to endorse or promote products derived from
+//	this software without specific prior written permission.
+//	
+//	THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//	AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//	IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//	DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//	FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//	DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//	SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//	CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//	OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//	OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "Common.h"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sw
+{
+
+// is_trivially_relocatable
+//
+// Whether moving a T to a new address and ending the original's lifetime can be a plain memcpy.
+// Defaults to trivially copyable types. Specialise it as true for types that own memory through
+// plain pointers, such as most handle and buffer classes, as long as nothing inside them points
+// back into the object itself.
+//
+// Example usage:
+//     template <> struct sw::is_trivially_relocatable<Mesh> : std::true_type {};
+//
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+namespace detail
+{
+
+template<typename T>
+struct cluster_helper
+{
+	static const uintptr_t	kIsLastCluster = 1 << 0;
+	uintptr_t				mPrev;
+
+	union
+	{
+		//If there is not another cluster, then mSize stores how many elements are in this container
+		cluster_helper*		mNext;
+		size_t				mSize;
+	};
+	//Data is allocated inline following this object
+	T*						mDataEnd;
+	size_t					mStartIndex;
+	T						mDummyData[2];
+};
+
+template<size_t t_base>
+struct pow_table
+{
+	inline static constexpr size_t const_pow(size_t base, size_t exponent)
+	{
+		return exponent == 0u ? 1u : base * const_pow(base, exponent - 1u);
+	}
+
+	static constexpr size_t val[64] =
+	{
+		const_pow(t_base, 0),
+		const_pow(t_base, 1),
+		const_pow(t_base, 2),
+		const_pow(t_base, 3),
+		const_pow(t_base, 4),
+		const_pow(t_base, 5),
+		const_pow(t_base, 6),
+		const_pow(t_base, 7),
+		const_pow(t_base, 8),
+		const_pow(t_base, 9),
+		const_pow(t_base, 10),
+		const_pow(t_base, 11),
+		const_pow(t_base, 12),
+		const_pow(t_base, 13),
+		const_pow(t_base, 14),
+		const_pow(t_base, 15),
+		const_pow(t_base, 16),
+		const_pow(t_base, 17),
+		const_pow(t_base, 18),
+		const_pow(t_base, 19),
+		const_pow(t_base, 20),
+		const_pow(t_base, 21),
+		const_pow(t_base, 22),
+		const_pow(t_base, 23),
+		const_pow(t_base, 24),
+		const_pow(t_base, 25),
+		const_pow(t_base, 26),
+		const_pow(t_base, 27),
+		const_pow(t_base, 28),
+		const_pow(t_base, 29),
+		const_pow(t_base, 30),
+		const_pow(t_base, 31),
+		const_pow(t_base, 32),
+		const_pow(t_base, 33),
+		const_pow(t_base, 34),
+		const_pow(t_base, 35),
+		const_pow(t_base, 36),
+		const_pow(t_base, 37),
+		const_pow(t_base, 38),
+		const_pow(t_base, 39),
+		const_pow(t_base, 40),
+		const_pow(t_base, 41),
+		const_pow(t_base, 42),
+		const_pow(t_base, 43),
+		const_pow(t_base, 44),
+		const_pow(t_base, 45),
+		const_pow(t_base, 46),
+		const_pow(t_base, 47),
+		const_pow(t_base, 48),
+		const_pow(t_base, 49),
+		const_pow(t_base, 50),
+		const_pow(t_base, 51),
+		const_pow(t_base, 52),
+		const_pow(t_base, 53),
+		const_pow(t_base, 54),
+		const_pow(t_base, 55),
+		const_pow(t_base, 56),
+		const_pow(t_base, 57),
+		const_pow(t_base, 58),
+		const_pow(t_base, 59),
+		const_pow(t_base, 60),
+		const_pow(t_base, 61),
+		const_pow(t_base, 62),
+		const_pow(t_base, 63),
+	};
+};
+
+//Namespace scope definition for C++14, where indexing val odr-uses it
+template<size_t t_base>
+constexpr size_t pow_table<t_base>::val[64];
+
+inline size_t floor_log2(size_t value)
+{
+	return (sizeof(size_t) * 8u - 1u) - static_cast<size_t>(CLUSTER_COUNT_LEADING_ZEROES(value));
+}
+
+//Floor of log_base(value) for value >= 1. Power of two bases resolve with a single clz.
+template<size_t t_base>
+inline size_t floor_log(size_t value)
+{
+	if ((t_base & (t_base - 1u)) == 0u)
+	{
+		return floor_log2(value) / floor_log2(t_base);
+	}
+
+	size_t exponent = 0u;
+	while (value >= t_base)
+	{
+		value /= t_base;
+		++exponent;
+	}
+	return exponent;
+}
+
+//Copy constructs count elements from first into uninitialized memory at dest, returning the advanced source iterator
+template<typename T, typename InputIterator>
+inline InputIterator uninitialized_copy_run(InputIterator first, size_t count, T* dest, std::false_type)
+{
+	for (; count; --count, ++first, ++dest)
+	{
+		new (dest) T(*first);
+	}
+	return first;
+}
+
+template<typename T, typename InputIterator>
+inline InputIterator uninitialized_copy_run(InputIterator first, size_t count, T* dest, std::true_type)
+{
+	memcpy(dest, first, count * sizeof(T));
+	return first + count;
+}
+
+template<typename T, typename InputIterator>
+inline InputIterator uninitialized_copy_run(InputIterator first, size_t count, T* dest)
+{
+	using can_memcpy = std::integral_constant<bool,
+		std::is_pointer<InputIterator>::value &&
+		std::is_same<typename std::remove_cv<typename std::remove_pointer<InputIterator>::type>::type, T>::value &&
+		std::is_trivially_copyable<T>::value>;
+	return uninitialized_copy_run(first, count, dest, can_memcpy());
+}
+
+//Destroys the elements in [first, last), the loop folds away for trivially destructible T
+template<typename T>
+inline void destroy_run(T* first, T* last)
+{
+	for (; first != last; ++first)
+	{
+		first->~T();
+	}
+}
+
+//Moves *source into the uninitialized dest and ends the lifetime of *source
+template<typename T>
+inline void relocate(T* dest, T* source, std::true_type)
+{
+	memcpy(static_cast<void*>(dest), static_cast<void const*>(source), sizeof(T));
+}
+
+template<typename T>
+inline void relocate(T* dest, T* source, std::false_type)
+{
+	new (dest) T(std::move(*source));
+	source->~T();
+}
+
+template<typename T>
+inline void relocate(T* dest, T* source)
+{
+	relocate(dest, source, std::integral_constant<bool, is_trivially_relocatable<T>::value>());
+}
+
+//Relocates count elements from source into the uninitialized dest
+template<typename T>
+inline void relocate_run(T* dest, T* source, size_t count, std::true_type)
+{
+	memcpy(static_cast<void*>(dest), static_cast<void const*>(source), count * sizeof(T));
+}
+
+template<typename T>
+inline void relocate_run(T* dest, T* source, size_t count, std::false_type)
+{
+	for (T* e = source + count; source != e; ++source, ++dest)
+	{
+		relocate(dest, source, std::false_type());
+	}
+}
+
+template<typename T>
+inline void relocate_run(T* dest, T* source, size_t count)
+{
+	relocate_run(dest, source, count, std::integral_constant<bool, is_trivially_relocatable<T>::value>());
+}
+
+struct run_relocator
+{
+	template<typename T>
+	void operator()(T* dest, T* source, size_t count) const { relocate_run(dest, source, count); }
+};
+
+//A cluster in memory the allocator did not provide, such as a mapped snapshot, and how to give it back
+struct external_cluster
+{
+	void*		mCluster;
+	void*		mBase;
+	size_t		mLength;
+	void		(*mRelease)(void* base, size_t length);
+};
+
+struct snapshot_access;
+
+//Exchanges two live elements, bytewise when T can be relocated with memcpy
+template<typename T>
+inline void swap_elements(T* a, T* b, std::true_type)
+{
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type temp;
+	memcpy(static_cast<void*>(&temp), static_cast<void const*>(a), sizeof(T));
+	memcpy(static_cast<void*>(a), static_cast<void const*>(b), sizeof(T));
+	memcpy(static_cast<void*>(b), static_cast<void const*>(&temp), sizeof(T));
+}
+
+template<typename T>
+inline void swap_elements(T* a, T* b, std::false_type)
+{
+	using std::swap;
+	swap(*a, *b);
+}
+
+template<typename T>
+inline void swap_elements(T* a, T* b)
+{
+	swap_elements(a, b, std::integral_constant<bool, is_trivially_relocatable<T>::value>());
+}
+
+//Smallest exponent such that base^exponent >= value
+template<size_t t_base>
+inline size_t ceil_log(size_t value)
+{
+	return value <= 1u ? 0u : floor_log<t_base>(value - 1u) + 1u;
+}
+
+}
+
+// Growth policies
+//
+// Decide the element capacity of each cluster from the container's initial
+// cluster capacity and the cluster's position in the chain. Every policy
+// provides cluster_capacity(), and those with an invertible layout also
+// provide cluster_index() so that random access does not need to search the
+// cluster directory.
+//
+// Example usage:
+//     sw::cluster_vector<Particle, Allocator, 2u, sw::capped_geometric_growth<2u, 65536u>> particles;
+//
+
+// Each cluster is tFactor times larger than the previous one.
+template<size_t tFactor>
+struct geometric_growth
+{
+	static_assert(tFactor >= 2u, "geometric_growth requires a factor of at least 2, use fixed_growth for equally sized clusters");
+
+	static constexpr bool kHasClusterIndex = true;
+
+	static size_t cluster_capacity(size_t initialCapacity, size_t clusterIndex, size_t elementSize, size_t headerSize)
+	{
+		CLUSTER_UNUSED(elementSize);
+		CLUSTER_UNUSED(headerSize);
+		return initialCapacity * detail::pow_table<tFactor>::val[clusterIndex];
+	}
+
+	static size_t cluster_index(size_t initialCapacity, size_t elementIndex)
+	{
+		//Invert the geometric series Sn = a1(r^n - 1) / (r - 1)
+		return detail::floor_log<tFactor>(((elementIndex * (tFactor - 1u)) / initialCapacity) + 1u);
+	}
+};
+
+// Every cluster has the initial capacity, the equivalent of eastl::segmented_vector's segments.
+struct fixed_growth
+{
+	static constexpr bool kHasClusterIndex = true;
+
+	static size_t cluster_capacity(size_t initialCapacity, size_t clusterIndex, size_t elementSize, size_t headerSize)
+	{
+		CLUSTER_UNUSED(clusterIndex);
+		CLUSTER_UNUSED(elementSize);
+		CLUSTER_UNUSED(headerSize);
+		return initialCapacity;
+	}
+
+	static size_t cluster_index(size_t initialCapacity, size_t elementIndex)
+	{
+		return elementIndex / initialCapacity;
+	}
+};
+
+// A step size of 1 is a fixed cluster size.
+template<>
+struct geometric_growth<1u> : fixed_growth
+{
+};
+
+// Geometric growth until clusters reach tMaxClusterCapacity elements, after which every cluster has that capacity.
+template<size_t tFactor, size_t tMaxClusterCapacity>
+struct capped_geometric_growth
+{
+	static_assert(tFactor >= 2u, "capped_geometric_growth requires a factor of at least 2");
+	static_assert(tMaxClusterCapacity > 0u, "capped_geometric_growth requires a non-zero maximum capacity");
+
+	static constexpr bool kHasClusterIndex = true;
+
+	static size_t cluster_capacity(size_t initialCapacity, size_t clusterIndex, size_t elementSize, size_t headerSize)
+	{
+		size_t const cappedIndex = capped_cluster_index(initialCapacity);
+		if (clusterIndex < cappedIndex)
+		{
+			return geometric_growth<tFactor>::cluster_capacity(initialCapacity, clusterIndex, elementSize, headerSize);
+		}
+		return tMaxClusterCapacity;
+	}
+
+	static size_t cluster_index(size_t initialCapacity, size_t elementIndex)
+	{
+		size_t const cappedIndex = capped_cluster_index(initialCapacity);
+		size_t const cappedStart = (initialCapacity * (detail::pow_table<tFactor>::val[cappedIndex] - 1u)) / (tFactor - 1u);
+		if (elementIndex < cappedStart)
+		{
+			return geometric_growth<tFactor>::cluster_index(initialCapacity, elementIndex);
+		}
+		return cappedIndex + (elementIndex - cappedStart) / tMaxClusterCapacity;
+	}
+
+	//Index of the first cluster that is held at tMaxClusterCapacity
+	static size_t capped_cluster_index(size_t initialCapacity)
+	{
+		return detail::ceil_log<tFactor>((tMaxClusterCapacity + initialCapacity - 1u) / initialCapacity);
+	}
+};
+
+// Geometric growth where every allocation, header included, is rounded up to a whole number of
+// tPageSize pages and the slack is handed out as extra capacity. There is no closed form for the
+// owning cluster of an index, so random access binary searches the cluster directory.
+template<size_t tFactor, size_t tPageSize = 4096u>
+struct page_rounded_growth
+{
+	static_assert((tPageSize & (tPageSize - 1u)) == 0u, "page_rounded_growth requires a power of two page size");
+
+	static constexpr bool kHasClusterIndex = false;
+
+	static size_t cluster_capacity(size_t initialCapacity, size_t clusterIndex, size_t elementSize, size_t headerSize)
+	{
+		size_t const requested = geometric_growth<tFactor>::cluster_capacity(initialCapacity, clusterIndex, elementSize, headerSize);
+		size_t const allocationSize = (headerSize + (requested * elementSize) + (tPageSize - 1u)) & ~(tPageSize - 1u);
+		return (allocationSize - headerSize) / elementSize;
+	}
+};
+
+template<typename T>
+class cluster
+{
+public:
+	using size_type			= size_t;
+	using this_type			= cluster<T>;
+	using iterator			= T*;
+	using const_iterator	= T const *;
+
+	const this_type*		next_cluster() const;
+	this_type*				next_cluster();
+
+	const_iterator			begin() const;
+	iterator				begin();
+
+	const_iterator			end() const;
+	iterator				end();
+
+	size_type				capacity() const;
+	size_type				size() const;
+
+	static size_type		allocation_size(size_type num_elements);
+	bool					is_last_cluster() const;
+
+	static const uintptr_t	kIsLastCluster = 1 << 0;
+	uintptr_t				mPrev;
+
+	union
+	{
+		//If there is not another cluster, then mSize stores how many elements are in this container
+		this_type*			mNext;
+		size_type			mSize;
+	};
+	//Data is allocated inline following this object
+	T*						mDataEnd;
+	//Index of this cluster's first element within the whole container
+	size_type				mStartIndex;
+	template<typename, typename, size_t, typename> friend class cluster_vector;
+	template<typename> friend struct cluster_vector_iterator;
+};
+
+
+template <typename Container, typename T>
+struct cluster_vector_indexed_iterator
+{
+public:
+	using this_type			= cluster_vector_indexed_iterator<Container, T>;
+	using size_type			= size_t;
+	using iterator_category	= std::random_access_iterator_tag;
+	using value_type		= typename std::remove_const<T>::type;
+	using difference_type	= ptrdiff_t;
+	using pointer			= T*;
+	using reference			= T&;
+
+							cluster_vector_indexed_iterator() = default;
+							cluster_vector_indexed_iterator(Container* container, size_type index);
+
+	template <typename OtherContainer, typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+							cluster_vector_indexed_iterator(cluster_vector_indexed_iterator<OtherContainer, U> const & other);
+
+	T*						operator->() const;
+	T&						operator*() const;
+	T&						operator[](difference_type n) const;
+
+	this_type&				operator++();
+	this_type				operator++(int);
+	this_type&				operator--();
+	this_type				operator--(int);
+
+	this_type&				operator+=(difference_type n);
+	this_type&				operator-=(difference_type n);
+	this_type				operator+(difference_type n) const;
+	this_type				operator-(difference_type n) const;
+	difference_type			operator-(this_type const & other) const;
+
+public:
+	Container*				mContainer;
+	size_type				mIndex;
+};
+
+
+template <typename T>
+struct cluster_vector_iterator
+{
+public:
+	using this_type			= cluster_vector_iterator<T>;
+	using cluster_type		= cluster<T>;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= typename std::remove_const<T>::type;
+	using difference_type	= ptrdiff_t;
+	using pointer			= T*;
+	using reference			= T&;
+
+	T*						operator->() const;
+	T&						operator*() const;
+
+	this_type&				operator++();
+	this_type				operator++(int);
+
+public:
+	T*						mCurrent;
+	T*						mEnd;
+	cluster_type*			mCluster;
+};
+
+
+// cluster_segment
+//
+// The contiguous run of elements held by one cluster. Iterating a container
+// segment by segment lets the inner loop run over plain pointers, without
+// the end-of-cluster check that cluster_vector_iterator::operator++ makes
+// on every element.
+//
+// Example usage:
+//     for (auto segment : vec.segments())
+//         for (float* i = segment.begin(); i != segment.end(); ++i)
+//             *i *= 2.0f;
+//
+template <typename T>
+struct cluster_segment
+{
+public:
+	using cluster_type			= cluster<typename std::remove_const<T>::type>;
+	using size_type				= size_t;
+	using iterator				= T*;
+	using container_iterator	= cluster_vector_iterator<T>;
+
+	T*						begin() const { return mBegin; }
+	T*						end() const { return mEnd; }
+	size_type				size() const { return mEnd - mBegin; }
+	bool					empty() const { return mBegin == mEnd; }
+
+	//Iterator of the owning container pointing at an element of this segment
+	container_iterator		to_iterator(T* position) const;
+
+public:
+	cluster_type*			mCluster;
+	T*						mBegin;
+	T*						mEnd;
+};
+
+template <typename T>
+struct cluster_segment_iterator
+{
+public:
+	using this_type			= cluster_segment_iterator<T>;
+	using cluster_type		= cluster<typename std::remove_const<T>::type>;
+	using iterator_category	= std::forward_iterator_tag;
+	using value_type		= cluster_segment<T>;
+	using difference_type	= ptrdiff_t;
+	using pointer			= const value_type*;
+	using reference			= value_type;
+
+	value_type				operator*() const;
+
+	this_type&				operator++();
+	this_type				operator++(int);
+
+public:
+	cluster_type*			mCluster;
+	T*						mBegin;			//Start of the current segment, which is only ever past the cluster's first element for the first segment
+	cluster_type*			mLastCluster;	//The final cluster visited, which may end before its last element
+	T*						mLastEnd;
+};
+
+template <typename SegmentIterator>
+struct cluster_segment_range
+{
+public:
+	SegmentIterator			begin() const { return mBegin; }
+	SegmentIterator			end() const { return mEnd; }
+
+public:
+	SegmentIterator			mBegin;
+	SegmentIterator			mEnd;
+};
+
+
+template <typename T, typename Allocator, size_t tStepSize = 2u, typename GrowthPolicy = geometric_growth<tStepSize>>
+class cluster_vector
+{
+public:
+	template <typename U, typename OtherAllocator, size_t tOtherStepSize, typename OtherGrowthPolicy>
+	friend class cluster_map;
+	friend struct detail::snapshot_access;
+
+	using size_type				= size_t;
+	using this_type				= cluster_vector<T, Allocator, tStepSize, GrowthPolicy>;
+	using cluster_type			= cluster<T>;
+	using cluster_helper_type	= typename detail::cluster_helper<T>;
+	using allocator_type		= Allocator;
+	using growth_policy_type	= GrowthPolicy;
+	using iterator				= cluster_vector_iterator<T>;
+	using const_iterator		= cluster_vector_iterator<const T>;
+	using indexed_iterator		= cluster_vector_indexed_iterator<this_type, T>;
+	using const_indexed_iterator	= cluster_vector_indexed_iterator<const this_type, const T>;
+	using segment_range			= cluster_segment_range<cluster_segment_iterator<T>>;
+	using const_segment_range	= cluster_segment_range<cluster_segment_iterator<const T>>;
+
+	using value_type			= T;
+
+	cluster_vector(size_type initialClusterCapacity, const Allocator& allocator = Allocator());
+	cluster_vector() : cluster_vector(64u) {}
+
+	template <typename InputIterator, typename = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+	cluster_vector(InputIterator first, InputIterator last, size_type initialClusterCapacity = 64u, const Allocator& allocator = Allocator());
+	~cluster_vector();
+
+	cluster_vector(cluster_vector && other);
+	cluster_vector& operator=(cluster_vector &&) = default;
+
+	cluster_vector(cluster_vector const &) = delete;
+	cluster_vector& operator=(cluster_vector const &) = delete;
+
+	allocator_type&			get_allocator();
+
+	const cluster_type*		first_cluster() const;
+	cluster_type*			first_cluster();
+	const_iterator			begin() const;
+	iterator				begin();
+
+	const_iterator			end() const;
+	iterator				end();
+
+	//Random access iterators, each dereference resolves its index through the cluster directory
+	const_indexed_iterator	indexed_begin() const;
+	indexed_iterator		indexed_begin();
+
+	const_indexed_iterator	indexed_end() const;
+	indexed_iterator		indexed_end();
+
+	//Each cluster's elements as a contiguous [begin, end) run, see cluster_segment
+	const_segment_range		segments() const;
+	segment_range			segments();
+	//The runs covering only the elements with indices in [first, last)
+	const_segment_range		segments(size_type first, size_type last) const;
+	segment_range			segments(size_type first, size_type last);
+	//The run of the cluster at position clusterIndex in the chain, found through the cluster directory. Valid for clusterIndex < segment_count().
+	size_type				segment_count() const { return mClusterCount; }
+	cluster_segment<const T> segment(size_type clusterIndex) const;
+	cluster_segment<T>		segment(size_type clusterIndex);
+
+	size_type				size() const;
+	size_type				capacity() const;
+	size_type				cluster_count() const;
+	T&						front();
+	T&						back();
+
+	const T&				operator[](size_type index) const;
+	T&						operator[](size_type index);
+	const T&				at(size_type index) const;
+	T&						at(size_type index);
+
+	bool					empty() const;
+	void					clear();
+
+	//Allocates the cluster chain up front so that the first count elements never allocate. Reserved clusters are kept through pop_back() and clear().
+	void					reserve(size_type count);
+	//Frees every cluster that holds no elements, including reserved and spare clusters
+	void					shrink_to_fit();
+
+	//Relocates every element into a single cluster of exactly size() elements and frees the rest, returns the contiguous block.
+	//Later growth appends clusters as usual, but random access searches the directory from then on since the first cluster no longer follows the growth policy.
+	T*						compact();
+	//The elements as one contiguous block of size() when they fit in a single cluster, otherwise nullptr
+	const T*				data() const;
+	T*						data();
+
+	//How many emptied clusters are kept past the last used cluster, so that pushing and popping across a cluster boundary does not allocate and free each time
+	size_type				spare_cluster_limit() const;
+	void					set_spare_cluster_limit(size_type limit);
+
+	iterator				push_back();
+	iterator				push_back(const T& value);
+	iterator				push_back(T&& value);
+	iterator				push_back_uninitialized();
+
+	template <typename... Args>
+	iterator				emplace_back(Args&&... args);
+
+	//Bulk construction, filling each cluster with a single run rather than checking capacity per element
+	template <typename InputIterator>
+	void					append(InputIterator first, InputIterator last);
+	void					append_n(size_type count, const T& value);
+
+	//Links the clusters of other onto the end of this vector without copying its elements, leaving other empty. Only a partly filled last cluster here is
+	//relocated, into a cluster of exactly its size, unless other's elements fit in its free space and are moved there instead. Either way at most one
+	//cluster's worth of elements is touched. The adopted clusters are later freed through this vector's allocator, which must be able to free them.
+	void					splice_back(this_type&& other);
+
+	void					resize(size_type count);
+	void					resize(size_type count, const T& value);
+
+	void					pop_back();
+
+	void					erase_unsorted(cluster_type& cluster, typename cluster_type::iterator it);
+	iterator				erase_unsorted(const iterator& i);
+
+	void					swap(this_type& other);
+
+protected:
+	cluster_type*			DoAlloccluster(size_type clusterIndex, size_t numElements);
+	void					DoFreeCluster(cluster_type* cluster);
+	void					DoFreeSpareClusters(size_type keepCount);
+	void					DoTrimSpareClusters();
+	cluster_type*			DoAppendCluster();
+	void					DoPopCluster();
+	iterator				DoPushBack();
+	void					DoPopBackUninitialized();
+	T*						DoAppendRun(size_type count, size_type& runLength);
+	void					DoTruncate(size_type count);
+	template <typename Relocate>
+	T*						DoCompact(Relocate relocate);
+	void					DoAdoptCluster(void* image, size_type count, detail::external_cluster const& external);
+	void					DoDestroyElements(std::true_type);
+	void					DoDestroyElements(std::false_type);
+
+	template <typename InputIterator>
+	void					DoAppend(InputIterator first, InputIterator last, std::input_iterator_tag);
+	template <typename ForwardIterator>
+	void					DoAppend(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag);
+	cluster_type*			DoLocate(size_type index, size_type& offset) const;
+	size_type				DoLocateClusterIndex(size_type index) const;
+	size_type				DoLocateClusterIndex(size_type index, std::true_type) const;
+	size_type				DoLocateClusterIndex(size_type index, std::false_type) const;
+	size_type				DoClusterCapacity(size_type clusterIndex) const;
+	void					DoGrowDirectory(size_type minCapacity);
+
+	allocator_type			mAllocator;
+	cluster_type*			mFirstcluster;
+	cluster_type*			mLastcluster;
+	size_type				mClusterCount;
+	size_type const			mInitialClusterCapacity;
+	cluster_type**			mClusterDirectory;		//Every cluster in chain order, so the owning cluster of an index is a single lookup. Entries past mClusterCount are allocated but unused.
+	size_type				mDirectoryCapacity;
+	size_type				mAllocatedClusterCount;	//In use plus spare clusters held by the directory
+	size_type				mReservedClusterCount;	//Clusters that reserve() asked to keep allocated
+	size_type				mSpareClusterLimit;		//Emptied clusters kept past mClusterCount on top of any reservation
+	bool					mIrregularClusters;		//Cluster sizes no longer follow the growth policy after compact(), a loaded snapshot or splice_back(), so random access searches the directory
+	size_type				mGrowthClusterOffset;	//Added to a cluster's index when asking the growth policy for its capacity, so growth after compact() carries on from the compacted size
+	detail::external_cluster	mExternalCluster;		//Released through its own callback rather than the allocator when freed
+};
+
+
+template<typename T>
+inline const cluster<T>*
+cluster<T>::next_cluster() const
+{
+	if (mPrev & kIsLastCluster)
+	{
+		return nullptr;
+	}
+	else
+	{
+		return mNext;
+	}
+}
+
+template<typename T>
+inline cluster<T>*
+cluster<T>::next_cluster()
+{
+	if (mPrev & kIsLastCluster)
+	{
+		return nullptr;
+	}
+	else
+	{
+		return mNext;
+	}
+}
+
+template<typename T>
+inline typename cluster<T>::const_iterator
+cluster<T>::begin() const
+{
+	char const * dataOffset = reinterpret_cast<char const *>(this) + CLUSTER_OFFSETOF(detail::cluster_helper<T>, mDummyData);
+	return (cluster<T>::iterator)(dataOffset);
+}
+
+template<typename T>
+inline typename cluster<T>::iterator
+cluster<T>::begin()
+{
+	char* dataOffset = reinterpret_cast<char*>(this) + CLUSTER_OFFSETOF(detail::cluster_helper<T>, mDummyData);
+	return (cluster<T>::iterator)(dataOffset);
+}
+
+template<typename T>
+inline typename cluster<T>::const_iterator
+cluster<T>::end() const
+{
+	if (mPrev & this_type::kIsLastCluster)
+	{
+		return begin() + mSize;
+	}
+	else
+	{
+		return mDataEnd;
+	}
+}
+
+template<typename T>
+inline typename cluster<T>::iterator
+cluster<T>::end()
+{
+	if (mPrev & kIsLastCluster)
+	{
+		return begin() + mSize;
+	}
+	else
+	{
+		return mDataEnd;
+	}
+}
+
+template<typename T>
+inline typename cluster<T>::size_type 
+cluster<T>::capacity() const
+{
+	return mDataEnd - begin();
+}
+
+template<typename T>
+inline typename cluster<T>::size_type
+cluster<T>::size() const
+{
+	if (mPrev & this_type::kIsLastCluster)
+	{
+		return mSize;
+	}
+	else
+	{
+		return capacity();
+	}
+}
+
+template<typename T>
+inline typename cluster<T>::size_type 
+cluster<T>::allocation_size(size_type num_elements)
+{
+	return sizeof(detail::cluster_helper<T>) + (sizeof(T) * num_elements) - (sizeof(T) * 2u);
+}
+
+template<typename T>
+inline bool cluster<T>::is_last_cluster() const
+{
+	return mPrev & this_type::kIsLastCluster;
+}
+
+template<typename T>
+T*
+cluster_vector_iterator<T>::operator->() const
+{
+	return mCurrent;
+}
+
+template<typename T>
+T&
+cluster_vector_iterator<T>::operator*() const
+{
+	return *mCurrent;
+}
+
+template<typename T>
+cluster_vector_iterator<T>&
+cluster_vector_iterator<T>::operator++()
+{
+	++mCurrent;
+	if(CLUSTER_UNLIKELY(mCurrent == mEnd))
+	{
+		if (!(mCluster->mPrev & cluster_type::kIsLastCluster))
+		{
+			mCluster = mCluster->mNext;
+			mCurrent = mCluster->begin();
+			mEnd = mCluster->end();
+		}
+		else
+		{
+			mCurrent = 0;
+		}
+	}
+	return *this;
+}
+
+template<typename T>
+cluster_vector_iterator<T>
+cluster_vector_iterator<T>::operator++(int)
+{
+	this_type i(*this);
+	operator++();
+	return i;
+}
+
+template<typename T>
+inline typename cluster_segment<T>::container_iterator
+cluster_segment<T>::to_iterator(T* position) const
+{
+	container_iterator i;
+	i.mCurrent = position;
+	i.mEnd = mCluster->end();
+	i.mCluster = reinterpret_cast<typename container_iterator::cluster_type*>(mCluster);
+	return i;
+}
+
+template<typename T>
+inline typename cluster_segment_iterator<T>::value_type
+cluster_segment_iterator<T>::operator*() const
+{
+	value_type segment;
+	segment.mCluster = mCluster;
+	segment.mBegin = mBegin;
+	segment.mEnd = mCluster == mLastCluster ? mLastEnd : mCluster->end();
+	return segment;
+}
+
+template<typename T>
+inline cluster_segment_iterator<T>&
+cluster_segment_iterator<T>::operator++()
+{
+	mCluster = mCluster == mLastCluster ? nullptr : mCluster->mNext;
+	mBegin = mCluster ? mCluster->begin() : nullptr;
+	return *this;
+}
+
+template<typename T>
+inline cluster_segment_iterator<T>
+cluster_segment_iterator<T>::operator++(int)
+{
+	this_type i(*this);
+	operator++();
+	return i;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>::cluster_vector_indexed_iterator(Container* container, size_type index)
+	: mContainer(container)
+	, mIndex(index)
+{
+}
+
+template<typename Container, typename T>
+template<typename OtherContainer, typename U, typename>
+inline cluster_vector_indexed_iterator<Container, T>::cluster_vector_indexed_iterator(cluster_vector_indexed_iterator<OtherContainer, U> const & other)
+	: mContainer(other.mContainer)
+	, mIndex(other.mIndex)
+{
+}
+
+template<typename Container, typename T>
+inline T*
+cluster_vector_indexed_iterator<Container, T>::operator->() const
+{
+	return &(*mContainer)[mIndex];
+}
+
+template<typename Container, typename T>
+inline T&
+cluster_vector_indexed_iterator<Container, T>::operator*() const
+{
+	return (*mContainer)[mIndex];
+}
+
+template<typename Container, typename T>
+inline T&
+cluster_vector_indexed_iterator<Container, T>::operator[](difference_type n) const
+{
+	return (*mContainer)[mIndex + n];
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>&
+cluster_vector_indexed_iterator<Container, T>::operator++()
+{
+	++mIndex;
+	return *this;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>
+cluster_vector_indexed_iterator<Container, T>::operator++(int)
+{
+	this_type i(*this);
+	++mIndex;
+	return i;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>&
+cluster_vector_indexed_iterator<Container, T>::operator--()
+{
+	--mIndex;
+	return *this;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>
+cluster_vector_indexed_iterator<Container, T>::operator--(int)
+{
+	this_type i(*this);
+	--mIndex;
+	return i;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>&
+cluster_vector_indexed_iterator<Container, T>::operator+=(difference_type n)
+{
+	mIndex += n;
+	return *this;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>&
+cluster_vector_indexed_iterator<Container, T>::operator-=(difference_type n)
+{
+	mIndex -= n;
+	return *this;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>
+cluster_vector_indexed_iterator<Container, T>::operator+(difference_type n) const
+{
+	return this_type(mContainer, mIndex + n);
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T>
+cluster_vector_indexed_iterator<Container, T>::operator-(difference_type n) const
+{
+	return this_type(mContainer, mIndex - n);
+}
+
+template<typename Container, typename T>
+inline typename cluster_vector_indexed_iterator<Container, T>::difference_type
+cluster_vector_indexed_iterator<Container, T>::operator-(this_type const & other) const
+{
+	return static_cast<difference_type>(mIndex) - static_cast<difference_type>(other.mIndex);
+}
+
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_vector(size_type initialClusterCapacity, const Allocator& allocator)
+	:	mAllocator(allocator)
+	,	mFirstcluster(nullptr)
+	,	mLastcluster(nullptr)
+	,	mClusterCount(0)
+	,	mInitialClusterCapacity(initialClusterCapacity)
+	,	mClusterDirectory(nullptr)
+	,	mDirectoryCapacity(0)
+	,	mAllocatedClusterCount(0)
+	,	mReservedClusterCount(0)
+	,	mSpareClusterLimit(1)
+	,	mIrregularClusters(false)
+	,	mGrowthClusterOffset(0)
+	,	mExternalCluster{}
+{
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename InputIterator, typename>
+inline cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_vector(InputIterator first, InputIterator last, size_type initialClusterCapacity, const Allocator& allocator)
+	:	cluster_vector(initialClusterCapacity, allocator)
+{
+	append(first, last);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_vector(this_type&& other)
+	:	mAllocator(other.mAllocator)
+	,	mFirstcluster(other.mFirstcluster)
+	,	mLastcluster(other.mLastcluster)
+	,	mClusterCount(other.mClusterCount)
+	,	mInitialClusterCapacity(other.mInitialClusterCapacity)
+	,	mClusterDirectory(other.mClusterDirectory)
+	,	mDirectoryCapacity(other.mDirectoryCapacity)
+	,	mAllocatedClusterCount(other.mAllocatedClusterCount)
+	,	mReservedClusterCount(other.mReservedClusterCount)
+	,	mSpareClusterLimit(other.mSpareClusterLimit)
+	,	mIrregularClusters(other.mIrregularClusters)
+	,	mGrowthClusterOffset(other.mGrowthClusterOffset)
+	,	mExternalCluster(other.mExternalCluster)
+{
+	other.mFirstcluster = nullptr;
+	other.mLastcluster = nullptr;
+	other.mClusterCount = 0;
+	other.mClusterDirectory = nullptr;
+	other.mDirectoryCapacity = 0;
+	other.mAllocatedClusterCount = 0;
+	other.mReservedClusterCount = 0;
+	other.mExternalCluster = detail::external_cluster{};
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::~cluster_vector()
+{
+	DoDestroyElements(std::is_trivially_destructible<T>());
+	//Every cluster is now spare, so they all go back to the allocator in one pass
+	mFirstcluster = 0;
+	mLastcluster = 0;
+	mClusterCount = 0;
+	DoFreeSpareClusters(0u);
+	if (mClusterDirectory)
+	{
+		CLUSTERFree(mAllocator, mClusterDirectory, mDirectoryCapacity * sizeof(cluster_type*));
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::allocator_type&
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::get_allocator()
+{
+	return mAllocator;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::first_cluster() const
+{
+	return mFirstcluster;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::first_cluster()
+{
+	return mFirstcluster;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::begin() const
+{
+	iterator i;
+	i.mCluster = mFirstcluster;
+	if (mFirstcluster)
+	{
+		i.mCurrent = mFirstcluster->begin();
+		i.mEnd = mFirstcluster->end();
+	}
+	else
+	{
+		i.mCurrent = 0;
+	}
+	return (const_iterator&)i;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::begin()
+{
+	iterator i;
+	i.mCluster = mFirstcluster;
+	if (mFirstcluster)
+	{
+		i.mCurrent = mFirstcluster->begin();
+		i.mEnd = mFirstcluster->end();
+	}
+	else
+	{
+		i.mCurrent = 0;
+	}
+	return i;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::end() const
+{
+	iterator i;
+	i.mCurrent = 0;
+	return (const_iterator&)i;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::end()
+{
+	iterator i;
+	i.mCurrent = 0;
+	return i;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_indexed_iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::indexed_begin() const
+{
+	return const_indexed_iterator(this, 0u);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::indexed_iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::indexed_begin()
+{
+	return indexed_iterator(this, 0u);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_indexed_iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::indexed_end() const
+{
+	return const_indexed_iterator(this, size());
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::indexed_iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::indexed_end()
+{
+	return indexed_iterator(this, size());
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_segment_range
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segments() const
+{
+	const_segment_range range{};
+	range.mBegin.mCluster = mFirstcluster;
+	range.mBegin.mBegin = mFirstcluster ? mFirstcluster->begin() : nullptr;
+	range.mBegin.mLastCluster = mLastcluster;
+	range.mBegin.mLastEnd = mLastcluster ? mLastcluster->end() : nullptr;
+	return range;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segment_range
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segments()
+{
+	segment_range range{};
+	range.mBegin.mCluster = mFirstcluster;
+	range.mBegin.mBegin = mFirstcluster ? mFirstcluster->begin() : nullptr;
+	range.mBegin.mLastCluster = mLastcluster;
+	range.mBegin.mLastEnd = mLastcluster ? mLastcluster->end() : nullptr;
+	return range;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::const_segment_range
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segments(size_type first, size_type last) const
+{
+	const_segment_range range{};
+	if (first < last)
+	{
+		size_type firstOffset, lastOffset;
+		cluster_type* firstCluster = DoLocate(first, firstOffset);
+		cluster_type* lastCluster = DoLocate(last - 1u, lastOffset);
+		range.mBegin.mCluster = firstCluster;
+		range.mBegin.mBegin = firstCluster->begin() + firstOffset;
+		range.mBegin.mLastCluster = lastCluster;
+		range.mBegin.mLastEnd = lastCluster->begin() + lastOffset + 1u;
+	}
+	return range;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segment_range
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segments(size_type first, size_type last)
+{
+	segment_range range{};
+	if (first < last)
+	{
+		size_type firstOffset, lastOffset;
+		cluster_type* firstCluster = DoLocate(first, firstOffset);
+		cluster_type* lastCluster = DoLocate(last - 1u, lastOffset);
+		range.mBegin.mCluster = firstCluster;
+		range.mBegin.mBegin = firstCluster->begin() + firstOffset;
+		range.mBegin.mLastCluster = lastCluster;
+		range.mBegin.mLastEnd = lastCluster->begin() + lastOffset + 1u;
+	}
+	return range;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_segment<const T>
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segment(size_type clusterIndex) const
+{
+	cluster_type* cluster = mClusterDirectory[clusterIndex];
+	return cluster_segment<const T>{cluster, cluster->begin(), cluster->end()};
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline cluster_segment<T>
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::segment(size_type clusterIndex)
+{
+	cluster_type* cluster = mClusterDirectory[clusterIndex];
+	return cluster_segment<T>{cluster, cluster->begin(), cluster->end()};
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size() const
+{
+	if (cluster_type* cluster = mLastcluster)
+	{
+		return cluster->mStartIndex + cluster->mSize;
+	}
+	return 0;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::capacity() const
+{
+	if (mAllocatedClusterCount)
+	{
+		cluster_type* cluster = mClusterDirectory[mAllocatedClusterCount - 1u];
+		return cluster->mStartIndex + cluster->capacity();
+	}
+	return 0;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_count() const
+{
+	return mClusterCount;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::front()
+{
+	return *mFirstcluster->begin();
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::back()
+{
+	cluster_type* lastcluster = mLastcluster;
+	return *(lastcluster->end() - 1u);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T&
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::operator[](size_type index) const
+{
+	size_type offset;
+	cluster_type* cluster = DoLocate(index, offset);
+	return *(cluster->begin() + offset);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::operator[](size_type index)
+{
+	size_type offset;
+	cluster_type* cluster = DoLocate(index, offset);
+	return *(cluster->begin() + offset);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T&
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::at(size_type index) const
+{
+#if CLUSTER_EXCEPTIONS_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		throw std::out_of_range("cluster_vector::at -- out of range");
+#elif CLUSTER_ASSERT_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		CLUSTER_ASSERT("cluster_vector::at -- out of range");
+#endif
+	return operator[](index);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T&
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::at(size_type index)
+{
+#if CLUSTER_EXCEPTIONS_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		throw std::out_of_range("cluster_vector::at -- out of range");
+#elif CLUSTER_ASSERT_ENABLED
+	if (CLUSTER_UNLIKELY(index >= size()))
+		CLUSTER_ASSERT("cluster_vector::at -- out of range");
+#endif
+	return operator[](index);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline bool
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::empty() const
+{
+	return mFirstcluster == 0;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::clear()
+{
+	if (mFirstcluster)
+	{
+		DoDestroyElements(std::is_trivially_destructible<T>());
+		mFirstcluster = 0;
+		mLastcluster = 0;
+		mClusterCount = 0;
+		DoTrimSpareClusters();
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::reserve(size_type count)
+{
+	size_type reservedCapacity = capacity();
+	while (reservedCapacity < count)
+	{
+		size_type clusterIndex = mAllocatedClusterCount;
+		reservedCapacity += DoAlloccluster(clusterIndex, DoClusterCapacity(clusterIndex))->capacity();
+	}
+
+	if (mReservedClusterCount < mAllocatedClusterCount)
+	{
+		mReservedClusterCount = mAllocatedClusterCount;
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::shrink_to_fit()
+{
+	mReservedClusterCount = 0;
+	DoFreeSpareClusters(0u);
+	if (!mAllocatedClusterCount && mClusterDirectory)
+	{
+		CLUSTERFree(mAllocator, mClusterDirectory, mDirectoryCapacity * sizeof(cluster_type*));
+		mClusterDirectory = nullptr;
+		mDirectoryCapacity = 0;
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::compact()
+{
+	return DoCompact(detail::run_relocator());
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline const T*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::data() const
+{
+	return mClusterCount == 1u ? mFirstcluster->begin() : nullptr;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::data()
+{
+	return mClusterCount == 1u ? mFirstcluster->begin() : nullptr;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::spare_cluster_limit() const
+{
+	return mSpareClusterLimit;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::set_spare_cluster_limit(size_type limit)
+{
+	mSpareClusterLimit = limit;
+	DoTrimSpareClusters();
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back()
+{
+	iterator itr = DoPushBack();
+	new (itr.mCurrent) T();
+	return itr;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back(const T& value)
+{
+	iterator itr = DoPushBack();
+	new (itr.mCurrent) T(value);
+	return itr;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back(T&& value)
+{
+	iterator itr = DoPushBack();
+	new (itr.mCurrent) T(std::move(value));
+	return itr;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename... Args>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::emplace_back(Args&&... args)
+{
+	iterator itr = DoPushBack();
+	new (itr.mCurrent) T(std::forward<Args>(args)...);
+	return itr;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::push_back_uninitialized()
+{
+	return DoPushBack();
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::pop_back()
+{
+	cluster_type* lastcluster = mLastcluster;
+#if CLUSTER_ASSERT_ENABLED
+	if(CLUSTER_UNLIKELY(!lastcluster))
+		CLUSTER_ASSERT("cluster_vector::pop_back -- clustered vector is empty");
+#endif
+	(lastcluster->begin() + lastcluster->mSize - 1u)->T::~T();
+	DoPopBackUninitialized();
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename InputIterator>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::append(InputIterator first, InputIterator last)
+{
+	DoAppend(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::append_n(size_type count, const T& value)
+{
+	while (count)
+	{
+		size_type runLength;
+		T* run = DoAppendRun(count, runLength);
+		for (T* i = run, *e = run + runLength; i != e; ++i)
+		{
+			new (i) T(value);
+		}
+		count -= runLength;
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::resize(size_type count)
+{
+	size_type currentSize = size();
+	if (count < currentSize)
+	{
+		DoTruncate(count);
+		return;
+	}
+
+	count -= currentSize;
+	while (count)
+	{
+		size_type runLength;
+		T* run = DoAppendRun(count, runLength);
+		for (T* i = run, *e = run + runLength; i != e; ++i)
+		{
+			new (i) T();
+		}
+		count -= runLength;
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::resize(size_type count, const T& value)
+{
+	size_type currentSize = size();
+	if (count < currentSize)
+	{
+		DoTruncate(count);
+	}
+	else
+	{
+		append_n(count - currentSize, value);
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::erase_unsorted(cluster_type& cluster, typename cluster_type::iterator it)
+{
+	CLUSTER_UNUSED(cluster);
+
+	//Relocate the back element into the hole rather than copy assigning it
+	T* last = mLastcluster->begin() + mLastcluster->mSize - 1u;
+	it->~T();
+	if (it != last)
+	{
+		detail::relocate(it, last);
+	}
+	DoPopBackUninitialized();
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::erase_unsorted(const iterator& i)
+{
+	iterator ret(i);
+	T* last = mLastcluster->begin() + mLastcluster->mSize - 1u;
+	if (i.mCurrent == last)
+		ret.mCurrent = 0;
+	erase_unsorted(*i.mCluster, i.mCurrent);
+	return ret;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::swap(this_type& other)
+{
+	allocator_type tempAllocator(mAllocator);
+	cluster_type* tempFirstcluster = mFirstcluster;
+	cluster_type* tempLastcluster = mLastcluster;
+	size_type tempclusterCount = mClusterCount;
+	cluster_type** tempClusterDirectory = mClusterDirectory;
+	size_type tempDirectoryCapacity = mDirectoryCapacity;
+	size_type tempAllocatedClusterCount = mAllocatedClusterCount;
+	size_type tempReservedClusterCount = mReservedClusterCount;
+	size_type tempSpareClusterLimit = mSpareClusterLimit;
+	bool tempIrregularClusters = mIrregularClusters;
+	size_type tempGrowthClusterOffset = mGrowthClusterOffset;
+	detail::external_cluster tempExternalCluster = mExternalCluster;
+
+	mAllocator = other.mAllocator;
+	mFirstcluster = other.mFirstcluster;
+	mLastcluster = other.mLastcluster;
+	mClusterCount = other.mClusterCount;
+	mClusterDirectory = other.mClusterDirectory;
+	mDirectoryCapacity = other.mDirectoryCapacity;
+	mAllocatedClusterCount = other.mAllocatedClusterCount;
+	mReservedClusterCount = other.mReservedClusterCount;
+	mSpareClusterLimit = other.mSpareClusterLimit;
+	mIrregularClusters = other.mIrregularClusters;
+	mGrowthClusterOffset = other.mGrowthClusterOffset;
+	mExternalCluster = other.mExternalCluster;
+
+	other.mAllocator = tempAllocator;
+	other.mFirstcluster = tempFirstcluster;
+	other.mLastcluster = tempLastcluster;
+	other.mClusterCount = tempclusterCount;
+	other.mClusterDirectory = tempClusterDirectory;
+	other.mDirectoryCapacity = tempDirectoryCapacity;
+	other.mAllocatedClusterCount = tempAllocatedClusterCount;
+	other.mReservedClusterCount = tempReservedClusterCount;
+	other.mSpareClusterLimit = tempSpareClusterLimit;
+	other.mIrregularClusters = tempIrregularClusters;
+	other.mGrowthClusterOffset = tempGrowthClusterOffset;
+	other.mExternalCluster = tempExternalCluster;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+cluster<T>*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoAlloccluster(size_type clusterIndex, size_t numElements)
+{
+	if (clusterIndex >= mDirectoryCapacity)
+	{
+		DoGrowDirectory(clusterIndex + 1u);
+	}
+
+	size_t allocationSize = cluster_type::allocation_size(numElements);
+	cluster_type* cluster = (cluster_type*)sw_allocate_memory(mAllocator, allocationSize, CLUSTER_ALIGN_OF(cluster_helper_type), 0);
+	//Capacity must be exact so that the growth policy's cluster_index() holds, tail padding of the helper is left unused
+	cluster->mDataEnd = cluster->begin() + numElements;
+	if (clusterIndex)
+	{
+		cluster_type* prevcluster = mClusterDirectory[clusterIndex - 1u];
+		cluster->mStartIndex = prevcluster->mStartIndex + prevcluster->capacity();
+	}
+	else
+	{
+		//A fresh first cluster puts the chain back in step with the growth policy
+		cluster->mStartIndex = 0u;
+		mIrregularClusters = false;
+		mGrowthClusterOffset = 0u;
+	}
+	mClusterDirectory[clusterIndex] = cluster;
+	mAllocatedClusterCount = clusterIndex + 1u;
+	return cluster;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoFreeCluster(cluster_type* cluster)
+{
+	if (CLUSTER_UNLIKELY(cluster == mExternalCluster.mCluster))
+	{
+		mExternalCluster.mRelease(mExternalCluster.mBase, mExternalCluster.mLength);
+		mExternalCluster = detail::external_cluster{};
+		return;
+	}
+	CLUSTERFree(mAllocator, cluster, cluster_type::allocation_size(cluster->capacity()));
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoFreeSpareClusters(size_type keepCount)
+{
+	if (keepCount < mClusterCount)
+	{
+		keepCount = mClusterCount;
+	}
+
+	while (mAllocatedClusterCount > keepCount)
+	{
+		DoFreeCluster(mClusterDirectory[--mAllocatedClusterCount]);
+	}
+
+	if (mReservedClusterCount > mAllocatedClusterCount)
+	{
+		mReservedClusterCount = mAllocatedClusterCount;
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoTrimSpareClusters()
+{
+	size_type keepCount = mClusterCount + mSpareClusterLimit;
+	DoFreeSpareClusters(keepCount < mReservedClusterCount ? mReservedClusterCount : keepCount);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::iterator
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoPushBack()
+{
+	iterator itr{};
+	cluster_type* cluster = mLastcluster;
+	if (!cluster || cluster->mSize == cluster->capacity())
+	{
+		cluster = DoAppendCluster();
+	}
+	++cluster->mSize;
+
+	itr.mCurrent = cluster->begin() + cluster->mSize - 1u;
+	itr.mCluster = cluster;
+	itr.mEnd = cluster->end();
+
+	return itr;
+}
+
+//Drops the back element, which must already be destroyed or relocated
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoPopBackUninitialized()
+{
+	if (!--mLastcluster->mSize)
+	{
+		DoPopCluster();
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoAppendCluster()
+{
+	cluster_type* lastcluster = mLastcluster;
+	size_type clusterIndex = mClusterCount++;
+	//Take the next reserved cluster if there is one
+	cluster_type* newcluster = clusterIndex < mAllocatedClusterCount ? mClusterDirectory[clusterIndex] : DoAlloccluster(clusterIndex, DoClusterCapacity(clusterIndex));
+	newcluster->mPrev = uintptr_t(lastcluster) | cluster_type::kIsLastCluster;
+	newcluster->mSize = 0;
+	if (lastcluster)
+	{
+		//Only a full cluster is ever followed by another, so its size is implied by its capacity
+		lastcluster->mPrev &= ~cluster_type::kIsLastCluster;
+		lastcluster->mNext = newcluster;
+	}
+	else
+	{
+		mFirstcluster = newcluster;
+	}
+	mLastcluster = newcluster;
+	return newcluster;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoPopCluster()
+{
+	cluster_type* lastcluster = mLastcluster;
+	--mClusterCount;
+	mLastcluster = (cluster_type*)(lastcluster->mPrev & (~cluster_type::kIsLastCluster));
+	//The popped cluster stays in the directory as a spare if it was reserved or is within the spare limit
+	DoTrimSpareClusters();
+	if (mLastcluster)
+	{
+		mLastcluster->mPrev |= cluster_type::kIsLastCluster;
+		mLastcluster->mSize = mLastcluster->capacity();
+	}
+	else
+	{
+		mFirstcluster = 0;
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline T*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoAppendRun(size_type count, size_type& runLength)
+{
+	cluster_type* cluster = mLastcluster;
+	if (!cluster || cluster->mSize == cluster->capacity())
+	{
+		cluster = DoAppendCluster();
+	}
+
+	size_type space = cluster->capacity() - cluster->mSize;
+	runLength = count < space ? count : space;
+
+	T* run = cluster->begin() + cluster->mSize;
+	cluster->mSize += runLength;
+	return run;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoTruncate(size_type count)
+{
+	while (cluster_type* cluster = mLastcluster)
+	{
+		size_type newSize = cluster->mStartIndex < count ? count - cluster->mStartIndex : 0u;
+		detail::destroy_run(cluster->begin() + newSize, cluster->begin() + cluster->mSize);
+
+		if (newSize)
+		{
+			cluster->mSize = newSize;
+			return;
+		}
+		DoPopCluster();
+	}
+}
+
+//Relocate is called as relocate(dest, source, count) once per source cluster, so that cluster_map can patch its sparse indices as it goes
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename Relocate>
+inline T*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoCompact(Relocate relocate)
+{
+	size_type count = size();
+	if (!count)
+	{
+		shrink_to_fit();
+		return nullptr;
+	}
+
+	mReservedClusterCount = 0;
+	if (mClusterCount == 1u && mFirstcluster->capacity() == count)
+	{
+		DoFreeSpareClusters(0u);
+		return mFirstcluster->begin();
+	}
+
+	cluster_type* compacted = (cluster_type*)sw_allocate_memory(mAllocator, cluster_type::allocation_size(count), CLUSTER_ALIGN_OF(cluster_helper_type), 0);
+	compacted->mDataEnd = compacted->begin() + count;
+	compacted->mStartIndex = 0u;
+	compacted->mPrev = cluster_type::kIsLastCluster;
+	compacted->mSize = count;
+
+	T* dest = compacted->begin();
+	for (cluster_type* cluster = mFirstcluster; cluster; cluster = cluster->next_cluster())
+	{
+		size_type clusterSize = cluster->size();
+		relocate(dest, cluster->begin(), clusterSize);
+		dest += clusterSize;
+	}
+
+	//The old clusters hold nothing live now, so they are freed as spares
+	mClusterCount = 0;
+	DoFreeSpareClusters(0u);
+	mClusterDirectory[0] = compacted;
+	mAllocatedClusterCount = 1u;
+	mClusterCount = 1u;
+	mFirstcluster = compacted;
+	mLastcluster = compacted;
+	mIrregularClusters = true;
+
+	//Growth carries on as if the compacted cluster were the last policy cluster no larger than it, instead of starting over
+	//from the initial capacity. Fixed and capped clusters stop growing, so the search stops short of the 64 entry power table.
+	mGrowthClusterOffset = 0u;
+	size_type growthOffset = 0u;
+	while (growthOffset < 62u && DoClusterCapacity(growthOffset + 1u) <= count)
+	{
+		++growthOffset;
+	}
+	mGrowthClusterOffset = growthOffset;
+	return compacted->begin();
+}
+
+//Replaces the contents with a cluster image holding count live elements, only the image's header is written.
+//The image becomes the first cluster and is handed back through external.mRelease once it is freed.
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoAdoptCluster(void* image, size_type count, detail::external_cluster const& external)
+{
+	clear();
+	shrink_to_fit();
+	if (!mDirectoryCapacity)
+	{
+		DoGrowDirectory(1u);
+	}
+
+	cluster_type* cluster = static_cast<cluster_type*>(image);
+	cluster->mPrev = cluster_type::kIsLastCluster;
+	cluster->mSize = count;
+	cluster->mDataEnd = cluster->begin() + count;
+	cluster->mStartIndex = 0u;
+
+	mClusterDirectory[0] = cluster;
+	mAllocatedClusterCount = 1u;
+	mClusterCount = 1u;
+	mFirstcluster = cluster;
+	mLastcluster = cluster;
+	mIrregularClusters = true;
+	mExternalCluster = external;
+	mExternalCluster.mCluster = cluster;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::splice_back(this_type&& other)
+{
+	if (&other == this || other.empty())
+	{
+		return;
+	}
+
+	cluster_type* lastcluster = mLastcluster;
+	if (lastcluster && lastcluster->mSize != lastcluster->capacity())
+	{
+		if (other.size() <= lastcluster->capacity() - lastcluster->mSize)
+		{
+			append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+			other.clear();
+			return;
+		}
+	}
+
+	//Only one mapped snapshot cluster can be tracked, so a second one is moved across element by element
+	if (CLUSTER_UNLIKELY(other.mExternalCluster.mCluster && mExternalCluster.mCluster))
+	{
+		append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+		other.clear();
+		return;
+	}
+
+	//Spare clusters here would sit between the two chains, so they go
+	DoFreeSpareClusters(0u);
+
+	if (lastcluster && lastcluster->mSize != lastcluster->capacity())
+	{
+		//Only a full cluster may be followed by another, so the partly filled one is swapped for an exact fit
+		size_type const count = lastcluster->mSize;
+		uintptr_t const prev = lastcluster->mPrev;
+		cluster_type* exact = DoAlloccluster(mClusterCount - 1u, count);
+		detail::relocate_run(exact->begin(), lastcluster->begin(), count);
+		exact->mPrev = prev;
+		exact->mSize = count;
+		if (cluster_type* prevcluster = (cluster_type*)(prev & (~cluster_type::kIsLastCluster)))
+		{
+			prevcluster->mNext = exact;
+		}
+		else
+		{
+			mFirstcluster = exact;
+		}
+		DoFreeCluster(lastcluster);
+		lastcluster = exact;
+		mLastcluster = exact;
+	}
+
+	size_type const clusterCount = mClusterCount + other.mClusterCount;
+	size_type const allocatedCount = mClusterCount + other.mAllocatedClusterCount;
+	if (allocatedCount > mDirectoryCapacity)
+	{
+		DoGrowDirectory(allocatedCount);
+	}
+
+	//Other's spare clusters come along behind its last cluster, with every start index rebased onto this chain
+	for (size_type i = 0u; i < other.mAllocatedClusterCount; ++i)
+	{
+		cluster_type* cluster = other.mClusterDirectory[i];
+		cluster_type* prevcluster = mClusterCount + i ? mClusterDirectory[mClusterCount + i - 1u] : nullptr;
+		cluster->mStartIndex = prevcluster ? prevcluster->mStartIndex + prevcluster->capacity() : 0u;
+		mClusterDirectory[mClusterCount + i] = cluster;
+	}
+
+	cluster_type* firstcluster = other.mFirstcluster;
+	if (lastcluster)
+	{
+		lastcluster->mPrev &= ~cluster_type::kIsLastCluster;
+		lastcluster->mNext = firstcluster;
+		firstcluster->mPrev = uintptr_t(lastcluster) | (firstcluster->mPrev & cluster_type::kIsLastCluster);
+	}
+	else
+	{
+		mFirstcluster = firstcluster;
+	}
+	mLastcluster = other.mLastcluster;
+	mReservedClusterCount = mClusterCount + other.mReservedClusterCount;
+	mClusterCount = clusterCount;
+	mAllocatedClusterCount = allocatedCount;
+	mIrregularClusters = true;
+	if (other.mExternalCluster.mCluster)
+	{
+		mExternalCluster = other.mExternalCluster;
+	}
+
+	other.mFirstcluster = nullptr;
+	other.mLastcluster = nullptr;
+	other.mClusterCount = 0u;
+	other.mAllocatedClusterCount = 0u;
+	other.mReservedClusterCount = 0u;
+	other.mIrregularClusters = false;
+	other.mExternalCluster = detail::external_cluster{};
+	DoTrimSpareClusters();
+}
+
+//Nothing to run for trivially destructible T, clusters can be released without being touched
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoDestroyElements(std::true_type)
+{
+}
+
+//Destroys every live element, leaving the cluster chain for the caller to reset
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoDestroyElements(std::false_type)
+{
+	if (!mClusterCount)
+	{
+		return;
+	}
+	//Walk the directory rather than the chain, every cluster but the last is full
+	cluster_type* const * clusters = mClusterDirectory;
+	for (cluster_type* const * e = clusters + mClusterCount - 1u; clusters != e; ++clusters)
+	{
+		detail::destroy_run((*clusters)->begin(), (*clusters)->begin() + (*clusters)->capacity());
+	}
+	detail::destroy_run(mLastcluster->begin(), mLastcluster->begin() + mLastcluster->mSize);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename InputIterator>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoAppend(InputIterator first, InputIterator last, std::input_iterator_tag)
+{
+	for (; first != last; ++first)
+	{
+		push_back(*first);
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+template <typename ForwardIterator>
+inline void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoAppend(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+{
+	size_type count = static_cast<size_type>(std::distance(first, last));
+	while (count)
+	{
+		size_type runLength;
+		T* run = DoAppendRun(count, runLength);
+		first = detail::uninitialized_copy_run(first, runLength, run);
+		count -= runLength;
+	}
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::cluster_type*
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoLocate(size_type index, size_type& offset) const
+{
+	cluster_type* cluster = mClusterDirectory[DoLocateClusterIndex(index)];
+	offset = index - cluster->mStartIndex;
+	return cluster;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoLocateClusterIndex(size_type index) const
+{
+	return CLUSTER_UNLIKELY(mIrregularClusters) ? DoLocateClusterIndex(index, std::false_type()) : DoLocateClusterIndex(index, std::integral_constant<bool, GrowthPolicy::kHasClusterIndex>());
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoLocateClusterIndex(size_type index, std::true_type) const
+{
+	return GrowthPolicy::cluster_index(mInitialClusterCapacity, index);
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoLocateClusterIndex(size_type index, std::false_type) const
+{
+	//Binary search the directory for the last cluster starting at or before the index
+	size_type low = 0u;
+	size_type high = mClusterCount - 1u;
+	while (low < high)
+	{
+		size_type mid = (low + high + 1u) / 2u;
+		if (mClusterDirectory[mid]->mStartIndex <= index)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1u;
+		}
+	}
+	return low;
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+inline typename cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::size_type
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoClusterCapacity(size_type clusterIndex) const
+{
+	//A first cluster starts a fresh chain, which always follows the growth policy
+	return GrowthPolicy::cluster_capacity(mInitialClusterCapacity, clusterIndex ? clusterIndex + mGrowthClusterOffset : 0u, sizeof(T), cluster_type::allocation_size(0u));
+}
+
+template <typename T,  typename Allocator, size_t tStepSize, typename GrowthPolicy>
+void
+cluster_vector<T, Allocator, tStepSize, GrowthPolicy>::DoGrowDirectory(size_type minCapacity)
+{
+	size_type newCapacity = mDirectoryCapacity ? mDirectoryCapacity * 2u : 8u;
+	while (newCapacity < minCapacity)
+	{
+		newCapacity *= 2u;
+	}
+
+	cluster_type** newDirectory = (cluster_type**)sw_allocate_memory(mAllocator, newCapacity * sizeof(cluster_type*), CLUSTER_ALIGN_OF(cluster_type*), 0);
+	if (mClusterDirectory)
+	{
+		for (size_type i = 0; i < mDirectoryCapacity; ++i)
+		{
+			newDirectory[i] = mClusterDirectory[i];
+		}
+		CLUSTERFree(mAllocator, mClusterDirectory, mDirectoryCapacity * sizeof(cluster_type*));
+	}
+	mClusterDirectory = newDirectory;
+	mDirectoryCapacity = newCapacity;
+}
+
+template<typename T>
+inline bool operator==(const cluster_vector_iterator<T>& a, const cluster_vector_iterator<T>& b)
+{
+	return a.mCurrent == b.mCurrent;
+}
+
+
+template<typename T>
+inline bool operator!=(const cluster_vector_iterator<T>& a, const cluster_vector_iterator<T>& b)
+{
+	return a.mCurrent != b.mCurrent;
+}
+
+template<typename T>
+inline bool operator==(const cluster_segment_iterator<T>& a, const cluster_segment_iterator<T>& b)
+{
+	return a.mCluster == b.mCluster;
+}
+
+template<typename T>
+inline bool operator!=(const cluster_segment_iterator<T>& a, const cluster_segment_iterator<T>& b)
+{
+	return a.mCluster != b.mCluster;
+}
+
+template<typename Container, typename T>
+inline cluster_vector_indexed_iterator<Container, T> operator+(typename cluster_vector_indexed_iterator<Container, T>::difference_type n, const cluster_vector_indexed_iterator<Container, T>& a)
+{
+	return a + n;
+}
+
+template<typename Container, typename T>
+inline bool operator==(const cluster_vector_indexed_iterator<Container, T>& a, const cluster_vector_indexed_iterator<Container, T>& b)
+{
+	return a.mIndex == b.mIndex;
+}
+
+template<typename Container, typename T>
+inline bool operator!=(const cluster_vector_indexed_iterator<Container, T>& a, const cluster_vector_indexed_iterator<Container, T>& b)
+{
+	return a.mIndex != b.mIndex;
+}
+
+template<typename Container, typename T>
+inline bool operator<(const cluster_vector_indexed_iterator<Container, T>& a, const cluster_vector_indexed_iterator<Container, T>& b)
+{
+	return a.mIndex < b.mIndex;
+}
+
+template<typename Container, typename T>
+inline bool operator>(const cluster_vector_indexed_iterator<Container, T>& a, const cluster_vector_indexed_iterator<Container, T>& b)
+{
+	return a.mIndex > b.mIndex;
+}
+
+template<typename Container, typename T>
+inline bool operator<=(const cluster_vector_indexed_iterator<Container, T>& a, const cluster_vector_indexed_iterator<Container, T>& b)
+{
+	return a.mIndex <= b.mIndex;
+}
+
+template<typename Container, typename T>
+inline bool operator>=(const cluster_vector_indexed_iterator<Container, T>& a, const cluster_vector_indexed_iterator<Container, T>& b)
+{
+	return a.mIndex >= b.mIndex;
+}
+
+}
+
@@ -0,0 +1,227 @@
+#include "../include/ClusterAlgorithm.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <list>
+#include <vector>
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+TEST(cluster_algorithm_test, segments_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		EXPECT_TRUE(vectorOfInt.segments().begin() == vectorOfInt.segments().end());
+
+		for (int i = 0; i < 30; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+
+		size_t segmentCount = 0u;
+		int expected = 0;
+		for (auto segment : vectorOfInt.segments())
+		{
+			EXPECT_EQ(segment.begin(), segment.mCluster->begin());
+			for (int* i = segment.begin(); i != segment.end(); ++i)
+			{
+				EXPECT_EQ(*i, expected++);
+			}
+			segmentCount++;
+		}
+		EXPECT_EQ(segmentCount, vectorOfInt.cluster_count());
+		EXPECT_EQ(expected, 30);
+	}
+
+	{
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, default_allocator> mapOfInt(4);
+		EXPECT_TRUE(mapOfInt.segments().begin() == mapOfInt.segments().end());
+
+		for (int i = 0; i < 30; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+		}
+		for (int i = 0; i < 10; i++)
+		{
+			mapOfInt.erase(handleVec[i]);
+		}
+
+		size_t total = 0u;
+		for (auto segment : mapOfInt.segments())
+		{
+			total += segment.size();
+		}
+		EXPECT_EQ(total, mapOfInt.size());
+	}
+}
+
+TEST(cluster_algorithm_test, vector_algorithm_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		vectorOfInt.resize(1000);
+
+		sw::fill(vectorOfInt, 2);
+		EXPECT_EQ(sw::accumulate(vectorOfInt, 0), 2000);
+
+		int next = 0;
+		sw::for_each(vectorOfInt, [&next](int& value) { value = next++; });
+		EXPECT_EQ(vectorOfInt[999], 999);
+		EXPECT_EQ(sw::accumulate(vectorOfInt, 0), 999 * 1000 / 2);
+		EXPECT_EQ(sw::accumulate(vectorOfInt, 1, [](int a, int b) { return b % 2 ? a : a + 1; }), 501);
+
+		EXPECT_EQ(sw::count_if(vectorOfInt, [](int value) { return value % 3 == 0; }), 334u);
+
+		auto found = sw::find(vectorOfInt, 700);
+		EXPECT_TRUE(found != vectorOfInt.end());
+		EXPECT_EQ(*found, 700);
+		EXPECT_EQ(*(++found), 701);
+		EXPECT_TRUE(sw::find(vectorOfInt, 1000) == vectorOfInt.end());
+		EXPECT_EQ(*sw::find_if(vectorOfInt, [](int value) { return value > 10; }), 11);
+
+		std::vector<int> copied(1000);
+		sw::copy(vectorOfInt, copied.data());
+		std::vector<int> doubled;
+		sw::transform(vectorOfInt, std::back_inserter(doubled), [](int value) { return value * 2; });
+		for (int i = 0; i < 1000; i++)
+		{
+			EXPECT_EQ(copied[i], i);
+			EXPECT_EQ(doubled[i], i * 2);
+		}
+
+		sw::cluster_vector<int, default_allocator> const & constVector = vectorOfInt;
+		sw::cluster_vector<int, default_allocator>::const_iterator constFound = sw::find(constVector, 5);
+		EXPECT_EQ(*constFound, 5);
+	}
+}
+
+TEST(cluster_algorithm_test, sorted_range_test)
+{
+	sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+	for (int i = 0; i < 1000; i++)
+	{
+		vectorOfInt.push_back(i / 3);
+	}
+
+	auto lower = sw::lower_bound(vectorOfInt, 100);
+	EXPECT_EQ(*lower, 100);
+	EXPECT_EQ(std::distance(vectorOfInt.begin(), lower), 300);
+	auto range = sw::equal_range(vectorOfInt, 100);
+	EXPECT_EQ(std::distance(range.first, range.second), 3);
+	EXPECT_EQ(*range.second, 101);
+
+	//Values on cluster boundaries, before the front and past the back
+	for (int value = 0; value < 334; value++)
+	{
+		auto i = sw::lower_bound(vectorOfInt, value);
+		EXPECT_EQ(std::distance(vectorOfInt.begin(), i), value * 3);
+	}
+	EXPECT_TRUE(sw::lower_bound(vectorOfInt, -1) == vectorOfInt.begin());
+	EXPECT_TRUE(sw::lower_bound(vectorOfInt, 334) == vectorOfInt.end());
+	EXPECT_TRUE(sw::upper_bound(vectorOfInt, 333) == vectorOfInt.end());
+	EXPECT_EQ(*sw::upper_bound(vectorOfInt, 332, std::less<int>()), 333);
+
+	for (int value = 0; value < 334; value++)
+	{
+		auto equal = sw::equal_range(vectorOfInt, value);
+		EXPECT_EQ(std::distance(vectorOfInt.begin(), equal.first), value * 3);
+		EXPECT_EQ(std::distance(vectorOfInt.begin(), equal.second), value < 333 ? value * 3 + 3 : 1000);
+	}
+
+	//Equally sized clusters, a range spanning several of them
+	sw::cluster_vector<int, default_allocator, 2u, sw::fixed_growth> fixed(8);
+	for (int i = 0; i < 1000; i++)
+	{
+		fixed.push_back(i / 50);
+	}
+	auto spanning = sw::equal_range(fixed, 7);
+	EXPECT_EQ(std::distance(fixed.begin(), spanning.first), 350);
+	EXPECT_EQ(std::distance(fixed.begin(), spanning.second), 400);
+	EXPECT_EQ(std::distance(fixed.begin(), sw::upper_bound(fixed, 19)), 1000);
+
+	//Elements are compared against the value as they are, not converted to the value's type
+	sw::cluster_vector<double, default_allocator> halves(8);
+	for (int i = 0; i < 100; i++)
+	{
+		halves.push_back(i + 0.5);
+	}
+	EXPECT_EQ(*sw::lower_bound(halves, 3), 3.5);
+	EXPECT_EQ(*sw::upper_bound(halves, 3), 3.5);
+	auto halvesRange = sw::equal_range(halves, 3);
+	EXPECT_TRUE(halvesRange.first == halvesRange.second);
+
+	//A sorted map, with free dense slots past its last element
+	std::vector<sw::cluster_map_handle<int>> handleVec{};
+	sw::cluster_map<int, default_allocator> mapOfInt(4);
+	for (int i = 0; i < 300; i++)
+	{
+		handleVec.push_back(mapOfInt.insert(i * 2));
+	}
+	for (int i = 299; i >= 200; i--)
+	{
+		mapOfInt.erase(handleVec[i]);
+	}
+	EXPECT_EQ(*sw::lower_bound(mapOfInt, 101), 102);
+	EXPECT_EQ(*sw::upper_bound(mapOfInt, 102), 104);
+	EXPECT_TRUE(sw::lower_bound(mapOfInt, 399) == mapOfInt.end());
+	auto mapRange = sw::equal_range(mapOfInt, 398);
+	EXPECT_EQ(*mapRange.first, 398);
+	EXPECT_TRUE(mapRange.second == mapOfInt.end());
+
+	sw::cluster_vector<int, default_allocator> empty(4);
+	EXPECT_TRUE(sw::lower_bound(empty, 1) == empty.end());
+	EXPECT_TRUE(sw::equal_range(empty, 1).first == empty.end());
+
+	sw::cluster_vector<int, default_allocator> shuffled(4);
+	for (int i = 0; i < 500; i++)
+	{
+		shuffled.push_back((i * 7919) % 500);
+	}
+	sw::nth_element(shuffled, 250);
+	EXPECT_EQ(shuffled[250], 250);
+	for (int i = 0; i < 250; i++)
+	{
+		EXPECT_LT(shuffled[i], 250);
+	}
+	sw::nth_element(shuffled, 10, std::greater<int>());
+	EXPECT_EQ(shuffled[10], 489);
+}
+
+TEST(cluster_algorithm_test, map_algorithm_test)
+{
+	{
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, default_allocator> mapOfInt(4);
+		for (int i = 0; i < 100; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+		}
+		for (int i = 0; i < 100; i += 2)
+		{
+			mapOfInt.erase(handleVec[i]);
+		}
+
+		EXPECT_EQ(sw::accumulate(mapOfInt, 0), 2500);
+		EXPECT_EQ(sw::count_if(mapOfInt, [](int value) { return value % 2 == 0; }), 0u);
+
+		sw::for_each(mapOfInt, [](int& value) { value += 1; });
+		EXPECT_EQ(sw::at(handleVec[1]), 2);
+
+		auto found = sw::find(mapOfInt, 52);
+		EXPECT_TRUE(found != mapOfInt.end());
+		EXPECT_EQ(*found, 52);
+		EXPECT_TRUE(sw::find(mapOfInt, 51) == mapOfInt.end());
+
+		sw::fill(mapOfInt, 7);
+		EXPECT_EQ(sw::at(handleVec[99]), 7);
+
+		std::vector<int> copied;
+		sw::copy(mapOfInt, std::back_inserter(copied));
+		EXPECT_EQ(copied.size(), 50u);
+	}
+}
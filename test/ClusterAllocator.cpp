@@ -0,0 +1,149 @@
+#include "../include/ClusterAllocator.h"
+#include "../include/ClusterVector.h"
+#include "../include/ClusterMap.h"
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+TEST(cluster_allocator_test, huge_page_allocator_test)
+{
+	{
+		sw::huge_page_allocator allocator;
+		void* small = allocator.allocate(64u);
+		void* alignedSmall = allocator.allocate(256u, 64u, 0u);
+		EXPECT_TRUE(small != nullptr);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(alignedSmall) % 64u, 0u);
+
+		//Large requests are mapped on a huge page boundary where supported
+		size_t const largeSize = sw::huge_page_allocator::kHugePageSize + 100u;
+		char* large = static_cast<char*>(allocator.allocate(largeSize, 64u, 0u));
+		ASSERT_TRUE(large != nullptr);
+#if CLUSTER_HUGE_PAGES_ENABLED
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % sw::huge_page_allocator::kHugePageSize, 0u);
+#endif
+		large[0] = 1;
+		large[largeSize - 1u] = 2;
+		EXPECT_EQ(large[0] + large[largeSize - 1u], 3);
+
+		allocator.deallocate(large, largeSize);
+		allocator.deallocate(alignedSmall, 256u);
+		allocator.deallocate(small, 64u);
+	}
+
+	{
+		//A small threshold sends the larger clusters through the mapping path
+		sw::huge_page_allocator allocator(64u * 1024u);
+		sw::cluster_vector<int, sw::huge_page_allocator> vectorOfInt(16u, allocator);
+		for (int i = 0; i < 1000000; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		long long total = 0;
+		for (int value : vectorOfInt)
+		{
+			total += value;
+		}
+		EXPECT_EQ(total, 999999ll * 1000000ll / 2ll);
+		vectorOfInt.compact();
+		EXPECT_EQ(vectorOfInt[123456], 123456);
+	}
+
+	{
+		//NUMA policies degrade to default placement when there is only one node or no NUMA support
+		sw::huge_page_allocator interleaved(64u * 1024u, sw::numa_policy::interleave);
+		sw::huge_page_allocator bound(64u * 1024u, sw::numa_policy::bind, 0);
+		sw::huge_page_allocator missingNode(64u * 1024u, sw::numa_policy::bind, 4000);
+		sw::cluster_map<double, sw::huge_page_allocator> mapOfDouble(1024u, interleaved);
+		sw::cluster_vector<double, sw::huge_page_allocator> boundVector(1024u, bound);
+		sw::cluster_vector<double, sw::huge_page_allocator> missingNodeVector(1024u, missingNode);
+		for (int i = 0; i < 100000; i++)
+		{
+			mapOfDouble.insert(double(i));
+			boundVector.push_back(double(i));
+			missingNodeVector.push_back(double(i));
+		}
+		EXPECT_EQ(mapOfDouble.size(), 100000u);
+		EXPECT_EQ(boundVector[99999], 99999.0);
+		EXPECT_EQ(missingNodeVector[50000], 50000.0);
+	}
+}
+
+TEST(cluster_allocator_test, arena_allocator_test)
+{
+	{
+		sw::monotonic_arena arena(1024u);
+		void* first = arena.allocate(100u);
+		void* aligned = arena.allocate(10u, 64u);
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64u, 0u);
+		EXPECT_GE(arena.bytes_used(), 110u);
+
+		//Requests larger than a block get a block of their own
+		char* large = static_cast<char*>(arena.allocate(10000u));
+		large[9999] = 1;
+		EXPECT_GE(arena.bytes_reserved(), 11024u);
+
+		//Reset reuses the same memory from the start
+		size_t reserved = arena.bytes_reserved();
+		arena.reset();
+		EXPECT_EQ(arena.bytes_used(), 0u);
+		EXPECT_TRUE(arena.allocate(100u) == first);
+		arena.allocate(10000u);
+		EXPECT_EQ(arena.bytes_reserved(), reserved);
+
+#if CLUSTER_EXCEPTIONS_ENABLED
+		//A request no block could hold throws rather than wrapping the block size
+		EXPECT_THROW(arena.allocate(SIZE_MAX - 16u), std::bad_alloc);
+		EXPECT_EQ(arena.bytes_reserved(), reserved);
+#endif
+	}
+
+	{
+		sw::monotonic_arena arena(4096u);
+		for (int frame = 0; frame < 4; frame++)
+		{
+			{
+				sw::cluster_vector<int, sw::arena_allocator> vectorOfInt(8u, sw::arena_allocator(arena));
+				sw::cluster_map<int, sw::arena_allocator> mapOfInt(8u, sw::arena_allocator(arena));
+				for (int i = 0; i < 5000; i++)
+				{
+					vectorOfInt.push_back(i + frame);
+					mapOfInt.insert(i);
+				}
+				EXPECT_EQ(vectorOfInt[4999], 4999 + frame);
+				EXPECT_EQ(mapOfInt.size(), 5000u);
+			}
+			arena.reset();
+		}
+	}
+
+	{
+		//Scopes rewind in stack order, and a caller buffer serves the first allocations
+		alignas(16) char buffer[2048];
+		sw::monotonic_arena arena(buffer, sizeof(buffer));
+		void* outer = arena.allocate(64u);
+		EXPECT_TRUE(outer >= static_cast<void*>(buffer) && outer < static_cast<void*>(buffer + sizeof(buffer)));
+		sw::monotonic_arena::marker outerMark = arena.mark();
+		{
+			sw::arena_scope request(arena);
+			sw::cluster_vector<double, sw::arena_allocator> vectorOfDouble(4u, sw::arena_allocator(arena));
+			for (int i = 0; i < 1000; i++)
+			{
+				vectorOfDouble.push_back(double(i));
+			}
+			EXPECT_EQ(vectorOfDouble[999], 999.0);
+			{
+				sw::arena_scope inner(arena);
+				arena.allocate(512u);
+			}
+		}
+		EXPECT_EQ(arena.mark().mCurrent, outerMark.mCurrent);
+		arena.release();
+		EXPECT_EQ(arena.bytes_used(), 0u);
+		EXPECT_TRUE(arena.allocate(16u) >= static_cast<void*>(buffer));
+	}
+}
@@ -0,0 +1,277 @@
+#include "../include/ClusterCompactMap.h"
+#include "../include/ClusterAlgorithm.h"
+#include "../include/ClusterSimd.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+TEST(compact_cluster_map_test, key_test)
+{
+	EXPECT_EQ(sizeof(sw::compact_cluster_map_slot), 8u);
+
+	sw::compact_cluster_map<int, default_allocator> mapOfInt(4);
+	EXPECT_TRUE(mapOfInt.empty());
+	EXPECT_TRUE(mapOfInt.begin() == mapOfInt.end());
+	EXPECT_FALSE(mapOfInt.contains(sw::cluster_map_key{}));
+
+	std::vector<sw::cluster_map_key> keys;
+	for (int i = 0; i < 1000; i++)
+	{
+		keys.push_back(mapOfInt.insert(i));
+	}
+	for (int i = 0; i < 1000; i += 4)
+	{
+		EXPECT_TRUE(mapOfInt.erase(keys[i]));
+		EXPECT_FALSE(mapOfInt.erase(keys[i]));
+	}
+	EXPECT_EQ(mapOfInt.size(), 750u);
+	EXPECT_EQ(mapOfInt.sparse_indices().size(), 1000u);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		EXPECT_EQ(mapOfInt.contains(keys[i]), i % 4 != 0);
+		if (i % 4)
+		{
+			EXPECT_EQ(*mapOfInt.find(keys[i]), i);
+		}
+		else
+		{
+			EXPECT_TRUE(mapOfInt.find(keys[i]) == nullptr);
+		}
+	}
+
+	//Freed slots are reused, with a new generation so the old keys stay dead
+	std::vector<sw::cluster_map_key> reused;
+	for (int i = 0; i < 250; i++)
+	{
+		reused.push_back(mapOfInt.insert(2000 + i));
+	}
+	EXPECT_EQ(mapOfInt.sparse_indices().size(), 1000u);
+	for (int i = 0; i < 250; i++)
+	{
+		EXPECT_EQ(*mapOfInt.find(reused[i]), 2000 + i);
+		EXPECT_EQ(reused[i].mSlot % 4, 0u);
+	}
+	for (int i = 0; i < 1000; i += 4)
+	{
+		EXPECT_FALSE(mapOfInt.contains(keys[i]));
+	}
+
+	//Every live element is visited once, and key_of leads back to it
+	std::vector<int> seen(2250, 0);
+	for (auto i = mapOfInt.begin(); i != mapOfInt.end(); ++i)
+	{
+		seen[*i]++;
+		EXPECT_EQ(mapOfInt.find(mapOfInt.key_of(i)), &*i);
+	}
+	for (int i = 0; i < 2250; i++)
+	{
+		EXPECT_EQ(seen[i], (i < 1000 && i % 4) || (i >= 2000) ? 1 : 0);
+	}
+
+	//Erasing through an iterator
+	while (!mapOfInt.empty())
+	{
+		mapOfInt.erase(mapOfInt.begin());
+	}
+	EXPECT_TRUE(mapOfInt.begin() == mapOfInt.end());
+	for (int i = 1; i < 1000; i += 4)
+	{
+		EXPECT_FALSE(mapOfInt.contains(keys[i]));
+	}
+
+	//Keys from before a clear never match the slots that replace them
+	mapOfInt.clear();
+	sw::cluster_map_key first = mapOfInt.insert(1);
+	mapOfInt.clear();
+	sw::cluster_map_key second = mapOfInt.insert(2);
+	EXPECT_EQ(first.mSlot, second.mSlot);
+	EXPECT_FALSE(mapOfInt.contains(first));
+	EXPECT_EQ(*mapOfInt.find(second), 2);
+}
+
+TEST(compact_cluster_map_test, non_trivial_test)
+{
+	std::vector<sw::cluster_map_key> keys;
+	sw::compact_cluster_map<std::unique_ptr<std::string>, default_allocator> mapOfString(4);
+	for (int i = 0; i < 200; i++)
+	{
+		keys.push_back(mapOfString.insert(new std::string(std::to_string(i))));
+	}
+	for (int i = 0; i < 200; i += 3)
+	{
+		mapOfString.erase(keys[i]);
+	}
+	for (int i = 1; i < 200; i += 3)
+	{
+		EXPECT_EQ(**mapOfString.find(keys[i]), std::to_string(i));
+	}
+
+	sw::compact_cluster_map<std::unique_ptr<std::string>, default_allocator> moved(std::move(mapOfString));
+	EXPECT_TRUE(mapOfString.empty());
+	EXPECT_EQ(moved.size(), 133u);
+	EXPECT_EQ(**moved.find(keys[199]), "199");
+
+	mapOfString.swap(moved);
+	EXPECT_EQ(**mapOfString.find(keys[199]), "199");
+	EXPECT_TRUE(moved.empty());
+}
+
+TEST(compact_cluster_map_test, segments_test)
+{
+	std::vector<sw::cluster_map_key> keys;
+	sw::compact_cluster_map<float, default_allocator> mapOfFloat(4);
+	EXPECT_TRUE(mapOfFloat.segments().begin() == mapOfFloat.segments().end());
+
+	for (int i = 0; i < 300; i++)
+	{
+		keys.push_back(mapOfFloat.insert(float(i)));
+	}
+	for (int i = 0; i < 300; i += 2)
+	{
+		mapOfFloat.erase(keys[i]);
+	}
+
+	//Each segment is a plain span of the elements, with the slot indices held apart
+	size_t total = 0u;
+	for (auto segment : mapOfFloat.segments())
+	{
+		EXPECT_FALSE(segment.empty());
+		for (float* i = segment.begin(); i != segment.end(); ++i)
+		{
+			*i *= 2.0f;
+		}
+		total += segment.size();
+	}
+	EXPECT_EQ(total, mapOfFloat.size());
+	EXPECT_EQ(*mapOfFloat.find(keys[299]), 598.0f);
+
+	//Odd values 1 to 299, doubled
+	EXPECT_EQ(sw::simd_sum(mapOfFloat), 45000.0f);
+	EXPECT_EQ(sw::accumulate(mapOfFloat, 0.0f), 45000.0f);
+	auto found = sw::find(mapOfFloat, 42.0f);
+	EXPECT_EQ(*found, 42.0f);
+	EXPECT_EQ(mapOfFloat.key_of(found), keys[21]);
+	EXPECT_TRUE(sw::find(mapOfFloat, 40.0f) == mapOfFloat.end());
+
+	sw::compact_cluster_map<float, default_allocator> const & constMap = mapOfFloat;
+	float constTotal = 0.0f;
+	for (auto segment : constMap.segments())
+	{
+		for (float value : segment)
+		{
+			constTotal += value;
+		}
+	}
+	EXPECT_EQ(constTotal, 45000.0f);
+	EXPECT_EQ(*constMap.begin(), *mapOfFloat.begin());
+}
+
+//Fills a map of each kind with count ints, erases every eighth so both carry free slots and returns the bytes each holds
+template <typename Map, typename Handle, typename Insert>
+size_t churned_footprint(Map& map, std::vector<Handle>& handles, int count, Insert insert)
+{
+	size_t const before = byte_counting_allocator::sLiveBytes;
+	for (int i = 0; i < count; i++)
+	{
+		handles.push_back(insert(map, i));
+	}
+	for (int i = 0; i < count; i += 8)
+	{
+		map.erase(handles[i]);
+	}
+	return byte_counting_allocator::sLiveBytes - before;
+}
+
+//The baseline is cluster_map as it stands, whose sparse slots hold the element pointer beside its dense position and key
+//generation, so they are 16 bytes rather than the 8 of the original pointer-only slots
+TEST(compact_cluster_map_test, footprint_test)
+{
+	const int count = 4096;
+	std::vector<sw::cluster_map_handle<int>> handles;
+	sw::cluster_map<int, byte_counting_allocator> mapOfInt(64);
+	size_t const mapBytes = churned_footprint(mapOfInt, handles, count, [](sw::cluster_map<int, byte_counting_allocator>& map, int i) { return map.insert(i); });
+
+	std::vector<sw::cluster_map_key> keys;
+	sw::compact_cluster_map<int, byte_counting_allocator> compactOfInt(64);
+	size_t const compactBytes = churned_footprint(compactOfInt, keys, count, [](sw::compact_cluster_map<int, byte_counting_allocator>& map, int i) { return map.insert(i); });
+
+	//4 + 4 bytes per dense element and 8 per slot, against 4 + 4 per dense element, 16 per slot and 8 per free list entry
+	EXPECT_LT(compactBytes * 4u, mapBytes * 3u);
+}
+
+//Footprint and iteration speed of the 32-bit links against cluster_map's pointers. Disabled as it takes a while and only
+//prints its timings, run it with --gtest_also_run_disabled_tests on a release build to compare them.
+TEST(compact_cluster_map_test, DISABLED_footprint_benchmark)
+{
+	const int count = 1000000;
+	using clock = std::chrono::steady_clock;
+
+	size_t mapBytes = 0u;
+	size_t compactBytes = 0u;
+	double mapNs = 0.0;
+	double compactNs = 0.0;
+	double segmentNs = 0.0;
+	long long mapSum = 0;
+	long long compactSum = 0;
+	long long segmentSum = 0;
+	{
+		std::vector<sw::cluster_map_handle<int>> handles;
+		sw::cluster_map<int, byte_counting_allocator> mapOfInt(64);
+		mapBytes = churned_footprint(mapOfInt, handles, count, [](sw::cluster_map<int, byte_counting_allocator>& map, int i) { return map.insert(i); });
+
+		clock::time_point start = clock::now();
+		for (int pass = 0; pass < 10; pass++)
+		{
+			for (int value : mapOfInt)
+			{
+				mapSum += value;
+			}
+		}
+		mapNs = std::chrono::duration<double, std::nano>(clock::now() - start).count() / (10.0 * mapOfInt.size());
+	}
+	{
+		std::vector<sw::cluster_map_key> keys;
+		sw::compact_cluster_map<int, byte_counting_allocator> mapOfInt(64);
+		compactBytes = churned_footprint(mapOfInt, keys, count, [](sw::compact_cluster_map<int, byte_counting_allocator>& map, int i) { return map.insert(i); });
+
+		clock::time_point start = clock::now();
+		for (int pass = 0; pass < 10; pass++)
+		{
+			for (int value : mapOfInt)
+			{
+				compactSum += value;
+			}
+		}
+		compactNs = std::chrono::duration<double, std::nano>(clock::now() - start).count() / (10.0 * mapOfInt.size());
+
+		//The same sweep over the contiguous spans, which the compiler can vectorise
+		start = clock::now();
+		for (int pass = 0; pass < 10; pass++)
+		{
+			for (auto segment : mapOfInt.segments())
+			{
+				for (int value : segment)
+				{
+					segmentSum += value;
+				}
+			}
+		}
+		segmentNs = std::chrono::duration<double, std::nano>(clock::now() - start).count() / (10.0 * mapOfInt.size());
+	}
+
+	EXPECT_EQ(mapSum, compactSum);
+	EXPECT_EQ(mapSum, segmentSum);
+	printf("cluster_map<int> (16-byte sparse slots):  %.2f bytes/element, %.3f ns/element iterated\n", double(mapBytes) / count, mapNs);
+	printf("compact_cluster_map<int> (8-byte slots): %.2f bytes/element, %.3f ns/element iterated, %.3f ns/element by segment\n", double(compactBytes) / count, compactNs, segmentNs);
+}
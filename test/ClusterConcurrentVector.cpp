@@ -0,0 +1,112 @@
+#include "../include/ClusterConcurrentVector.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+TEST(concurrent_cluster_vector_test, single_thread_test)
+{
+	sw::concurrent_cluster_vector<int, default_allocator> vectorOfInt(4);
+	EXPECT_TRUE(vectorOfInt.empty());
+	EXPECT_EQ(vectorOfInt.begin(), vectorOfInt.end());
+
+	std::vector<int*> addresses;
+	for (int i = 0; i < 1000; ++i)
+	{
+		addresses.push_back(&vectorOfInt.push_back(i));
+	}
+
+	EXPECT_EQ(vectorOfInt.size(), 1000u);
+	EXPECT_EQ(vectorOfInt.cluster_count(), 8u);
+	for (int i = 0; i < 1000; ++i)
+	{
+		EXPECT_EQ(vectorOfInt[i], i);
+		EXPECT_EQ(&vectorOfInt[i], addresses[i]);
+	}
+
+	int expected = 0;
+	for (int value : vectorOfInt)
+	{
+		EXPECT_EQ(value, expected++);
+	}
+	EXPECT_EQ(expected, 1000);
+
+	vectorOfInt.clear();
+	EXPECT_TRUE(vectorOfInt.empty());
+	EXPECT_EQ(vectorOfInt.cluster_count(), 0u);
+
+	vectorOfInt.emplace_back(7);
+	EXPECT_EQ(vectorOfInt[0], 7);
+}
+
+TEST(concurrent_cluster_vector_test, multi_producer_test)
+{
+	{
+		size_t const kThreadCount = 8u;
+		size_t const kPerThread = 20000u;
+
+		//A small first cluster and fixed growth make threads race for many cluster links
+		sw::concurrent_cluster_vector<size_t, default_allocator, 2, sw::fixed_growth> vectorOfSize(16);
+
+		std::vector<std::thread> threads;
+		for (size_t t = 0u; t < kThreadCount; ++t)
+		{
+			threads.emplace_back([&vectorOfSize, t, kPerThread]()
+			{
+				for (size_t i = 0u; i < kPerThread; ++i)
+				{
+					size_t& element = vectorOfSize.push_back(t * kPerThread + i);
+					EXPECT_EQ(element, t * kPerThread + i);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		EXPECT_EQ(vectorOfSize.size(), kThreadCount * kPerThread);
+		EXPECT_EQ(vectorOfSize.cluster_count(), kThreadCount * kPerThread / 16u);
+
+		std::vector<size_t> values(vectorOfSize.begin(), vectorOfSize.end());
+		ASSERT_EQ(values.size(), kThreadCount * kPerThread);
+		std::sort(values.begin(), values.end());
+		for (size_t i = 0u; i < values.size(); ++i)
+		{
+			EXPECT_EQ(values[i], i);
+		}
+	}
+
+	{
+		//Non-trivial elements are constructed in place and destroyed with the container
+		std::shared_ptr<int> shared = std::make_shared<int>(3);
+		{
+			sw::concurrent_cluster_vector<std::shared_ptr<int>, default_allocator> vectorOfShared(8);
+			std::vector<std::thread> threads;
+			for (size_t t = 0u; t < 4u; ++t)
+			{
+				threads.emplace_back([&vectorOfShared, &shared]()
+				{
+					for (size_t i = 0u; i < 500u; ++i)
+					{
+						vectorOfShared.emplace_back(shared);
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+			EXPECT_EQ(shared.use_count(), 2001);
+		}
+		EXPECT_EQ(shared.use_count(), 1);
+	}
+}
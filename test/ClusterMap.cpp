@@ -1,414 +1,998 @@
-#include "../include/ClusterMap.h"
-#include <gtest/gtest.h>
-
-#include <list>
-#include <stdio.h>
-
-class default_allocator
-{
-public:
-
-	void* allocate(size_t n)
-	{
-		return _aligned_malloc(n, 8);
-	}
-
-	void* allocate(size_t n, size_t alignment, size_t alignmentOffset)
-	{
-		if ((alignmentOffset % alignment) == 0)
-		{
-			return _aligned_malloc(n, alignment);
-		}
-
-		return NULL;
-	}
-
-	void deallocate(void* p, size_t n)
-	{
-		_aligned_free(p);
-	}
-};
-
-int main(int argc, char **argv) {
-	::testing::InitGoogleTest(&argc, argv);
-	return RUN_ALL_TESTS();
-}
-
-template < typename T>
-void print_cluster(sw::cluster<T> const& p_cluster)
-{
-	std::cout << "	Capacity " << p_cluster.capacity() << " : Length " << p_cluster.size() << " : ["; 
-	for (auto & i : p_cluster)
-	{
-		std::cout << i << ", ";
-	}
-	std::cout << "]";
-}
-
-template < typename T, typename A >
-void print_cluster_vector(sw::cluster_vector<T, A> const& p_cluster_vec)
-{
-	auto* cluster = p_cluster_vec.first_cluster();
-	if (!cluster)
-	{
-		std::cout << "{}" << std::endl;
-		return;
-	}
-	std::cout << "{" << std::endl;
-	print_cluster(*cluster);
-	std::cout << std::endl;
-
-	while(!cluster->is_last_cluster())
-	{
-		cluster = cluster->next_cluster();
-		print_cluster(*cluster);
-		std::cout << std::endl;
-	}
-
-	std::cout << "}" << std::endl;
-}
-
-template < typename T>
-void print_dense_cluster(sw::cluster<sw::cluster_map_dense_storage<T>> const& p_cluster)
-{
-	std::cout << "	Capacity " << p_cluster.capacity() << " : Length " << p_cluster.size() << " : ["; 
-	for (auto & i : p_cluster)
-	{
-		std::cout << *reinterpret_cast<T*>(i.mData.mCharData) << ", ";
-	}
-	std::cout << "]";
-}
-
-template < typename T, typename A >
-void print_dense_cluster_vector(sw::cluster_vector<T, A> const& p_cluster_vec)
-{
-	auto* cluster = p_cluster_vec.first_cluster();
-	if (!cluster)
-	{
-		std::cout << "{}" << std::endl;
-		return;
-	}
-	std::cout << "{" << std::endl;
-	print_dense_cluster(*cluster);
-	std::cout << std::endl;
-
-	while(!cluster->is_last_cluster())
-	{
-		cluster = cluster->next_cluster();
-		print_dense_cluster(*cluster);
-		std::cout << std::endl;
-	}
-
-	std::cout << "}" << std::endl;
-}
-
-template < typename T, typename A >
-void print_cluster_map(sw::cluster_map<T, A> const& p_cluster_map)
-{
-	std::cout << "{" << std::endl;
-	std::cout << "dense_storage : ";
-	print_dense_cluster_vector(p_cluster_map.dense_storage());
-
-	std::cout << "sparse_indices : ";
-	print_cluster_vector(p_cluster_map.sparse_indices());
-
-	std::cout << "unoccupied_list : ";
-	print_cluster_vector(p_cluster_map.unoccupied_list());
-	std::cout << "}" << std::endl;
-}
-
-TEST(cluster_map_test, push_back_test)
-{
-	{
-		using handle_type = sw::cluster_map<int, default_allocator>::handle_type;
-		sw::cluster_map<int, default_allocator> sv(8);
-		handle_type first = sv.insert(0);
-		handle_type second = sv.insert(1);
-		handle_type third = sv.insert(2);
-		handle_type fourth = sv.insert(3);
-
-		{
-			auto i = sv.begin();
-			EXPECT_EQ(*i  , 0);
-			EXPECT_EQ(*i++ , 0);
-			EXPECT_EQ(*i++ , 1);
-			EXPECT_EQ(*i++ , 2);
-			EXPECT_EQ(*i++ , 3);
-		}
-
-		{
-			auto i = sv.begin();
-			EXPECT_EQ(*i , 0);
-			EXPECT_EQ(*(++i) , 1);
-			EXPECT_EQ(*(++i) , 2);
-			EXPECT_EQ(*(++i) , 3);
-		}
-
-		{
-			auto i = sv.begin();
-			EXPECT_EQ(sw::at(first) , 0);
-			EXPECT_EQ(sw::at(second), 1);
-			EXPECT_EQ(sw::at(third), 2);
-			EXPECT_EQ(sw::at(fourth), 3);
-		}
-	}
-}
-
-
-TEST(cluster_map_test, empty_test)
-{
-	{
-		sw::cluster_map<int, default_allocator> mapOfInt(8);
-		sw::cluster_map<std::list<int>, default_allocator> mapOfListOfTO(8);
-		EXPECT_TRUE(mapOfInt.empty());
-		EXPECT_TRUE(mapOfListOfTO.empty());
-	}
-}
-
-TEST(cluster_map_test, foreach_test)
-{
-	{
-		std::vector<int> initValues{};
-		uint32_t const numValues = 1024u;
-		initValues.reserve(numValues);
-		for (int i = 0; i < numValues; i++)
-		{
-			initValues.push_back(i);
-		}
-
-		std::vector<sw::cluster_map_handle<int>> handleVec{};
-		sw::cluster_map<int, default_allocator> mapOfInt(4);
-		EXPECT_EQ(mapOfInt.size(), 0);
-		EXPECT_EQ(mapOfInt.empty() , true);
-		for (int i : initValues)
-		{
-			handleVec.push_back(mapOfInt.insert(i));
-		}
-
-		EXPECT_EQ(mapOfInt.size() , numValues);
-		EXPECT_EQ(mapOfInt.empty() , false);
-
-		int j = 0;
-		for (int i : mapOfInt)
-		{
-			EXPECT_EQ(i, initValues[j]);
-			j++;
-		}
-
-
-		for (int l = 0; l < numValues; l++)
-		{
-			int k = 0;
-			for (auto i : handleVec)
-			{
-				int lhs = sw::at(i);
-				int rhs = initValues[l+k];
-				EXPECT_EQ(sw::at(i), initValues[l+k]);
-				k++;
-			}
-			mapOfInt.erase(handleVec.at(0));
-			handleVec.erase(handleVec.begin());
-		}	
-	}
-}
-
-// Thanks to MarioTalevski for his simple GoL implementation
-// https://github.com/MarioTalevski/game-of-life/blob/master/GameOfLife.cpp
-constexpr size_t c_gridBounds = 26u;
-constexpr size_t c_gridSize = 25u;
-
-void copyGrid(
-	bool(&rhs)[c_gridBounds][c_gridBounds],
-	bool(&lhs)[c_gridBounds][c_gridBounds]
-)
-{
-	memcpy(lhs, rhs, sizeof(bool) * c_gridBounds * c_gridBounds);
-}
-
-void advanceConwayRegular(bool(&gridOne)[c_gridBounds][c_gridBounds])
-{
-	bool gridTwo[c_gridBounds][c_gridBounds] = {};
-	copyGrid(gridOne, gridTwo);
-
-	for(int a = 1; a < c_gridSize; a++)
-	{
-		for(int b = 1; b < c_gridSize; b++)
-		{
-			int alive = 0;
-			for(int c = -1; c < 2; c++)
-			{
-				for(int d = -1; d < 2; d++)
-				{
-					if(!(c == 0 && d == 0))
-					{
-						if(gridTwo[a+c][b+d])
-						{
-							++alive;
-						}
-					}
-				}
-			}
-			if(alive < 2)
-			{
-				gridOne[a][b] = false;
-			}
-			else if(alive == 3)
-			{
-				gridOne[a][b] = true;
-			}
-			else if(alive > 3)
-			{
-				gridOne[a][b] = false;
-			}
-		}
-	}
-}
-
-void copyClusterGrid(
-	sw::cluster_map<bool, default_allocator>& rhsGrid,
-	sw::cluster_map_handle<bool>(&rhsHandles)[c_gridBounds][c_gridBounds],
-	sw::cluster_map<bool, default_allocator>& lhsGrid,
-	sw::cluster_map_handle<bool>(&lhsHandles)[c_gridBounds][c_gridBounds]
-)
-{
-	for(int a =0; a < c_gridSize; a++)
-	{
-		for(int b = 0; b < c_gridSize; b++)
-		{
-			if(rhsHandles[a][b].mSparseIndexPtr)
-			{
-				lhsHandles[a][b] = lhsGrid.insert(true);
-			}
-		}
-	}
-}
-
-void advanceConwayCluster(
-	sw::cluster_map<bool, default_allocator>& gridOne,
-	sw::cluster_map_handle<bool> (&gridOneHandles)[c_gridBounds][c_gridBounds]
-	)
-{
-	sw::cluster_map<bool, default_allocator> gridTwo(4);
-	sw::cluster_map_handle<bool> gridTwoHandles[c_gridBounds][c_gridBounds]{};
-	copyClusterGrid(gridOne, gridOneHandles, gridTwo, gridTwoHandles);
-
-	for(int a = 1; a < c_gridSize; a++)
-	{
-		for(int b = 1; b < c_gridSize; b++)
-		{
-			int alive = 0;
-			for(int c = -1; c < 2; c++)
-			{
-				for(int d = -1; d < 2; d++)
-				{
-					if(!(c == 0 && d == 0))
-					{
-						if(gridTwoHandles[a+c][b+d].mElementPtr && sw::at(gridTwoHandles[a+c][b+d]))
-						{
-							++alive;
-						}
-					}
-				}
-			}
-			if(alive == 3)
-			{
-				if(!gridOneHandles[a][b].mElementPtr)
-				{
-					gridOneHandles[a][b] = gridOne.insert(true);
-				}
-			}
-			else if (alive < 2 || alive > 3)
-			{
-				if(gridOneHandles[a][b].mElementPtr)
-				{
-					gridOne.erase(gridOneHandles[a][b]);
-					gridOneHandles[a][b] = {};
-				}
-			}
-		}
-	}
-}
-
-void compareMethods(
-	bool gridOne[c_gridBounds][c_gridBounds],
-	sw::cluster_map_handle<bool>(&gridOneHandles)[c_gridBounds][c_gridBounds],
-	sw::cluster_map<bool, default_allocator> &clustermap
-)
-{
-	for(int a =0; a < c_gridSize; a++)
-	{
-		for(int b = 0; b < c_gridSize; b++)
-		{
-			bool gridState = gridOne[a][b];
-			EXPECT_EQ(gridState, gridOneHandles[a][b].mElementPtr != nullptr);
-			if (gridState)
-			{
-				EXPECT_EQ(gridState, sw::at(gridOneHandles[a][b]));
-			}
-		}
-	}
-}
-
-TEST(cluster_map_test, conway_gol_test)
-{
-	{
-		sw::cluster_map<bool, default_allocator> cluster_conway_first(4);
-		sw::cluster_map_handle<bool> cluster_conway_handles_first[c_gridBounds][c_gridBounds]{};
-	
-		bool array_conway[c_gridBounds][c_gridBounds]{};
-
-		bool initial_state[c_gridBounds][c_gridBounds] =
-		{
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0,
-			0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-		};
-		
-		compareMethods(array_conway, cluster_conway_handles_first, cluster_conway_first);
-
-		//initialise
-		for(int a =0; a < c_gridSize; a++)
-		{
-			for(int b = 0; b < c_gridSize; b++)
-			{
-				bool gridState = initial_state[a][b];
-				
-				if(gridState)
-				{
-					cluster_conway_handles_first[a][b] = cluster_conway_first.insert(true);
-					array_conway[a][b] = true;
-				}
-			}
-		}
-
-		for(int i = 0; i < 50; i++)
-		{
-			advanceConwayRegular(array_conway);
-			advanceConwayCluster(cluster_conway_first, cluster_conway_handles_first);
-			compareMethods(array_conway, cluster_conway_handles_first, cluster_conway_first);
-		}
-	}
-}
+#include "../include/ClusterMap.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <stdio.h>
+
+class counting_allocator : public default_allocator
+{
+public:
+	static size_t sAllocationCount;
+
+	void* allocate(size_t n)
+	{
+		++sAllocationCount;
+		return default_allocator::allocate(n);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset)
+	{
+		++sAllocationCount;
+		return default_allocator::allocate(n, alignment, alignmentOffset);
+	}
+};
+
+size_t counting_allocator::sAllocationCount = 0u;
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+template < typename T>
+void print_cluster(sw::cluster<T> const& p_cluster)
+{
+	std::cout << "	Capacity " << p_cluster.capacity() << " : Length " << p_cluster.size() << " : ["; 
+	for (auto & i : p_cluster)
+	{
+		std::cout << i << ", ";
+	}
+	std::cout << "]";
+}
+
+template < typename T, typename A >
+void print_cluster_vector(sw::cluster_vector<T, A> const& p_cluster_vec)
+{
+	auto* cluster = p_cluster_vec.first_cluster();
+	if (!cluster)
+	{
+		std::cout << "{}" << std::endl;
+		return;
+	}
+	std::cout << "{" << std::endl;
+	print_cluster(*cluster);
+	std::cout << std::endl;
+
+	while(!cluster->is_last_cluster())
+	{
+		cluster = cluster->next_cluster();
+		print_cluster(*cluster);
+		std::cout << std::endl;
+	}
+
+	std::cout << "}" << std::endl;
+}
+
+template < typename T>
+void print_dense_cluster(sw::cluster<sw::cluster_map_dense_storage<T>> const& p_cluster)
+{
+	std::cout << "	Capacity " << p_cluster.capacity() << " : Length " << p_cluster.size() << " : ["; 
+	for (auto & i : p_cluster)
+	{
+		std::cout << *reinterpret_cast<T*>(i.mData.mCharData) << ", ";
+	}
+	std::cout << "]";
+}
+
+template < typename T, typename A >
+void print_dense_cluster_vector(sw::cluster_vector<T, A> const& p_cluster_vec)
+{
+	auto* cluster = p_cluster_vec.first_cluster();
+	if (!cluster)
+	{
+		std::cout << "{}" << std::endl;
+		return;
+	}
+	std::cout << "{" << std::endl;
+	print_dense_cluster(*cluster);
+	std::cout << std::endl;
+
+	while(!cluster->is_last_cluster())
+	{
+		cluster = cluster->next_cluster();
+		print_dense_cluster(*cluster);
+		std::cout << std::endl;
+	}
+
+	std::cout << "}" << std::endl;
+}
+
+template < typename T, typename A >
+void print_cluster_map(sw::cluster_map<T, A> const& p_cluster_map)
+{
+	std::cout << "{" << std::endl;
+	std::cout << "dense_storage : ";
+	print_dense_cluster_vector(p_cluster_map.dense_storage());
+
+	std::cout << "sparse_indices : ";
+	print_cluster_vector(p_cluster_map.sparse_indices());
+
+	std::cout << "unoccupied_list : ";
+	print_cluster_vector(p_cluster_map.unoccupied_list());
+	std::cout << "}" << std::endl;
+}
+
+TEST(cluster_map_test, push_back_test)
+{
+	{
+		using handle_type = sw::cluster_map<int, default_allocator>::handle_type;
+		sw::cluster_map<int, default_allocator> sv(8);
+		handle_type first = sv.insert(0);
+		handle_type second = sv.insert(1);
+		handle_type third = sv.insert(2);
+		handle_type fourth = sv.insert(3);
+
+		{
+			auto i = sv.begin();
+			EXPECT_EQ(*i  , 0);
+			EXPECT_EQ(*i++ , 0);
+			EXPECT_EQ(*i++ , 1);
+			EXPECT_EQ(*i++ , 2);
+			EXPECT_EQ(*i++ , 3);
+		}
+
+		{
+			auto i = sv.begin();
+			EXPECT_EQ(*i , 0);
+			EXPECT_EQ(*(++i) , 1);
+			EXPECT_EQ(*(++i) , 2);
+			EXPECT_EQ(*(++i) , 3);
+		}
+
+		{
+			auto i = sv.begin();
+			EXPECT_EQ(sw::at(first) , 0);
+			EXPECT_EQ(sw::at(second), 1);
+			EXPECT_EQ(sw::at(third), 2);
+			EXPECT_EQ(sw::at(fourth), 3);
+		}
+	}
+}
+
+
+TEST(cluster_map_test, empty_test)
+{
+	{
+		sw::cluster_map<int, default_allocator> mapOfInt(8);
+		sw::cluster_map<std::list<int>, default_allocator> mapOfListOfTO(8);
+		EXPECT_TRUE(mapOfInt.empty());
+		EXPECT_TRUE(mapOfListOfTO.empty());
+	}
+}
+
+TEST(cluster_map_test, foreach_test)
+{
+	{
+		std::vector<int> initValues{};
+		uint32_t const numValues = 1024u;
+		initValues.reserve(numValues);
+		for (int i = 0; i < numValues; i++)
+		{
+			initValues.push_back(i);
+		}
+
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, default_allocator> mapOfInt(4);
+		EXPECT_EQ(mapOfInt.size(), 0);
+		EXPECT_EQ(mapOfInt.empty() , true);
+		for (int i : initValues)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+		}
+
+		EXPECT_EQ(mapOfInt.size() , numValues);
+		EXPECT_EQ(mapOfInt.empty() , false);
+
+		int j = 0;
+		for (int i : mapOfInt)
+		{
+			EXPECT_EQ(i, initValues[j]);
+			j++;
+		}
+
+
+		for (int l = 0; l < numValues; l++)
+		{
+			int k = 0;
+			for (auto i : handleVec)
+			{
+				int lhs = sw::at(i);
+				int rhs = initValues[l+k];
+				EXPECT_EQ(sw::at(i), initValues[l+k]);
+				k++;
+			}
+			mapOfInt.erase(handleVec.at(0));
+			handleVec.erase(handleVec.begin());
+		}	
+	}
+}
+
+// Thanks to MarioTalevski for his simple GoL implementation
+// https://github.com/MarioTalevski/game-of-life/blob/master/GameOfLife.cpp
+constexpr size_t c_gridBounds = 26u;
+constexpr size_t c_gridSize = 25u;
+
+void copyGrid(
+	bool(&rhs)[c_gridBounds][c_gridBounds],
+	bool(&lhs)[c_gridBounds][c_gridBounds]
+)
+{
+	memcpy(lhs, rhs, sizeof(bool) * c_gridBounds * c_gridBounds);
+}
+
+void advanceConwayRegular(bool(&gridOne)[c_gridBounds][c_gridBounds])
+{
+	bool gridTwo[c_gridBounds][c_gridBounds] = {};
+	copyGrid(gridOne, gridTwo);
+
+	for(int a = 1; a < c_gridSize; a++)
+	{
+		for(int b = 1; b < c_gridSize; b++)
+		{
+			int alive = 0;
+			for(int c = -1; c < 2; c++)
+			{
+				for(int d = -1; d < 2; d++)
+				{
+					if(!(c == 0 && d == 0))
+					{
+						if(gridTwo[a+c][b+d])
+						{
+							++alive;
+						}
+					}
+				}
+			}
+			if(alive < 2)
+			{
+				gridOne[a][b] = false;
+			}
+			else if(alive == 3)
+			{
+				gridOne[a][b] = true;
+			}
+			else if(alive > 3)
+			{
+				gridOne[a][b] = false;
+			}
+		}
+	}
+}
+
+void copyClusterGrid(
+	sw::cluster_map<bool, default_allocator>& rhsGrid,
+	sw::cluster_map_handle<bool>(&rhsHandles)[c_gridBounds][c_gridBounds],
+	sw::cluster_map<bool, default_allocator>& lhsGrid,
+	sw::cluster_map_handle<bool>(&lhsHandles)[c_gridBounds][c_gridBounds]
+)
+{
+	for(int a =0; a < c_gridSize; a++)
+	{
+		for(int b = 0; b < c_gridSize; b++)
+		{
+			if(rhsHandles[a][b].mSparseIndexPtr)
+			{
+				lhsHandles[a][b] = lhsGrid.insert(true);
+			}
+		}
+	}
+}
+
+void advanceConwayCluster(
+	sw::cluster_map<bool, default_allocator>& gridOne,
+	sw::cluster_map_handle<bool> (&gridOneHandles)[c_gridBounds][c_gridBounds]
+	)
+{
+	sw::cluster_map<bool, default_allocator> gridTwo(4);
+	sw::cluster_map_handle<bool> gridTwoHandles[c_gridBounds][c_gridBounds]{};
+	copyClusterGrid(gridOne, gridOneHandles, gridTwo, gridTwoHandles);
+
+	for(int a = 1; a < c_gridSize; a++)
+	{
+		for(int b = 1; b < c_gridSize; b++)
+		{
+			int alive = 0;
+			for(int c = -1; c < 2; c++)
+			{
+				for(int d = -1; d < 2; d++)
+				{
+					if(!(c == 0 && d == 0))
+					{
+						if(gridTwoHandles[a+c][b+d].mElementPtr && sw::at(gridTwoHandles[a+c][b+d]))
+						{
+							++alive;
+						}
+					}
+				}
+			}
+			if(alive == 3)
+			{
+				if(!gridOneHandles[a][b].mElementPtr)
+				{
+					gridOneHandles[a][b] = gridOne.insert(true);
+				}
+			}
+			else if (alive < 2 || alive > 3)
+			{
+				if(gridOneHandles[a][b].mElementPtr)
+				{
+					gridOne.erase(gridOneHandles[a][b]);
+					gridOneHandles[a][b] = {};
+				}
+			}
+		}
+	}
+}
+
+void compareMethods(
+	bool gridOne[c_gridBounds][c_gridBounds],
+	sw::cluster_map_handle<bool>(&gridOneHandles)[c_gridBounds][c_gridBounds],
+	sw::cluster_map<bool, default_allocator> &clustermap
+)
+{
+	for(int a =0; a < c_gridSize; a++)
+	{
+		for(int b = 0; b < c_gridSize; b++)
+		{
+			bool gridState = gridOne[a][b];
+			EXPECT_EQ(gridState, gridOneHandles[a][b].mElementPtr != nullptr);
+			if (gridState)
+			{
+				EXPECT_EQ(gridState, sw::at(gridOneHandles[a][b]));
+			}
+		}
+	}
+}
+
+TEST(cluster_map_test, conway_gol_test)
+{
+	{
+		sw::cluster_map<bool, default_allocator> cluster_conway_first(4);
+		sw::cluster_map_handle<bool> cluster_conway_handles_first[c_gridBounds][c_gridBounds]{};
+	
+		bool array_conway[c_gridBounds][c_gridBounds]{};
+
+		bool initial_state[c_gridBounds][c_gridBounds] =
+		{
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 1, 0, 1, 1, 0, 0, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 0,
+			0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		};
+		
+		compareMethods(array_conway, cluster_conway_handles_first, cluster_conway_first);
+
+		//initialise
+		for(int a =0; a < c_gridSize; a++)
+		{
+			for(int b = 0; b < c_gridSize; b++)
+			{
+				bool gridState = initial_state[a][b];
+				
+				if(gridState)
+				{
+					cluster_conway_handles_first[a][b] = cluster_conway_first.insert(true);
+					array_conway[a][b] = true;
+				}
+			}
+		}
+
+		for(int i = 0; i < 50; i++)
+		{
+			advanceConwayRegular(array_conway);
+			advanceConwayCluster(cluster_conway_first, cluster_conway_handles_first);
+			compareMethods(array_conway, cluster_conway_handles_first, cluster_conway_first);
+		}
+	}
+}
+
+TEST(cluster_map_test, growth_policy_test)
+{
+	{
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, default_allocator, 3u> mapOfInt(4);
+		for (int i = 0; i < 500; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+			EXPECT_EQ(mapOfInt.size(), static_cast<size_t>(i + 1));
+		}
+
+		for (int i = 0; i < 500; i++)
+		{
+			EXPECT_EQ(sw::at(handleVec[i]), i);
+		}
+
+		for (int i = 0; i < 250; i++)
+		{
+			mapOfInt.erase(handleVec[i * 2]);
+		}
+		EXPECT_EQ(mapOfInt.size(), 250u);
+	}
+
+	{
+		sw::cluster_map<int, default_allocator, 2u, sw::capped_geometric_growth<2u, 32u>> mapOfInt(4);
+		for (int i = 0; i < 500; i++)
+		{
+			mapOfInt.insert(i);
+		}
+		EXPECT_EQ(mapOfInt.size(), 500u);
+	}
+}
+
+TEST(cluster_map_test, reserve_test)
+{
+	{
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, counting_allocator> mapOfInt(4);
+		mapOfInt.reserve(500);
+		EXPECT_GE(mapOfInt.capacity(), 500u);
+		EXPECT_TRUE(mapOfInt.empty());
+
+		size_t const allocations = counting_allocator::sAllocationCount;
+		for (int i = 0; i < 500; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+		}
+		for (auto& handle : handleVec)
+		{
+			mapOfInt.erase(handle);
+		}
+		for (int i = 0; i < 500; i++)
+		{
+			mapOfInt.insert(i);
+		}
+		EXPECT_EQ(counting_allocator::sAllocationCount, allocations);
+		EXPECT_EQ(mapOfInt.size(), 500u);
+	}
+}
+
+TEST(cluster_map_test, erase_relocation_test)
+{
+	{
+		//Short strings live inside the object itself, so the erase must move them rather than copy their bytes
+		std::vector<sw::cluster_map_handle<std::string>> handleVec{};
+		sw::cluster_map<std::string, default_allocator> mapOfString(4);
+		for (int i = 0; i < 40; i++)
+		{
+			std::string value = i % 2 ? std::to_string(i) : std::string(64, char('a' + i % 26));
+			handleVec.push_back(mapOfString.insert(std::move(value)));
+		}
+
+		for (int i = 0; i < 40; i += 3)
+		{
+			mapOfString.erase(handleVec[i]);
+		}
+		for (int i = 0; i < 40; i++)
+		{
+			if (i % 3)
+			{
+				std::string expected = i % 2 ? std::to_string(i) : std::string(64, char('a' + i % 26));
+				EXPECT_EQ(sw::at(handleVec[i]), expected);
+			}
+		}
+
+		//Erasing the back element leaves nothing to relocate
+		mapOfString.erase(handleVec[38]);
+		EXPECT_EQ(sw::at(handleVec[37]), "37");
+		mapOfString.clear();
+	}
+
+	{
+		std::vector<sw::cluster_map_handle<std::unique_ptr<int>>> handleVec{};
+		sw::cluster_map<std::unique_ptr<int>, default_allocator> mapOfPtr(4);
+		for (int i = 0; i < 20; i++)
+		{
+			handleVec.push_back(mapOfPtr.insert(new int(i)));
+		}
+		for (int i = 0; i < 20; i += 2)
+		{
+			mapOfPtr.erase(handleVec[i]);
+		}
+		for (int i = 1; i < 20; i += 2)
+		{
+			EXPECT_EQ(*sw::at(handleVec[i]), i);
+		}
+		mapOfPtr.clear();
+	}
+}
+
+struct destroy_counter
+{
+	destroy_counter(int value) : mValue(value) {}
+	~destroy_counter() { ++sDestroyCount; }
+
+	int mValue;
+	static int sDestroyCount;
+};
+
+int destroy_counter::sDestroyCount = 0;
+
+TEST(cluster_map_test, destroy_test)
+{
+	destroy_counter::sDestroyCount = 0;
+	{
+		std::vector<sw::cluster_map_handle<destroy_counter>> handleVec{};
+		sw::cluster_map<destroy_counter, default_allocator> mapOfCounter(4);
+		for (int i = 0; i < 30; i++)
+		{
+			handleVec.push_back(mapOfCounter.insert(i));
+		}
+		for (int i = 0; i < 30; i += 3)
+		{
+			mapOfCounter.erase(handleVec[i]);
+		}
+		EXPECT_EQ(mapOfCounter.size(), 20u);
+
+		//Only the live elements are destroyed, not the erased slots past the dense end
+		int destroyCount = destroy_counter::sDestroyCount;
+		mapOfCounter.clear();
+		EXPECT_EQ(destroy_counter::sDestroyCount, destroyCount + 20);
+		EXPECT_TRUE(mapOfCounter.empty());
+		destroy_counter::sDestroyCount = 0;
+
+		for (int i = 0; i < 7; i++)
+		{
+			mapOfCounter.insert(i);
+		}
+		sw::cluster_map<destroy_counter, default_allocator> movedMap(std::move(mapOfCounter));
+		EXPECT_TRUE(mapOfCounter.empty());
+		EXPECT_EQ(movedMap.size(), 7u);
+	}
+	EXPECT_EQ(destroy_counter::sDestroyCount, 7);
+}
+
+TEST(cluster_map_test, compact_test)
+{
+	std::vector<sw::cluster_map_handle<std::string>> handleVec{};
+	sw::cluster_map<std::string, default_allocator> mapOfString(4);
+	for (int i = 0; i < 60; i++)
+	{
+		handleVec.push_back(mapOfString.insert(std::to_string(i)));
+	}
+	for (int i = 0; i < 60; i += 4)
+	{
+		mapOfString.erase(handleVec[i]);
+	}
+
+	mapOfString.compact();
+	EXPECT_EQ(mapOfString.size(), 45u);
+	EXPECT_EQ(mapOfString.dense_storage().cluster_count(), 1u);
+	EXPECT_EQ(mapOfString.dense_storage().size(), 45u);
+	for (int i = 0; i < 60; i++)
+	{
+		if (i % 4)
+		{
+			EXPECT_EQ(sw::at(handleVec[i]), std::to_string(i));
+		}
+	}
+	size_t count = 0u;
+	for (std::string const & value : mapOfString)
+	{
+		EXPECT_FALSE(value.empty());
+		++count;
+	}
+	EXPECT_EQ(count, 45u);
+
+	//Inserting reuses the erased sparse indices and grows the dense storage again
+	for (int i = 0; i < 60; i += 4)
+	{
+		handleVec[i] = mapOfString.insert(std::string(40, char('a' + i % 26)));
+	}
+	EXPECT_EQ(mapOfString.size(), 60u);
+	for (int i = 0; i < 60; i++)
+	{
+		std::string expected = i % 4 ? std::to_string(i) : std::string(40, char('a' + i % 26));
+		EXPECT_EQ(sw::at(handleVec[i]), expected);
+	}
+}
+
+TEST(cluster_map_test, key_test)
+{
+	EXPECT_EQ(sizeof(sw::cluster_map_key), 8u);
+
+	std::vector<sw::cluster_map_key> keys{};
+	sw::cluster_map<std::string, default_allocator> mapOfString(4);
+	EXPECT_FALSE(mapOfString.contains(sw::cluster_map_key{}));
+	for (int i = 0; i < 50; i++)
+	{
+		keys.push_back(mapOfString.key_of(mapOfString.insert(std::to_string(i))));
+	}
+	EXPECT_FALSE(mapOfString.contains(sw::cluster_map_key{}));
+
+	for (int i = 0; i < 50; i++)
+	{
+		EXPECT_TRUE(mapOfString.contains(keys[i]));
+		EXPECT_EQ(*mapOfString.find(keys[i]), std::to_string(i));
+	}
+
+	for (int i = 0; i < 50; i += 2)
+	{
+		EXPECT_TRUE(mapOfString.erase(keys[i]));
+		EXPECT_FALSE(mapOfString.erase(keys[i]));
+	}
+
+	//Reinserting reuses the erased slots, but the stale keys do not resolve to the new occupants
+	std::vector<sw::cluster_map_key> newKeys{};
+	for (int i = 0; i < 25; i++)
+	{
+		sw::cluster_map_handle<std::string> handle = mapOfString.insert("new" + std::to_string(i));
+		newKeys.push_back(mapOfString.key_of(handle));
+	}
+	EXPECT_EQ(mapOfString.sparse_indices().size(), 50u);
+	for (int i = 0; i < 50; i++)
+	{
+		EXPECT_EQ(mapOfString.contains(keys[i]), i % 2 == 1);
+		if (i % 2)
+		{
+			EXPECT_EQ(*mapOfString.find(keys[i]), std::to_string(i));
+		}
+		else
+		{
+			EXPECT_TRUE(mapOfString.find(keys[i]) == nullptr);
+		}
+	}
+	for (int i = 0; i < 25; i++)
+	{
+		EXPECT_EQ(*mapOfString.find(newKeys[i]), "new" + std::to_string(i));
+		sw::cluster_map_handle<std::string> handle = mapOfString.to_handle(newKeys[i]);
+		EXPECT_EQ(sw::at(handle), "new" + std::to_string(i));
+	}
+
+	//Erasing through a handle retires the key too, and so does clear()
+	sw::cluster_map_handle<std::string> handle = mapOfString.to_handle(keys[1]);
+	mapOfString.erase(handle);
+	EXPECT_FALSE(mapOfString.contains(keys[1]));
+	EXPECT_TRUE(sw::is_null(mapOfString.to_handle(keys[1])));
+
+	mapOfString.clear();
+	sw::cluster_map_key reused = mapOfString.key_of(mapOfString.insert("after"));
+	EXPECT_EQ(reused.mSlot, 0u);
+	for (int i = 0; i < 50; i++)
+	{
+		EXPECT_FALSE(mapOfString.contains(keys[i]));
+	}
+	EXPECT_FALSE(mapOfString.contains(newKeys[0]));
+	EXPECT_TRUE(mapOfString.contains(reused));
+}
+
+struct move_counter
+{
+	move_counter(int value) : mValue(value) {}
+	move_counter(move_counter&& other) : mValue(other.mValue) { ++sMoveCount; }
+
+	int mValue;
+	static int sMoveCount;
+};
+
+int move_counter::sMoveCount = 0;
+
+TEST(cluster_map_test, batch_test)
+{
+	{
+		std::vector<sw::cluster_map_handle<std::string>> handleVec{};
+		sw::cluster_map<std::string, default_allocator> mapOfString(4);
+		mapOfString.insert_n(30, std::back_inserter(handleVec), "filler");
+		EXPECT_EQ(mapOfString.size(), 30u);
+		EXPECT_EQ(handleVec.size(), 30u);
+
+		std::vector<std::string> names{};
+		for (int i = 0; i < 70; i++)
+		{
+			names.push_back(std::to_string(i) + std::string(i % 3 ? 0u : 40u, 'x'));
+		}
+		mapOfString.insert_range(names.begin(), names.end(), std::back_inserter(handleVec));
+		EXPECT_EQ(mapOfString.size(), 100u);
+		for (int i = 0; i < 30; i++)
+		{
+			EXPECT_EQ(sw::at(handleVec[i]), "filler");
+		}
+		for (int i = 0; i < 70; i++)
+		{
+			EXPECT_EQ(sw::at(handleVec[30 + i]), names[i]);
+		}
+
+		//Erase a batch straddling the dense tail
+		std::vector<sw::cluster_map_handle<std::string>> erased{};
+		std::vector<bool> live(100, true);
+		for (int i = 0; i < 100; i++)
+		{
+			if (i % 4 == 0 || i > 90)
+			{
+				erased.push_back(handleVec[i]);
+				live[i] = false;
+			}
+		}
+		std::vector<sw::cluster_map_key> erasedKeys{};
+		for (auto handle : erased)
+		{
+			erasedKeys.push_back(mapOfString.key_of(handle));
+		}
+		mapOfString.erase_batch(erased.begin(), erased.end());
+		EXPECT_EQ(mapOfString.size(), 68u);
+		EXPECT_EQ(mapOfString.unoccupied_list().size(), 32u);
+		for (auto key : erasedKeys)
+		{
+			EXPECT_FALSE(mapOfString.contains(key));
+		}
+
+		size_t visited = 0u;
+		for (std::string const & value : mapOfString)
+		{
+			EXPECT_FALSE(value.empty());
+			++visited;
+		}
+		EXPECT_EQ(visited, 68u);
+		for (int i = 0; i < 100; i++)
+		{
+			if (live[i])
+			{
+				EXPECT_EQ(sw::at(handleVec[i]), i < 30 ? std::string("filler") : names[i - 30]);
+			}
+		}
+
+		//Refilling takes the freed slots before growing the sparse indices
+		std::vector<sw::cluster_map_handle<std::string>> refill{};
+		mapOfString.insert_n(40, std::back_inserter(refill), std::string(50, 'r'));
+		EXPECT_EQ(mapOfString.size(), 108u);
+		EXPECT_EQ(mapOfString.sparse_indices().size(), 108u);
+		EXPECT_TRUE(mapOfString.unoccupied_list().empty());
+		for (auto& handle : refill)
+		{
+			EXPECT_EQ(sw::at(handle), std::string(50, 'r'));
+		}
+		for (int i = 0; i < 100; i++)
+		{
+			if (live[i])
+			{
+				EXPECT_EQ(sw::at(handleVec[i]), i < 30 ? std::string("filler") : names[i - 30]);
+			}
+		}
+
+		mapOfString.erase_batch(refill.begin(), refill.end());
+		mapOfString.erase(handleVec[1]);
+		EXPECT_EQ(mapOfString.size(), 67u);
+		EXPECT_EQ(sw::at(handleVec[99 - 9]), names[60]);
+	}
+
+	{
+		//Everything at once, then again after compact() has trimmed the dense storage
+		destroy_counter::sDestroyCount = 0;
+		std::vector<sw::cluster_map_handle<destroy_counter>> handleVec{};
+		sw::cluster_map<destroy_counter, default_allocator> mapOfCounter(8);
+		mapOfCounter.insert_n(50, std::back_inserter(handleVec), 7);
+		mapOfCounter.erase_batch(handleVec.begin(), handleVec.end());
+		EXPECT_EQ(destroy_counter::sDestroyCount, 50);
+		EXPECT_TRUE(mapOfCounter.empty());
+		EXPECT_TRUE(mapOfCounter.begin() == mapOfCounter.end());
+
+		handleVec.clear();
+		mapOfCounter.insert_n(20, std::back_inserter(handleVec), 3);
+		mapOfCounter.erase_batch(handleVec.begin() + 10, handleVec.end());
+		mapOfCounter.compact();
+		mapOfCounter.insert_n(30, std::back_inserter(handleVec), 4);
+		EXPECT_EQ(mapOfCounter.size(), 40u);
+		int total = 0;
+		for (destroy_counter const & counter : mapOfCounter)
+		{
+			total += counter.mValue;
+		}
+		EXPECT_EQ(total, 10 * 3 + 30 * 4);
+		EXPECT_EQ(sw::at(handleVec[5]).mValue, 3);
+		EXPECT_EQ(sw::at(handleVec[49]).mValue, 4);
+		destroy_counter::sDestroyCount = 0;
+	}
+
+	{
+		//A front target listed before a tail target that would have filled its hole: only the survivor behind it is moved
+		std::vector<sw::cluster_map_handle<move_counter>> handleVec{};
+		sw::cluster_map<move_counter, default_allocator> mapOfCounter(4);
+		for (int i = 0; i < 8; i++)
+		{
+			handleVec.push_back(mapOfCounter.insert(i));
+		}
+		move_counter::sMoveCount = 0;
+		std::vector<sw::cluster_map_handle<move_counter>> erased{ handleVec[1], handleVec[6] };
+		mapOfCounter.erase_batch(erased.begin(), erased.end());
+		EXPECT_EQ(move_counter::sMoveCount, 1);
+		EXPECT_EQ(mapOfCounter.size(), 6u);
+
+		std::vector<int> dense{};
+		for (move_counter const & counter : mapOfCounter)
+		{
+			dense.push_back(counter.mValue);
+		}
+		EXPECT_EQ(dense, (std::vector<int>{ 0, 7, 2, 3, 4, 5 }));
+		EXPECT_EQ(sw::at(handleVec[7]).mValue, 7);
+	}
+}
+
+TEST(cluster_map_test, shrink_test)
+{
+	{
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		std::vector<sw::cluster_map_key> keyVec{};
+		sw::cluster_map<int, default_allocator> mapOfInt(4);
+		for (int i = 0; i < 1000; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+			keyVec.push_back(mapOfInt.key_of(handleVec.back()));
+		}
+		size_t const peakCapacity = mapOfInt.capacity();
+
+		//Keep every 20th element, so all the slots after the last of them are free
+		for (int i = 0; i < 1000; i++)
+		{
+			if (i % 20 || i > 900)
+			{
+				mapOfInt.erase(handleVec[i]);
+			}
+		}
+		EXPECT_EQ(mapOfInt.size(), 46u);
+		EXPECT_EQ(mapOfInt.capacity(), peakCapacity);
+
+		mapOfInt.shrink_to_fit();
+		EXPECT_LT(mapOfInt.capacity(), peakCapacity / 4u);
+		EXPECT_EQ(mapOfInt.sparse_indices().size(), 901u);
+		EXPECT_EQ(mapOfInt.unoccupied_list().size(), 901u - 46u);
+		for (int i = 0; i < 1000; i++)
+		{
+			bool const live = i % 20 == 0 && i <= 900;
+			EXPECT_EQ(mapOfInt.contains(keyVec[i]), live);
+			if (live)
+			{
+				EXPECT_EQ(sw::at(handleVec[i]), i);
+			}
+		}
+
+		//Freed slots are reused before new ones are added, and keys into the dropped slots stay dead
+		for (int i = 0; i < 1000; i++)
+		{
+			mapOfInt.insert(-i);
+		}
+		EXPECT_EQ(mapOfInt.size(), 1046u);
+		EXPECT_EQ(mapOfInt.sparse_indices().size(), 1046u);
+		EXPECT_TRUE(mapOfInt.unoccupied_list().empty());
+		for (int i = 901; i < 1000; i++)
+		{
+			EXPECT_FALSE(mapOfInt.contains(keyVec[i]));
+		}
+		long long total = 0;
+		for (int value : mapOfInt)
+		{
+			total += value;
+		}
+		EXPECT_EQ(total, 20LL * 45LL * 46LL / 2LL - 999LL * 1000LL / 2LL);
+	}
+
+	{
+		//Erasing everything frees the lot
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, default_allocator> mapOfInt(4);
+		mapOfInt.reserve(100);
+		for (int i = 0; i < 100; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+		}
+		mapOfInt.erase_batch(handleVec.begin(), handleVec.end());
+		mapOfInt.shrink_to_fit();
+		EXPECT_TRUE(mapOfInt.empty());
+		EXPECT_EQ(mapOfInt.capacity(), 0u);
+		EXPECT_TRUE(mapOfInt.sparse_indices().empty());
+		EXPECT_TRUE(mapOfInt.unoccupied_list().empty());
+		mapOfInt.insert(7);
+		EXPECT_EQ(*mapOfInt.begin(), 7);
+	}
+
+	{
+		//The automatic policy shrinks as the population drains, not on every erase
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, default_allocator> mapOfInt(4);
+		mapOfInt.set_shrink_load_factor(0.25f);
+		for (int i = 0; i < 4000; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+		}
+		size_t const peakCapacity = mapOfInt.capacity();
+		size_t capacity = peakCapacity;
+		int shrinkCount = 0;
+		for (int i = 3999; i >= 200; i--)
+		{
+			mapOfInt.erase(handleVec[i]);
+			if (mapOfInt.capacity() != capacity)
+			{
+				capacity = mapOfInt.capacity();
+				shrinkCount++;
+			}
+		}
+		EXPECT_GT(shrinkCount, 0);
+		EXPECT_LT(shrinkCount, 10);
+		EXPECT_LT(mapOfInt.capacity(), peakCapacity / 4u);
+		EXPECT_LT(mapOfInt.sparse_indices().size(), 4000u);
+		for (int i = 0; i < 200; i++)
+		{
+			EXPECT_EQ(sw::at(handleVec[i]), i);
+		}
+	}
+}
+
+TEST(cluster_map_test, segments_test)
+{
+	std::vector<sw::cluster_map_handle<int>> handleVec{};
+	sw::cluster_map<int, default_allocator> mapOfInt(4);
+	long long expected = 0;
+	for (int i = 0; i < 200; i++)
+	{
+		handleVec.push_back(mapOfInt.insert(i));
+		expected += i;
+	}
+	for (int i = 0; i < 200; i += 3)
+	{
+		mapOfInt.erase(handleVec[i]);
+		expected -= i;
+	}
+
+	//Each segment is one dense cluster's elements as a plain T span
+	static_assert(std::is_same<decltype((*mapOfInt.segments().begin()).begin()), int*>::value, "cluster_map segments yield T*");
+	long long total = 0;
+	size_t visited = 0u;
+	for (auto segment : mapOfInt.segments())
+	{
+		int* first = segment.begin();
+		EXPECT_EQ(segment.end() - first, static_cast<ptrdiff_t>(segment.size()));
+		for (int* i = first; i != segment.end(); ++i)
+		{
+			total += *i;
+		}
+		visited += segment.size();
+		EXPECT_EQ(&*segment.to_iterator(first), first);
+	}
+	EXPECT_EQ(visited, mapOfInt.size());
+	EXPECT_EQ(total, expected);
+
+	//The back links follow the elements through swaps and erasing by iterator
+	sw::cluster_map_handle<int> first = mapOfInt.front();
+	sw::cluster_map_handle<int> last = mapOfInt.back();
+	int const firstValue = sw::at(first);
+	int const lastValue = sw::at(last);
+	sw::cluster_map_key firstKey = mapOfInt.key_of(first);
+	mapOfInt.swap_pos(first, last);
+	EXPECT_EQ(sw::at(first), firstValue);
+	EXPECT_EQ(*mapOfInt.begin(), lastValue);
+	EXPECT_EQ(mapOfInt.key_of(first), firstKey);
+	mapOfInt.erase(mapOfInt.begin());
+	EXPECT_EQ(*mapOfInt.find(firstKey), firstValue);
+	for (int i = 0; i < 200; i++)
+	{
+		if (i % 3 && i != lastValue)
+		{
+			EXPECT_EQ(sw::at(handleVec[i]), i);
+			EXPECT_EQ(mapOfInt.find(mapOfInt.key_of(handleVec[i])), &sw::at(handleVec[i]));
+		}
+	}
+}
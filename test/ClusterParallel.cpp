@@ -0,0 +1,284 @@
+#include "../include/ClusterParallel.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+TEST(cluster_parallel_test, subrange_segments_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		for (int i = 0; i < 100; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+
+		EXPECT_TRUE(vectorOfInt.segments(10, 10).begin() == vectorOfInt.segments(10, 10).end());
+
+		for (size_t first = 0; first < 100; first += 7)
+		{
+			for (size_t last = first + 1; last <= 100; last += 5)
+			{
+				int expected = static_cast<int>(first);
+				for (auto segment : vectorOfInt.segments(first, last))
+				{
+					EXPECT_FALSE(segment.empty());
+					for (int* i = segment.begin(); i != segment.end(); ++i)
+					{
+						EXPECT_EQ(*i, expected++);
+					}
+				}
+				EXPECT_EQ(expected, static_cast<int>(last));
+			}
+		}
+	}
+
+	{
+		std::vector<sw::cluster_map_handle<int>> handleVec{};
+		sw::cluster_map<int, default_allocator> mapOfInt(4);
+		for (int i = 0; i < 100; i++)
+		{
+			handleVec.push_back(mapOfInt.insert(i));
+		}
+		for (int i = 0; i < 100; i += 3)
+		{
+			mapOfInt.erase(handleVec[i]);
+		}
+
+		std::vector<int> dense;
+		for (int value : mapOfInt)
+		{
+			dense.push_back(value);
+		}
+		size_t position = 5u;
+		for (auto segment : mapOfInt.segments(5, 40))
+		{
+			for (int value : segment)
+			{
+				EXPECT_EQ(value, dense[position++]);
+			}
+		}
+		EXPECT_EQ(position, 40u);
+	}
+}
+
+TEST(cluster_parallel_test, thread_pool_test)
+{
+	sw::thread_pool pool(3);
+	EXPECT_EQ(pool.concurrency(), 4u);
+
+	for (size_t taskCount : { 0u, 1u, 2u, 7u, 1000u })
+	{
+		std::vector<std::atomic<int>> runs(taskCount);
+		pool.parallel_for(taskCount, [&runs](size_t i) { runs[i]++; });
+		for (size_t i = 0; i < taskCount; i++)
+		{
+			EXPECT_EQ(runs[i].load(), 1);
+		}
+	}
+
+	sw::thread_pool inlinePool(0);
+	EXPECT_EQ(inlinePool.concurrency(), 1u);
+	int total = 0;
+	inlinePool.parallel_for(10, [&total](size_t i) { total += static_cast<int>(i); });
+	EXPECT_EQ(total, 45);
+}
+
+TEST(cluster_parallel_test, vector_parallel_test)
+{
+	const size_t count = 100000u;
+	sw::thread_pool pool(3);
+
+	{
+		sw::cluster_vector<uint64_t, default_allocator> vectorOfInt(16);
+		vectorOfInt.resize(count);
+
+		sw::parallel_generate(vectorOfInt, [](size_t i) { return uint64_t(i); }, pool);
+		for (size_t i = 0; i < count; i++)
+		{
+			EXPECT_EQ(vectorOfInt[i], i);
+		}
+
+		sw::parallel_for_each(vectorOfInt, [](uint64_t& value) { value *= 2u; }, pool);
+		EXPECT_EQ(sw::parallel_reduce(vectorOfInt, uint64_t(1), std::plus<uint64_t>(), pool), count * (count - 1u) + 1u);
+		EXPECT_EQ(sw::parallel_reduce(vectorOfInt, uint64_t(0), std::plus<uint64_t>(), sw::sequential_executor()), count * (count - 1u));
+
+		//The partials needn't be default constructible, and mutable operations are taken by value
+		struct sum
+		{
+			sum(uint64_t value) : mValue(value) {}
+			uint64_t mValue;
+		};
+		EXPECT_EQ(sw::parallel_reduce(vectorOfInt, sum(1u), [](sum a, sum b) { return sum(a.mValue + b.mValue); }, pool).mValue, count * (count - 1u) + 1u);
+		size_t calls = 0u;
+		sw::parallel_for_each(vectorOfInt, [calls](uint64_t&) mutable { ++calls; }, sw::sequential_executor());
+		EXPECT_EQ(sw::parallel_reduce(vectorOfInt, uint64_t(0), [calls](uint64_t a, uint64_t b) mutable { ++calls; return a + b; }, sw::sequential_executor()), count * (count - 1u));
+
+		sw::cluster_vector<double, default_allocator> halves(1000);
+		halves.resize(count);
+		sw::parallel_transform(vectorOfInt, halves, [](uint64_t value) { return value / 4.0; }, pool);
+		for (size_t i = 0; i < count; i += 997)
+		{
+			EXPECT_EQ(halves[i], i / 2.0);
+		}
+
+		sw::parallel_transform(vectorOfInt, vectorOfInt, [](uint64_t value) { return value + 1u; });
+		EXPECT_EQ(vectorOfInt[count - 1u], 2u * (count - 1u) + 1u);
+	}
+
+	{
+		sw::cluster_vector<int, default_allocator> empty(16);
+		EXPECT_EQ(sw::parallel_reduce(empty, 5, std::plus<int>(), pool), 5);
+		sw::parallel_for_each(empty, [](int&) { ADD_FAILURE(); }, pool);
+	}
+}
+
+TEST(cluster_parallel_test, map_parallel_test)
+{
+	sw::thread_pool pool(3);
+
+	std::vector<sw::cluster_map_handle<int>> handleVec{};
+	sw::cluster_map<int, default_allocator> mapOfInt(16);
+	for (int i = 0; i < 50000; i++)
+	{
+		handleVec.push_back(mapOfInt.insert(i));
+	}
+	for (int i = 0; i < 50000; i += 2)
+	{
+		mapOfInt.erase(handleVec[i]);
+	}
+
+	EXPECT_EQ(sw::parallel_reduce(mapOfInt, 0ll, [](long long a, long long b) { return a + b; }, pool), 625000000ll);
+
+	sw::parallel_for_each(mapOfInt, [](int& value) { value = -value; }, pool);
+	EXPECT_EQ(sw::at(handleVec[1]), -1);
+	EXPECT_EQ(sw::at(handleVec[49999]), -49999);
+
+	sw::cluster_vector<int, default_allocator> copied(64);
+	copied.resize(mapOfInt.size());
+	sw::parallel_transform(mapOfInt, copied, [](int value) { return -value; }, pool);
+	EXPECT_EQ(sw::parallel_reduce(copied, 0ll, [](long long a, long long b) { return a + b; }, sw::sequential_executor()), 625000000ll);
+}
+
+TEST(cluster_parallel_test, sort_test)
+{
+	sw::thread_pool pool(3);
+	std::mt19937 random(7);
+
+	{
+		const size_t count = 200000u;
+		sw::cluster_vector<uint32_t, default_allocator> vectorOfInt(16);
+		std::vector<uint32_t> reference;
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t value = random() % 50000u;
+			vectorOfInt.push_back(value);
+			reference.push_back(value);
+		}
+		std::sort(reference.begin(), reference.end());
+
+		sw::parallel_sort(vectorOfInt, std::less<uint32_t>(), pool);
+		EXPECT_TRUE(std::equal(reference.begin(), reference.end(), vectorOfInt.begin()));
+
+		sw::parallel_sort(vectorOfInt, std::greater<uint32_t>(), sw::sequential_executor());
+		EXPECT_TRUE(std::equal(reference.rbegin(), reference.rend(), vectorOfInt.begin()));
+
+		size_t comparisons = 0u;
+		sw::parallel_sort(vectorOfInt, [comparisons](uint32_t a, uint32_t b) mutable { ++comparisons; return a < b; }, sw::sequential_executor());
+		EXPECT_TRUE(std::equal(reference.begin(), reference.end(), vectorOfInt.begin()));
+	}
+
+	{
+		//Stability, sorting on the key only and checking the original order survives among equal keys
+		const size_t count = 100000u;
+		sw::cluster_vector<std::pair<int, std::unique_ptr<size_t>>, default_allocator> vectorOfPair(8);
+		for (size_t i = 0; i < count; i++)
+		{
+			vectorOfPair.emplace_back(int(random() % 100u), std::unique_ptr<size_t>(new size_t(i)));
+		}
+		sw::parallel_stable_sort(vectorOfPair, [](std::pair<int, std::unique_ptr<size_t>> const & a, std::pair<int, std::unique_ptr<size_t>> const & b) { return a.first < b.first; }, pool);
+
+		EXPECT_EQ(vectorOfPair.size(), count);
+		for (size_t i = 1; i < count; i++)
+		{
+			auto const & prev = vectorOfPair[i - 1u];
+			auto const & next = vectorOfPair[i];
+			EXPECT_TRUE(prev.first < next.first || (prev.first == next.first && *prev.second < *next.second));
+		}
+	}
+
+	{
+		//The scratch buffer is taken from the container's allocator and handed back to it
+		const size_t count = 50000u;
+		sw::cluster_vector<int, byte_counting_allocator> vectorOfInt(16);
+		for (size_t i = 0; i < count; i++)
+		{
+			vectorOfInt.push_back(int(random() % 1000u));
+		}
+		size_t const liveBytes = byte_counting_allocator::sLiveBytes;
+		sw::parallel_sort(vectorOfInt, std::less<int>(), pool);
+		EXPECT_GE(byte_counting_allocator::sPeakBytes, liveBytes + count * sizeof(int));
+		EXPECT_EQ(byte_counting_allocator::sLiveBytes, liveBytes);
+		EXPECT_TRUE(std::is_sorted(vectorOfInt.begin(), vectorOfInt.end()));
+	}
+
+	{
+		sw::cluster_vector<int, default_allocator> small(4);
+		sw::parallel_sort(small);
+		small.push_back(3);
+		small.push_back(1);
+		small.push_back(2);
+		sw::parallel_stable_sort(small);
+		EXPECT_EQ(small[0], 1);
+		EXPECT_EQ(small[2], 3);
+	}
+}
+
+TEST(cluster_parallel_test, map_sort_test)
+{
+	sw::thread_pool pool(3);
+	std::mt19937 random(11);
+
+	std::vector<sw::cluster_map_handle<std::pair<int, int>>> handles;
+	sw::cluster_map<std::pair<int, int>, default_allocator> mapOfPair(16);
+	for (int i = 0; i < 60000; i++)
+	{
+		handles.push_back(mapOfPair.insert(int(random() % 1000u), i));
+	}
+	for (int i = 0; i < 60000; i += 3)
+	{
+		mapOfPair.erase(handles[i]);
+	}
+
+	sw::parallel_sort_by_key(mapOfPair, [](std::pair<int, int> const & value) { return value.first; }, pool);
+
+	//Handles still find their own element
+	for (int i = 1; i < 60000; i += 3)
+	{
+		EXPECT_EQ(sw::at(handles[i]).second, i);
+	}
+
+	//Dense order is by key, and by insertion order among equal keys as those were already in dense order
+	bool first = true;
+	std::pair<int, int> prev;
+	size_t visited = 0u;
+	for (auto const & value : mapOfPair)
+	{
+		if (!first)
+		{
+			EXPECT_TRUE(prev.first <= value.first);
+		}
+		first = false;
+		prev = value;
+		++visited;
+	}
+	EXPECT_EQ(visited, mapOfPair.size());
+}
@@ -0,0 +1,101 @@
+#include "../include/ClusterPublishedVector.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+TEST(published_cluster_vector_test, single_thread_test)
+{
+	sw::published_cluster_vector<int, default_allocator> vectorOfInt(4);
+	EXPECT_TRUE(vectorOfInt.view().empty());
+	EXPECT_EQ(vectorOfInt.view().begin(), vectorOfInt.view().end());
+
+	for (int i = 0; i < 10; ++i)
+	{
+		vectorOfInt.push_back(i);
+	}
+	auto view = vectorOfInt.view();
+
+	std::vector<int> more = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
+	vectorOfInt.append(more.begin(), more.end());
+	vectorOfInt.emplace_back(20);
+
+	//The older view still ends where it was taken
+	EXPECT_EQ(view.size(), 10u);
+	int expected = 0;
+	for (int value : view)
+	{
+		EXPECT_EQ(value, expected++);
+	}
+	EXPECT_EQ(expected, 10);
+
+	EXPECT_EQ(vectorOfInt.published_size(), 21u);
+	expected = 0;
+	for (int value : vectorOfInt.view())
+	{
+		EXPECT_EQ(value, expected++);
+	}
+	EXPECT_EQ(expected, 21);
+	EXPECT_EQ(vectorOfInt.elements().size(), 21u);
+
+	vectorOfInt.clear();
+	EXPECT_TRUE(vectorOfInt.view().empty());
+}
+
+TEST(published_cluster_vector_test, concurrent_readers_test)
+{
+	size_t const kElementCount = 200000u;
+	size_t const kReaderCount = 3u;
+
+	sw::published_cluster_vector<size_t, default_allocator> vectorOfSize(16);
+	std::atomic<bool> failed(false);
+
+	std::vector<std::thread> readers;
+	for (size_t r = 0u; r < kReaderCount; ++r)
+	{
+		readers.emplace_back([&vectorOfSize, &failed, kElementCount]()
+		{
+			size_t lastSize = 0u;
+			while (lastSize < kElementCount)
+			{
+				auto view = vectorOfSize.view();
+				if (view.size() < lastSize)
+				{
+					failed = true;
+				}
+				size_t expected = 0u;
+				for (size_t value : view)
+				{
+					if (value != expected++)
+					{
+						failed = true;
+					}
+				}
+				if (expected != view.size())
+				{
+					failed = true;
+				}
+				lastSize = view.size();
+			}
+		});
+	}
+
+	for (size_t i = 0u; i < kElementCount; ++i)
+	{
+		vectorOfSize.push_back(i);
+	}
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	EXPECT_FALSE(failed);
+	EXPECT_EQ(vectorOfSize.published_size(), kElementCount);
+}
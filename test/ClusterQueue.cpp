@@ -0,0 +1,138 @@
+#include "../include/ClusterQueue.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <deque>
+#include <memory>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+TEST(cluster_queue_test, fifo_test)
+{
+	{
+		sw::cluster_queue<int, default_allocator> queueOfInt(4);
+		EXPECT_TRUE(queueOfInt.empty());
+		EXPECT_EQ(queueOfInt.begin(), queueOfInt.end());
+
+		for (int i = 0; i < 100; ++i)
+		{
+			queueOfInt.push_back(i);
+		}
+		EXPECT_EQ(queueOfInt.size(), 100u);
+		EXPECT_EQ(queueOfInt.front(), 0);
+		EXPECT_EQ(queueOfInt.back(), 99);
+
+		int expected = 0;
+		for (int value : queueOfInt)
+		{
+			EXPECT_EQ(value, expected++);
+		}
+		EXPECT_EQ(expected, 100);
+
+		//Clusters of 4, 8, 16, 32 and 64, the first three drain after 28 pops
+		size_t const clusterCount = queueOfInt.cluster_count();
+		for (int i = 0; i < 28; ++i)
+		{
+			EXPECT_EQ(queueOfInt.front(), i);
+			queueOfInt.pop_front();
+		}
+		EXPECT_EQ(queueOfInt.cluster_count(), clusterCount - 3u);
+		EXPECT_EQ(queueOfInt.front(), 28);
+
+		//Element addresses are stable while queued
+		int* address = &queueOfInt.back();
+		for (int i = 100; i < 200; ++i)
+		{
+			queueOfInt.push_back(i);
+		}
+		EXPECT_EQ(*address, 99);
+
+		expected = 28;
+		while (!queueOfInt.empty())
+		{
+			EXPECT_EQ(queueOfInt.front(), expected++);
+			queueOfInt.pop_front();
+		}
+		EXPECT_EQ(expected, 200);
+		EXPECT_EQ(queueOfInt.cluster_count(), 1u);
+		EXPECT_EQ(queueOfInt.begin(), queueOfInt.end());
+
+		queueOfInt.shrink_to_fit();
+		EXPECT_EQ(queueOfInt.cluster_count(), 0u);
+		queueOfInt.push_back(5);
+		EXPECT_EQ(queueOfInt.front(), 5);
+	}
+
+	{
+		//Interleaved pushes and pops against std::deque
+		sw::cluster_queue<int, default_allocator, 1> queueOfInt(8);
+		std::deque<int> reference;
+		for (int i = 0; i < 5000; ++i)
+		{
+			queueOfInt.push_back(i);
+			reference.push_back(i);
+			if (i % 3 == 0)
+			{
+				queueOfInt.pop_front();
+				reference.pop_front();
+			}
+			if (!reference.empty())
+			{
+				EXPECT_EQ(queueOfInt.front(), reference.front());
+				EXPECT_EQ(queueOfInt.back(), reference.back());
+			}
+		}
+		EXPECT_EQ(queueOfInt.size(), reference.size());
+		//Only the clusters from the first to the last queued element are held
+		EXPECT_EQ(queueOfInt.cluster_count(), 4999u / 8u - 1667u / 8u + 1u);
+		EXPECT_TRUE(std::equal(reference.begin(), reference.end(), queueOfInt.begin()));
+	}
+}
+
+TEST(cluster_queue_test, retention_test)
+{
+	{
+		sw::cluster_queue<int, default_allocator, 1> queueOfInt(10);
+		for (int i = 0; i < 95; ++i)
+		{
+			queueOfInt.push_back(i);
+		}
+
+		//Keeps the newest 30 plus whatever shares a cluster with them
+		EXPECT_EQ(queueOfInt.trim_front(30), 60u);
+		EXPECT_EQ(queueOfInt.size(), 35u);
+		EXPECT_EQ(queueOfInt.front(), 60);
+		EXPECT_EQ(queueOfInt.cluster_count(), 4u);
+		EXPECT_EQ(queueOfInt.trim_front(30), 0u);
+
+		queueOfInt.pop_front();
+		EXPECT_EQ(queueOfInt.pop_front_cluster(), 9u);
+		EXPECT_EQ(queueOfInt.front(), 70);
+
+		EXPECT_EQ(queueOfInt.trim_front(0), 25u);
+		EXPECT_TRUE(queueOfInt.empty());
+	}
+
+	{
+		std::shared_ptr<int> shared = std::make_shared<int>(1);
+		{
+			sw::cluster_queue<std::shared_ptr<int>, default_allocator> queueOfShared(4);
+			for (int i = 0; i < 50; ++i)
+			{
+				queueOfShared.push_back(shared);
+			}
+			EXPECT_EQ(queueOfShared.pop_front_cluster(), 4u);
+			EXPECT_EQ(shared.use_count(), 47);
+			queueOfShared.pop_front();
+			EXPECT_EQ(shared.use_count(), 46);
+
+			sw::cluster_queue<std::shared_ptr<int>, default_allocator> moved(std::move(queueOfShared));
+			EXPECT_TRUE(queueOfShared.empty());
+			EXPECT_EQ(moved.size(), 45u);
+		}
+		EXPECT_EQ(shared.use_count(), 1);
+	}
+}
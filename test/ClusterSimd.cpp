@@ -0,0 +1,105 @@
+#include "../include/ClusterSimd.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+//Small integral values keep float sums and products exact whatever the summation order
+template <typename T>
+std::vector<T> make_values(size_t count, uint32_t seed)
+{
+	std::vector<T> values(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		values[i] = static_cast<T>(static_cast<int>((seed >> 16) % 101u) - 50);
+	}
+	return values;
+}
+
+template <typename T>
+void check_kernels(sw::simd_level level)
+{
+	sw::detail::simd_kernel_table<T> kernels = sw::detail::simd_kernels<T>(level);
+	for (size_t count : { 0u, 1u, 2u, 3u, 7u, 8u, 15u, 16u, 17u, 31u, 33u, 64u, 65u, 1023u, 3001u })
+	{
+		std::vector<T> values = make_values<T>(count, static_cast<uint32_t>(count));
+		std::vector<T> others = make_values<T>(count, static_cast<uint32_t>(count) + 7u);
+		T const * first = values.data();
+		T const * last = first + count;
+
+		EXPECT_EQ(kernels.mSum(first, last), std::accumulate(first, last, T(0)));
+		EXPECT_EQ(kernels.mDot(first, last, others.data()), std::inner_product(first, last, others.data(), T(0)));
+		EXPECT_EQ(kernels.mFind(first, last, T(13)), std::find(first, last, T(13)));
+		EXPECT_EQ(kernels.mFind(first, last, T(1000)), last);
+		EXPECT_EQ(kernels.mCount(first, last, T(-7)), static_cast<size_t>(std::count(first, last, T(-7))));
+		if (count)
+		{
+			EXPECT_EQ(kernels.mMin(first, last), *std::min_element(first, last));
+			EXPECT_EQ(kernels.mMax(first, last), *std::max_element(first, last));
+			EXPECT_EQ(kernels.mArgMin(first, last), static_cast<size_t>(std::min_element(first, last) - first));
+			EXPECT_EQ(kernels.mArgMax(first, last), static_cast<size_t>(std::max_element(first, last) - first));
+		}
+	}
+}
+
+TEST(cluster_simd_test, kernel_test)
+{
+	sw::simd_level detected = sw::detect_simd_level();
+	for (int level = 0; level <= static_cast<int>(detected); level++)
+	{
+		check_kernels<float>(static_cast<sw::simd_level>(level));
+		check_kernels<double>(static_cast<sw::simd_level>(level));
+		check_kernels<int32_t>(static_cast<sw::simd_level>(level));
+		check_kernels<int64_t>(static_cast<sw::simd_level>(level));
+	}
+	EXPECT_LE(static_cast<int>(sw::active_simd_level()), static_cast<int>(detected));
+}
+
+template <typename T>
+void check_container()
+{
+	std::vector<T> values = make_values<T>(5000, 3u);
+	std::vector<T> others = make_values<T>(5000, 4u);
+	sw::cluster_vector<T, default_allocator> vectorA(3);
+	sw::cluster_vector<T, default_allocator> vectorB(40);
+	EXPECT_EQ(sw::simd_sum(vectorA), T(0));
+	EXPECT_EQ(sw::simd_argmin(vectorA), 0u);
+	EXPECT_EQ(sw::simd_find(vectorA, T(1)), 0u);
+	EXPECT_EQ(sw::simd_dot(vectorA, vectorB), T(0));
+
+	vectorA.append(values.begin(), values.end());
+	vectorB.append(others.begin(), others.end());
+
+	EXPECT_EQ(sw::simd_sum(vectorA), std::accumulate(values.begin(), values.end(), T(0)));
+	EXPECT_EQ(sw::simd_min(vectorA), *std::min_element(values.begin(), values.end()));
+	EXPECT_EQ(sw::simd_max(vectorA), *std::max_element(values.begin(), values.end()));
+	EXPECT_EQ(sw::simd_argmin(vectorA), static_cast<size_t>(std::min_element(values.begin(), values.end()) - values.begin()));
+	EXPECT_EQ(sw::simd_argmax(vectorA), static_cast<size_t>(std::max_element(values.begin(), values.end()) - values.begin()));
+	EXPECT_EQ(sw::simd_count(vectorA, T(5)), static_cast<size_t>(std::count(values.begin(), values.end(), T(5))));
+	EXPECT_EQ(sw::simd_dot(vectorA, vectorB), std::inner_product(values.begin(), values.end(), others.begin(), T(0)));
+
+	//Put the only match past a cluster edge
+	vectorA[4000] = T(77);
+	EXPECT_EQ(sw::simd_find(vectorA, T(77)), 4000u);
+	EXPECT_EQ(sw::simd_argmax(vectorA), 4000u);
+	vectorA[4999] = T(-77);
+	EXPECT_EQ(sw::simd_argmin(vectorA), 4999u);
+	EXPECT_EQ(sw::simd_find(vectorA, T(99)), vectorA.size());
+}
+
+TEST(cluster_simd_test, container_test)
+{
+	check_container<float>();
+	check_container<double>();
+	check_container<int32_t>();
+	check_container<int64_t>();
+}
@@ -0,0 +1,232 @@
+#include "../include/ClusterSnapshot.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+struct particle
+{
+	float mPosition[3];
+	int mId;
+};
+
+template <typename Container>
+bool save_file(char const * path, Container const & container)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+#if defined(_WIN32)
+	bool saved = sw::save(_fileno(file), container);
+#else
+	bool saved = sw::save(fileno(file), container);
+#endif
+	fclose(file);
+	return saved;
+}
+
+TEST(cluster_snapshot_test, vector_test)
+{
+	char const * path = "cluster_snapshot_vector.bin";
+	{
+		sw::cluster_vector<particle, default_allocator> particles(4);
+		for (int i = 0; i < 1000; i++)
+		{
+			particles.push_back(particle{ { float(i), float(i * 2), float(i * 3) }, i });
+		}
+		ASSERT_TRUE(save_file(path, particles));
+	}
+
+	{
+		sw::cluster_vector<particle, default_allocator> loaded(4);
+		ASSERT_TRUE(sw::load_mapped(path, loaded));
+		EXPECT_EQ(loaded.size(), 1000u);
+		EXPECT_EQ(loaded.cluster_count(), 1u);
+		EXPECT_TRUE(loaded.data() != nullptr);
+		int expected = 0;
+		for (particle const & p : loaded)
+		{
+			EXPECT_EQ(p.mId, expected);
+			EXPECT_EQ(p.mPosition[2], float(expected * 3));
+			++expected;
+		}
+		EXPECT_EQ(expected, 1000);
+
+		//Writes stay private to the mapping
+		loaded[10].mId = -1;
+		for (int i = 1000; i < 1100; i++)
+		{
+			loaded.push_back(particle{ { 0.0f, 0.0f, 0.0f }, i });
+		}
+		EXPECT_EQ(loaded[10].mId, -1);
+		EXPECT_EQ(loaded[999].mId, 999);
+		EXPECT_EQ(loaded[1099].mId, 1099);
+		loaded.erase_unsorted(loaded.begin());
+		EXPECT_EQ(loaded[0].mId, 1099);
+	}
+
+	{
+		sw::cluster_vector<particle, default_allocator> reloaded(4);
+		ASSERT_TRUE(sw::load_mapped(path, reloaded));
+		EXPECT_EQ(reloaded[10].mId, 10);
+		EXPECT_EQ(reloaded[0].mId, 0);
+
+		//Compacting moves the elements off the mapping and releases it
+		reloaded.push_back(particle{ { 0.0f, 0.0f, 0.0f }, 1000 });
+		reloaded.compact();
+		EXPECT_EQ(reloaded[1000].mId, 1000);
+		EXPECT_EQ(reloaded[500].mId, 500);
+	}
+
+	{
+		//A snapshot of another element type is refused
+		sw::cluster_vector<double, default_allocator> mismatched(4);
+		mismatched.push_back(1.0);
+		EXPECT_FALSE(sw::load_mapped(path, mismatched));
+		EXPECT_TRUE(mismatched.empty());
+		EXPECT_FALSE(sw::load_mapped("cluster_snapshot_missing.bin", mismatched));
+	}
+
+	{
+		sw::cluster_vector<particle, default_allocator> empty(4);
+		ASSERT_TRUE(save_file(path, empty));
+		sw::cluster_vector<particle, default_allocator> loaded(4);
+		loaded.push_back(particle{});
+		EXPECT_TRUE(sw::load_mapped(path, loaded));
+		EXPECT_TRUE(loaded.empty());
+	}
+	remove(path);
+}
+
+TEST(cluster_snapshot_test, map_test)
+{
+	char const * path = "cluster_snapshot_map.bin";
+	std::vector<sw::cluster_map_key> keys{};
+	{
+		std::vector<sw::cluster_map_handle<particle>> handleVec{};
+		sw::cluster_map<particle, default_allocator> particles(4);
+		for (int i = 0; i < 500; i++)
+		{
+			handleVec.push_back(particles.insert(particle{ { float(i), 0.0f, 0.0f }, i }));
+		}
+		for (int i = 0; i < 500; i++)
+		{
+			keys.push_back(particles.key_of(handleVec[i]));
+		}
+		for (int i = 0; i < 500; i += 5)
+		{
+			particles.erase(handleVec[i]);
+		}
+		ASSERT_TRUE(save_file(path, particles));
+	}
+
+	sw::cluster_map<particle, default_allocator> loaded(4);
+	ASSERT_TRUE(sw::load_mapped(path, loaded));
+	EXPECT_EQ(loaded.size(), 400u);
+	EXPECT_EQ(loaded.sparse_indices().size(), 500u);
+	EXPECT_EQ(loaded.unoccupied_list().size(), 100u);
+
+	std::vector<int> seen(500, 0);
+	for (particle const & p : loaded)
+	{
+		EXPECT_NE(p.mId % 5, 0);
+		EXPECT_EQ(p.mPosition[0], float(p.mId));
+		seen[p.mId]++;
+	}
+	for (int i = 0; i < 500; i++)
+	{
+		EXPECT_EQ(seen[i], i % 5 ? 1 : 0);
+	}
+
+	//Keys taken before saving still resolve, and still reject the erased elements
+	for (int i = 0; i < 500; i++)
+	{
+		EXPECT_EQ(loaded.contains(keys[i]), i % 5 != 0);
+		if (i % 5)
+		{
+			EXPECT_EQ(loaded.find(keys[i])->mId, i);
+		}
+	}
+
+	//Handles resolve through the rebuilt sparse indices into the mapping
+	sw::cluster_map_handle<particle> first = loaded.front();
+	int firstId = sw::at(first).mId;
+	sw::cluster_map_handle<particle> last = loaded.back();
+	loaded.erase(last);
+	EXPECT_EQ(sw::at(first).mId, firstId);
+
+	std::vector<sw::cluster_map_handle<particle>> handleVec{};
+	for (int i = 0; i < 150; i++)
+	{
+		handleVec.push_back(loaded.insert(particle{ { 0.0f, 0.0f, 0.0f }, 1000 + i }));
+	}
+	EXPECT_EQ(loaded.size(), 549u);
+	EXPECT_EQ(loaded.sparse_indices().size(), 549u);
+	for (int i = 0; i < 150; i++)
+	{
+		EXPECT_EQ(sw::at(handleVec[i]).mId, 1000 + i);
+	}
+	EXPECT_EQ(sw::at(first).mId, firstId);
+
+	loaded.clear();
+
+	//Files that name a sparse slot twice are rejected rather than loaded into a map that would write through stale pointers
+	{
+		sw::cluster_map<particle, default_allocator> particles(4);
+		sw::cluster_map_handle<particle> erased = particles.insert(particle{ { 0.0f, 0.0f, 0.0f }, 0 });
+		particles.insert(particle{ { 1.0f, 0.0f, 0.0f }, 1 });
+		particles.insert(particle{ { 2.0f, 0.0f, 0.0f }, 2 });
+		particles.erase(erased);
+		ASSERT_TRUE(save_file(path, particles));
+	}
+	std::vector<char> image;
+	{
+		FILE* file = fopen(path, "rb");
+		ASSERT_TRUE(file != nullptr);
+		char buffer[4096];
+		for (size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) != 0u; )
+		{
+			image.insert(image.end(), buffer, buffer + read);
+		}
+		fclose(file);
+	}
+	sw::snapshot_header header;
+	memcpy(&header, image.data(), sizeof(header));
+	ASSERT_EQ(header.mCount, 2u);
+	ASSERT_EQ(header.mFreeCount, 1u);
+	size_t const denseSlotsOffset = size_t(header.mDenseSlotOffset);
+	auto loadPatched = [&](size_t offset, void const * bytes, size_t size)
+	{
+		std::vector<char> patched(image);
+		memcpy(patched.data() + offset, bytes, size);
+		FILE* file = fopen(path, "wb");
+		fwrite(patched.data(), 1, patched.size(), file);
+		fclose(file);
+		return sw::load_mapped(path, loaded);
+	};
+	uint32_t firstSlot;
+	memcpy(&firstSlot, image.data() + denseSlotsOffset, sizeof(firstSlot));
+
+	//Two dense elements in one slot
+	EXPECT_FALSE(loadPatched(denseSlotsOffset + sizeof(firstSlot), &firstSlot, sizeof(firstSlot)));
+	EXPECT_TRUE(loaded.empty());
+	//A live slot also on the free list
+	uint64_t freeSlot = firstSlot;
+	EXPECT_FALSE(loadPatched(size_t(header.mFreeOffset), &freeSlot, sizeof(freeSlot)));
+	EXPECT_TRUE(loaded.empty());
+	//The untouched image still loads
+	EXPECT_TRUE(loadPatched(0u, image.data(), 0u));
+	EXPECT_EQ(loaded.size(), 2u);
+
+	loaded.clear();
+	remove(path);
+}
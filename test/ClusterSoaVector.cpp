@@ -0,0 +1,207 @@
+#include "../include/ClusterSoaVector.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <list>
+#include <string>
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+struct alignas(32) wide_field
+{
+	float mValues[8];
+};
+
+TEST(cluster_soa_vector_test, push_back_test)
+{
+	{
+		sw::cluster_soa_vector<std::tuple<int, double, char>, default_allocator> soa(4);
+		EXPECT_TRUE(soa.empty());
+		EXPECT_EQ(soa.size(), 0u);
+
+		for (int i = 0; i < 100; i++)
+		{
+			soa.push_back(i, i * 0.5, char('a' + i % 26));
+		}
+		EXPECT_EQ(soa.size(), 100u);
+		EXPECT_GE(soa.capacity(), 100u);
+
+		for (int i = 0; i < 100; i++)
+		{
+			EXPECT_EQ(soa.get<0>(i), i);
+			EXPECT_EQ(soa.get<1>(i), i * 0.5);
+			EXPECT_EQ(std::get<2>(soa[i]), char('a' + i % 26));
+		}
+
+		std::get<0>(soa[10]) = -10;
+		EXPECT_EQ(soa.get<0>(10), -10);
+		EXPECT_EQ(std::get<1>(soa.at(99)), 49.5);
+
+		auto pushed = soa.push_back();
+		EXPECT_EQ(std::get<0>(pushed), 0);
+		EXPECT_EQ(std::get<1>(pushed), 0.0);
+		EXPECT_EQ(soa.size(), 101u);
+	}
+
+	{
+		sw::cluster_soa_vector<std::tuple<std::string, int>, default_allocator> soa(4);
+		soa.reserve(100);
+		size_t const capacity = soa.capacity();
+		EXPECT_GE(capacity, 100u);
+		for (int i = 0; i < 100; i++)
+		{
+			auto pushed = soa.push_back_uninitialized();
+			new (&std::get<0>(pushed)) std::string(std::to_string(i));
+			new (&std::get<1>(pushed)) int(i);
+		}
+		EXPECT_EQ(soa.capacity(), capacity);
+		EXPECT_EQ(soa.get<0>(99), "99");
+		EXPECT_EQ(soa.get<1>(42), 42);
+	}
+
+	{
+		//Columns keep their own alignment
+		sw::cluster_soa_vector<std::tuple<char, wide_field, short>, default_allocator> soa(3);
+		for (int i = 0; i < 20; i++)
+		{
+			wide_field field{};
+			field.mValues[0] = float(i);
+			soa.push_back(char(i), field, short(i));
+		}
+		for (auto segment : soa.segments())
+		{
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(segment.column<1>().begin()) % alignof(wide_field), 0u);
+			EXPECT_EQ(reinterpret_cast<uintptr_t>(segment.column<2>().begin()) % alignof(short), 0u);
+		}
+		EXPECT_EQ(soa.get<1>(17).mValues[0], 17.0f);
+	}
+}
+
+TEST(cluster_soa_vector_test, segments_test)
+{
+	sw::cluster_soa_vector<std::tuple<float, int>, default_allocator> soa(4);
+	EXPECT_TRUE(soa.segments().begin() == soa.segments().end());
+
+	for (int i = 0; i < 50; i++)
+	{
+		soa.push_back(float(i), i * 2);
+	}
+
+	//Addresses stay put as the container grows
+	float* firstAddress = &soa.get<0>(0);
+	int* midAddress = &soa.get<1>(25);
+
+	size_t expectedStart = 0u;
+	size_t segmentCount = 0u;
+	for (auto segment : soa.segments())
+	{
+		EXPECT_EQ(segment.start_index(), expectedStart);
+		auto positions = segment.column<0>();
+		auto ids = segment.column<1>();
+		EXPECT_EQ(positions.size(), segment.size());
+		for (size_t i = 0; i < segment.size(); i++)
+		{
+			EXPECT_EQ(positions[i], float(expectedStart + i));
+			EXPECT_EQ(ids[i], int(expectedStart + i) * 2);
+			positions[i] += 1.0f;
+		}
+		expectedStart += segment.size();
+		segmentCount++;
+	}
+	EXPECT_EQ(expectedStart, 50u);
+	EXPECT_EQ(segmentCount, soa.cluster_count());
+
+	for (int i = 50; i < 500; i++)
+	{
+		soa.push_back(float(i), i * 2);
+	}
+	EXPECT_EQ(firstAddress, &soa.get<0>(0));
+	EXPECT_EQ(midAddress, &soa.get<1>(25));
+	EXPECT_EQ(*firstAddress, 1.0f);
+
+	const auto& constSoa = soa;
+	float total = 0.0f;
+	for (auto segment : constSoa.segments())
+	{
+		for (float position : segment.column<0>())
+		{
+			total += position;
+		}
+	}
+	EXPECT_EQ(total, 50.0f * 51.0f / 2.0f + 450.0f * (50.0f + 499.0f) / 2.0f);
+}
+
+TEST(cluster_soa_vector_test, erase_test)
+{
+	{
+		sw::cluster_soa_vector<std::tuple<std::string, std::list<int>>, default_allocator> soa(2);
+		for (int i = 0; i < 20; i++)
+		{
+			soa.push_back(std::to_string(i), std::list<int>(size_t(i), i));
+		}
+
+		soa.erase_unsorted(3);
+		EXPECT_EQ(soa.size(), 19u);
+		EXPECT_EQ(soa.get<0>(3), "19");
+		EXPECT_EQ(soa.get<1>(3).size(), 19u);
+
+		soa.erase_unsorted(18);
+		EXPECT_EQ(soa.size(), 18u);
+		EXPECT_EQ(soa.get<0>(17), "17");
+
+		while (!soa.empty())
+		{
+			soa.pop_back();
+		}
+		EXPECT_EQ(soa.cluster_count(), 0u);
+
+		soa.push_back(std::string("again"), std::list<int>{ 1, 2 });
+		EXPECT_EQ(soa.get<0>(0), "again");
+		soa.clear();
+		EXPECT_TRUE(soa.empty());
+
+		for (int i = 0; i < 10; i++)
+		{
+			soa.push_back(std::to_string(i), std::list<int>(3u, i));
+		}
+	}
+
+	{
+		sw::cluster_soa_vector<std::tuple<int, int>, default_allocator, 2u, sw::page_rounded_growth<2u, 256u>> soa(4);
+		for (int i = 0; i < 1000; i++)
+		{
+			soa.push_back(i, -i);
+		}
+		for (int i = 0; i < 1000; i += 37)
+		{
+			EXPECT_EQ(soa.get<0>(i), i);
+			EXPECT_EQ(soa.get<1>(i), -i);
+		}
+	}
+
+	{
+		//Move assignment takes the other vector's clusters and cluster sizes, and releases its own
+		sw::cluster_soa_vector<std::tuple<std::string, int>, default_allocator> source(3);
+		sw::cluster_soa_vector<std::tuple<std::string, int>, default_allocator> target(16);
+		for (int i = 0; i < 40; i++)
+		{
+			source.push_back(std::to_string(i), i);
+		}
+		target.push_back(std::string("dropped"), -1);
+		target = std::move(source);
+		EXPECT_EQ(target.size(), 40u);
+		EXPECT_TRUE(source.empty());
+		for (int i = 0; i < 40; i++)
+		{
+			EXPECT_EQ(target.get<0>(i), std::to_string(i));
+		}
+		target.push_back(std::string("40"), 40);
+		EXPECT_EQ(target.get<1>(40), 40);
+		source.push_back(std::string("reused"), 0);
+		EXPECT_EQ(source.get<0>(0), "reused");
+	}
+}
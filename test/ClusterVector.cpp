@@ -1,176 +1,781 @@
-#include "../include/ClusterVector.h"
-#include <gtest/gtest.h>
-
-#include <list>
-#include <stdio.h>
-
-class default_allocator
-{
-public:
-
-	void* allocate(size_t n)
-	{
-		return _aligned_malloc(n, 8);
-	}
-
-	void* allocate(size_t n, size_t alignment, size_t alignmentOffset)
-	{
-		if ((alignmentOffset % alignment) == 0)
-		{
-			return _aligned_malloc(n, alignment);
-		}
-
-		return NULL;
-	}
-
-	void deallocate(void* p, size_t n)
-	{
-		_aligned_free(p);
-	}
-};
-
-int main(int argc, char **argv) {
-	::testing::InitGoogleTest(&argc, argv);
-	return RUN_ALL_TESTS();
-}
-
-template < typename T>
-void print_cluster(sw::cluster<T> const& p_cluster, int cluster_num)
-{
-	std::cout << "Cluster " << cluster_num << " : Capacity " << p_cluster.capacity() << " : Length " << p_cluster.size() << " : ["; 
-	for (int i : p_cluster)
-	{
-		std::cout << i << ", ";
-	}
-	std::cout << "]";
-}
-
-template < typename T, typename A >
-void print_cluster_vector(sw::cluster_vector<T, A> const& p_vec)
-{
-	int cluster_num = 1;
-	auto* cluster = p_vec.first_cluster();
-	print_cluster(*cluster, cluster_num);
-	std::cout << std::endl;
-
-	while(!cluster->is_last_cluster())
-	{
-		cluster = cluster->next_cluster();
-		cluster_num++;
-		print_cluster(*cluster, cluster_num);
-		std::cout << std::endl;
-	}
-}
-
-TEST(cluster_vector_test, push_back_test)
-{
-	{
-		sw::cluster_vector<int, default_allocator> sv(8);
-		sv.push_back(0);
-		sv.push_back(1);
-		sv.push_back(2);
-		sv.push_back(3);
-
-		{
-			auto i = sv.begin();
-			EXPECT_EQ(*i  , 0);
-			EXPECT_EQ(*i++ , 0);
-			EXPECT_EQ(*i++ , 1);
-			EXPECT_EQ(*i++ , 2);
-			EXPECT_EQ(*i++ , 3);
-		}
-
-		{
-			auto i = sv.begin();
-			EXPECT_EQ(*i , 0);
-			EXPECT_EQ(*(++i) , 1);
-			EXPECT_EQ(*(++i) , 2);
-			EXPECT_EQ(*(++i) , 3);
-		}
-	}
-}
-
-TEST(cluster_vector_test, empty_test)
-{
-	{
-		sw::cluster_vector<int, default_allocator> vectorOfInt(8);
-		sw::cluster_vector<std::list<int>, default_allocator> vectorOfListOfTO(8);
-		EXPECT_TRUE(vectorOfInt.empty());
-		EXPECT_TRUE(vectorOfListOfTO.empty());
-	}
-}
-
-TEST(cluster_vector_test, cluster_count_test)
-{
-	{
-		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
-		vectorOfInt.push_back(42);
-		EXPECT_EQ(vectorOfInt.size() , 1);
-		EXPECT_EQ(vectorOfInt.cluster_count() , 1);
-		EXPECT_EQ(vectorOfInt.empty() , false);
-
-		vectorOfInt.push_back(43);
-		vectorOfInt.push_back(44);
-		vectorOfInt.push_back(45);
-		vectorOfInt.push_back(46);
-		EXPECT_EQ(vectorOfInt.size() , 5);
-		EXPECT_EQ(vectorOfInt.cluster_count() , 2);
-
-		EXPECT_EQ(vectorOfInt.front() , 42);
-		EXPECT_EQ(vectorOfInt.back() , 46);
-
-		vectorOfInt.pop_back();
-		EXPECT_EQ(vectorOfInt.size() , 4);
-		EXPECT_EQ(vectorOfInt.cluster_count(), 1);
-
-		vectorOfInt.clear();
-		EXPECT_TRUE(vectorOfInt.empty());
-		EXPECT_EQ(vectorOfInt.size() , 0);
-		EXPECT_EQ(vectorOfInt.cluster_count() , 0);
-	}
-}
-
-TEST(cluster_vector_test, foreach_test)
-{
-	{
-		std::vector<int> initValues{};
-		uint32_t const numValues = 2048u;
-		initValues.reserve(numValues);
-		for (int i = 0; i < numValues; i++)
-		{
-			initValues.push_back(i);
-		}
-
-		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
-		EXPECT_EQ(vectorOfInt.size(), 0);
-		EXPECT_EQ(vectorOfInt.cluster_count() , 0);
-		EXPECT_EQ(vectorOfInt.empty() , true);
-		for (int i : initValues)
-		{
-			vectorOfInt.push_back(i);
-		}
-
-		EXPECT_EQ(vectorOfInt.size() , 2048u);
-		EXPECT_EQ(vectorOfInt.cluster_count() , 10);
-		EXPECT_EQ(vectorOfInt.empty() , false);
-
-		int j = 0;
-		for (int i : vectorOfInt)
-		{
-			EXPECT_EQ(i, initValues[j]);
-			j++;
-		}
-
-		
-		for (int l : initValues)
-		{
-			int k = 0;
-			for (int i : vectorOfInt)
-			{
-				EXPECT_EQ(i, initValues[k]);
-				k++;
-			}
-			vectorOfInt.pop_back();
-		}	
-	}
-}
+#include "../include/ClusterVector.h"
+#include <gtest/gtest.h>
+#include "TestAllocator.h"
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+class counting_allocator : public default_allocator
+{
+public:
+	static size_t sAllocationCount;
+
+	void* allocate(size_t n)
+	{
+		++sAllocationCount;
+		return default_allocator::allocate(n);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset)
+	{
+		++sAllocationCount;
+		return default_allocator::allocate(n, alignment, alignmentOffset);
+	}
+};
+
+size_t counting_allocator::sAllocationCount = 0u;
+
+int main(int argc, char **argv) {
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
+
+template < typename T>
+void print_cluster(sw::cluster<T> const& p_cluster, int cluster_num)
+{
+	std::cout << "Cluster " << cluster_num << " : Capacity " << p_cluster.capacity() << " : Length " << p_cluster.size() << " : ["; 
+	for (int i : p_cluster)
+	{
+		std::cout << i << ", ";
+	}
+	std::cout << "]";
+}
+
+template < typename T, typename A >
+void print_cluster_vector(sw::cluster_vector<T, A> const& p_vec)
+{
+	int cluster_num = 1;
+	auto* cluster = p_vec.first_cluster();
+	print_cluster(*cluster, cluster_num);
+	std::cout << std::endl;
+
+	while(!cluster->is_last_cluster())
+	{
+		cluster = cluster->next_cluster();
+		cluster_num++;
+		print_cluster(*cluster, cluster_num);
+		std::cout << std::endl;
+	}
+}
+
+TEST(cluster_vector_test, push_back_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> sv(8);
+		sv.push_back(0);
+		sv.push_back(1);
+		sv.push_back(2);
+		sv.push_back(3);
+
+		{
+			auto i = sv.begin();
+			EXPECT_EQ(*i  , 0);
+			EXPECT_EQ(*i++ , 0);
+			EXPECT_EQ(*i++ , 1);
+			EXPECT_EQ(*i++ , 2);
+			EXPECT_EQ(*i++ , 3);
+		}
+
+		{
+			auto i = sv.begin();
+			EXPECT_EQ(*i , 0);
+			EXPECT_EQ(*(++i) , 1);
+			EXPECT_EQ(*(++i) , 2);
+			EXPECT_EQ(*(++i) , 3);
+		}
+	}
+}
+
+TEST(cluster_vector_test, empty_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(8);
+		sw::cluster_vector<std::list<int>, default_allocator> vectorOfListOfTO(8);
+		EXPECT_TRUE(vectorOfInt.empty());
+		EXPECT_TRUE(vectorOfListOfTO.empty());
+	}
+}
+
+TEST(cluster_vector_test, cluster_count_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		vectorOfInt.push_back(42);
+		EXPECT_EQ(vectorOfInt.size() , 1);
+		EXPECT_EQ(vectorOfInt.cluster_count() , 1);
+		EXPECT_EQ(vectorOfInt.empty() , false);
+
+		vectorOfInt.push_back(43);
+		vectorOfInt.push_back(44);
+		vectorOfInt.push_back(45);
+		vectorOfInt.push_back(46);
+		EXPECT_EQ(vectorOfInt.size() , 5);
+		EXPECT_EQ(vectorOfInt.cluster_count() , 2);
+
+		EXPECT_EQ(vectorOfInt.front() , 42);
+		EXPECT_EQ(vectorOfInt.back() , 46);
+
+		vectorOfInt.pop_back();
+		EXPECT_EQ(vectorOfInt.size() , 4);
+		EXPECT_EQ(vectorOfInt.cluster_count(), 1);
+
+		vectorOfInt.clear();
+		EXPECT_TRUE(vectorOfInt.empty());
+		EXPECT_EQ(vectorOfInt.size() , 0);
+		EXPECT_EQ(vectorOfInt.cluster_count() , 0);
+	}
+}
+
+TEST(cluster_vector_test, foreach_test)
+{
+	{
+		std::vector<int> initValues{};
+		uint32_t const numValues = 2048u;
+		initValues.reserve(numValues);
+		for (int i = 0; i < numValues; i++)
+		{
+			initValues.push_back(i);
+		}
+
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		EXPECT_EQ(vectorOfInt.size(), 0);
+		EXPECT_EQ(vectorOfInt.cluster_count() , 0);
+		EXPECT_EQ(vectorOfInt.empty() , true);
+		for (int i : initValues)
+		{
+			vectorOfInt.push_back(i);
+		}
+
+		EXPECT_EQ(vectorOfInt.size() , 2048u);
+		EXPECT_EQ(vectorOfInt.cluster_count() , 10);
+		EXPECT_EQ(vectorOfInt.empty() , false);
+
+		int j = 0;
+		for (int i : vectorOfInt)
+		{
+			EXPECT_EQ(i, initValues[j]);
+			j++;
+		}
+
+		
+		for (int l : initValues)
+		{
+			int k = 0;
+			for (int i : vectorOfInt)
+			{
+				EXPECT_EQ(i, initValues[k]);
+				k++;
+			}
+			vectorOfInt.pop_back();
+		}	
+	}
+}
+
+TEST(cluster_vector_test, random_access_test)
+{
+	{
+		uint32_t const numValues = 2048u;
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		for (int i = 0; i < numValues; i++)
+		{
+			vectorOfInt.push_back(i * 2);
+		}
+
+		for (int i = 0; i < numValues; i++)
+		{
+			EXPECT_EQ(vectorOfInt[i], i * 2);
+			EXPECT_EQ(vectorOfInt.at(i), i * 2);
+		}
+
+		auto first = vectorOfInt.indexed_begin();
+		auto last = vectorOfInt.indexed_end();
+		EXPECT_EQ(last - first, numValues);
+		EXPECT_EQ(*(last - 1), vectorOfInt.back());
+		EXPECT_EQ(first[1000], 2000);
+
+		auto found = std::lower_bound(first, last, 1001);
+		EXPECT_EQ(found - first, 501);
+		EXPECT_EQ(*found, 1002);
+
+		vectorOfInt.pop_back();
+		EXPECT_EQ(vectorOfInt.indexed_end() - vectorOfInt.indexed_begin(), numValues - 1u);
+		EXPECT_EQ(vectorOfInt[numValues - 2u], (numValues - 2u) * 2);
+
+		sw::cluster_vector<int, default_allocator> const & constVector = vectorOfInt;
+		sw::cluster_vector<int, default_allocator>::const_indexed_iterator constFirst = vectorOfInt.indexed_begin();
+		EXPECT_EQ(constVector[7], 14);
+		EXPECT_EQ(*(constFirst + 7), 14);
+	}
+}
+
+TEST(cluster_vector_test, random_access_step_test)
+{
+	{
+		sw::cluster_vector<char, default_allocator> vectorOfChar(3);
+		for (int i = 0; i < 1000; i++)
+		{
+			vectorOfChar.push_back(static_cast<char>(i % 127));
+		}
+
+		EXPECT_EQ(vectorOfChar.size(), 1000u);
+		for (int i = 0; i < 1000; i++)
+		{
+			EXPECT_EQ(vectorOfChar[i], static_cast<char>(i % 127));
+		}
+	}
+}
+
+template <typename Vector>
+void check_growth_policy(Vector& vec, int numValues)
+{
+	for (int i = 0; i < numValues; i++)
+	{
+		vec.push_back(i);
+		EXPECT_EQ(vec.size(), static_cast<size_t>(i + 1));
+	}
+
+	for (int i = 0; i < numValues; i++)
+	{
+		EXPECT_EQ(vec[i], i);
+	}
+
+	size_t clusterTotal = 0u;
+	for (auto* cluster = vec.first_cluster(); cluster; cluster = cluster->next_cluster())
+	{
+		EXPECT_EQ(cluster->mStartIndex, clusterTotal);
+		clusterTotal += cluster->size();
+	}
+	EXPECT_EQ(clusterTotal, vec.size());
+
+	for (int i = numValues; i > 0; i--)
+	{
+		EXPECT_EQ(vec.size(), static_cast<size_t>(i));
+		vec.pop_back();
+	}
+	EXPECT_TRUE(vec.empty());
+}
+
+TEST(cluster_vector_test, growth_policy_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator, 3u> vectorOfInt(4);
+		check_growth_policy(vectorOfInt, 1000);
+	}
+
+	{
+		sw::cluster_vector<int, default_allocator, 1u> vectorOfInt(16);
+		check_growth_policy(vectorOfInt, 1000);
+		for (int i = 0; i < 100; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		EXPECT_EQ(vectorOfInt.cluster_count(), 7u);
+	}
+
+	{
+		sw::cluster_vector<int, default_allocator, 2u, sw::capped_geometric_growth<2u, 100u>> vectorOfInt(4);
+		check_growth_policy(vectorOfInt, 2000);
+		for (int i = 0; i < 2000; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		for (auto* cluster = vectorOfInt.first_cluster(); cluster; cluster = cluster->next_cluster())
+		{
+			EXPECT_LE(cluster->capacity(), 100u);
+		}
+	}
+
+	{
+		sw::cluster_vector<int, default_allocator, 2u, sw::page_rounded_growth<2u, 256u>> vectorOfInt(4);
+		check_growth_policy(vectorOfInt, 2000);
+		vectorOfInt.push_back(0);
+		using cluster_type = sw::cluster<int>;
+		EXPECT_EQ(cluster_type::allocation_size(vectorOfInt.first_cluster()->capacity()) % 256u, 0u);
+	}
+}
+
+TEST(cluster_vector_test, append_test)
+{
+	{
+		std::vector<int> initValues{};
+		for (int i = 0; i < 1000; i++)
+		{
+			initValues.push_back(i);
+		}
+
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		vectorOfInt.push_back(-1);
+		vectorOfInt.append(initValues.data(), initValues.data() + initValues.size());
+		EXPECT_EQ(vectorOfInt.size(), 1001u);
+		EXPECT_EQ(vectorOfInt.front(), -1);
+		for (int i = 0; i < 1000; i++)
+		{
+			EXPECT_EQ(vectorOfInt[i + 1], i);
+		}
+
+		vectorOfInt.append_n(100, 7);
+		EXPECT_EQ(vectorOfInt.size(), 1101u);
+		EXPECT_EQ(vectorOfInt.back(), 7);
+		EXPECT_EQ(vectorOfInt[1001], 7);
+
+		sw::cluster_vector<int, default_allocator> copyOfInt(vectorOfInt.begin(), vectorOfInt.end(), 8);
+		EXPECT_EQ(copyOfInt.size(), vectorOfInt.size());
+		for (size_t i = 0; i < copyOfInt.size(); i++)
+		{
+			EXPECT_EQ(copyOfInt[i], vectorOfInt[i]);
+		}
+	}
+
+	{
+		std::list<std::list<int>> initLists(37, std::list<int>{1, 2, 3});
+		sw::cluster_vector<std::list<int>, default_allocator> vectorOfList(initLists.begin(), initLists.end(), 4);
+		EXPECT_EQ(vectorOfList.size(), 37u);
+		for (auto const & l : vectorOfList)
+		{
+			EXPECT_EQ(l.size(), 3u);
+		}
+	}
+}
+
+TEST(cluster_vector_test, resize_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		vectorOfInt.resize(100);
+		EXPECT_EQ(vectorOfInt.size(), 100u);
+		EXPECT_EQ(vectorOfInt[99], 0);
+
+		vectorOfInt.resize(200, 5);
+		EXPECT_EQ(vectorOfInt.size(), 200u);
+		EXPECT_EQ(vectorOfInt[99], 0);
+		EXPECT_EQ(vectorOfInt[100], 5);
+
+		vectorOfInt.resize(13);
+		EXPECT_EQ(vectorOfInt.size(), 13u);
+		EXPECT_EQ(vectorOfInt.cluster_count(), 3u);
+		EXPECT_EQ(vectorOfInt.back(), 0);
+
+		vectorOfInt.resize(12);
+		EXPECT_EQ(vectorOfInt.cluster_count(), 2u);
+		vectorOfInt.resize(4);
+		EXPECT_EQ(vectorOfInt.cluster_count(), 1u);
+		EXPECT_EQ(vectorOfInt.size(), 4u);
+
+		vectorOfInt.resize(0);
+		EXPECT_TRUE(vectorOfInt.empty());
+		EXPECT_EQ(vectorOfInt.cluster_count(), 0u);
+	}
+
+	{
+		sw::cluster_vector<std::list<int>, default_allocator> vectorOfList(4);
+		vectorOfList.resize(50, std::list<int>{1, 2});
+		vectorOfList.resize(10);
+		EXPECT_EQ(vectorOfList.size(), 10u);
+		EXPECT_EQ(vectorOfList.back().size(), 2u);
+	}
+}
+
+TEST(cluster_vector_test, reserve_test)
+{
+	{
+		sw::cluster_vector<int, counting_allocator> vectorOfInt(4);
+		EXPECT_EQ(vectorOfInt.capacity(), 0u);
+
+		vectorOfInt.reserve(1000);
+		EXPECT_GE(vectorOfInt.capacity(), 1000u);
+		EXPECT_TRUE(vectorOfInt.empty());
+		EXPECT_EQ(vectorOfInt.cluster_count(), 0u);
+
+		size_t const allocations = counting_allocator::sAllocationCount;
+		for (int i = 0; i < 1000; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		for (int i = 0; i < 1000; i++)
+		{
+			vectorOfInt.pop_back();
+		}
+		vectorOfInt.resize(1000);
+		vectorOfInt.clear();
+		vectorOfInt.append_n(1000, 3);
+		EXPECT_EQ(counting_allocator::sAllocationCount, allocations);
+		EXPECT_EQ(vectorOfInt.size(), 1000u);
+		EXPECT_EQ(vectorOfInt[999], 3);
+
+		size_t const reservedCapacity = vectorOfInt.capacity();
+		vectorOfInt.resize(reservedCapacity + 1u);
+		EXPECT_GT(vectorOfInt.capacity(), reservedCapacity);
+		vectorOfInt.resize(10);
+		EXPECT_EQ(vectorOfInt.capacity(), reservedCapacity);
+	}
+}
+
+TEST(cluster_vector_test, spare_cluster_test)
+{
+	{
+		sw::cluster_vector<int, counting_allocator> vectorOfInt(4);
+		vectorOfInt.resize(12);
+		EXPECT_EQ(vectorOfInt.cluster_count(), 2u);
+
+		//Oscillate across the boundary between the second and third clusters
+		size_t const allocations = counting_allocator::sAllocationCount;
+		vectorOfInt.push_back(12);
+		for (int i = 0; i < 100; i++)
+		{
+			vectorOfInt.pop_back();
+			vectorOfInt.push_back(i);
+		}
+		EXPECT_EQ(counting_allocator::sAllocationCount, allocations + 1u);
+		EXPECT_EQ(vectorOfInt.cluster_count(), 3u);
+
+		vectorOfInt.clear();
+		EXPECT_EQ(vectorOfInt.capacity(), 4u);
+		vectorOfInt.push_back(0);
+		EXPECT_EQ(counting_allocator::sAllocationCount, allocations + 1u);
+
+		vectorOfInt.shrink_to_fit();
+		EXPECT_EQ(vectorOfInt.capacity(), 4u);
+		vectorOfInt.pop_back();
+		vectorOfInt.shrink_to_fit();
+		EXPECT_EQ(vectorOfInt.capacity(), 0u);
+	}
+
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		vectorOfInt.set_spare_cluster_limit(0);
+		vectorOfInt.resize(13);
+		vectorOfInt.pop_back();
+		EXPECT_EQ(vectorOfInt.capacity(), 12u);
+
+		vectorOfInt.set_spare_cluster_limit(2);
+		vectorOfInt.resize(100);
+		vectorOfInt.resize(4);
+		EXPECT_EQ(vectorOfInt.capacity(), 28u);
+
+		vectorOfInt.reserve(200);
+		vectorOfInt.shrink_to_fit();
+		EXPECT_EQ(vectorOfInt.capacity(), 4u);
+	}
+}
+
+//Owns a heap buffer through a plain pointer, so it is safe to relocate with memcpy
+struct owned_buffer
+{
+	owned_buffer(int value) : mData(new int(value)) {}
+	owned_buffer(owned_buffer&& other) : mData(other.mData) { other.mData = nullptr; }
+	owned_buffer(owned_buffer const &) = delete;
+	owned_buffer& operator=(owned_buffer const &) = delete;
+	~owned_buffer() { delete mData; }
+
+	int* mData;
+};
+
+namespace sw
+{
+	template <> struct is_trivially_relocatable<owned_buffer> : std::true_type {};
+}
+
+struct copy_counter
+{
+	copy_counter(int value) : mValue(value) {}
+	copy_counter(copy_counter const & other) : mValue(other.mValue) { ++sCopyCount; }
+	copy_counter(copy_counter&& other) : mValue(other.mValue) { ++sMoveCount; }
+	copy_counter& operator=(copy_counter const & other) { mValue = other.mValue; ++sCopyCount; return *this; }
+	copy_counter& operator=(copy_counter&& other) { mValue = other.mValue; ++sMoveCount; return *this; }
+
+	int mValue;
+	static int sCopyCount;
+	static int sMoveCount;
+};
+
+int copy_counter::sCopyCount = 0;
+int copy_counter::sMoveCount = 0;
+
+TEST(cluster_vector_test, move_test)
+{
+	{
+		sw::cluster_vector<std::unique_ptr<int>, default_allocator> vectorOfPtr(4);
+		for (int i = 0; i < 20; i++)
+		{
+			vectorOfPtr.emplace_back(new int(i));
+		}
+		std::unique_ptr<int> moved(new int(20));
+		vectorOfPtr.push_back(std::move(moved));
+		EXPECT_EQ(moved, nullptr);
+		EXPECT_EQ(*vectorOfPtr[20], 20);
+
+		auto it = vectorOfPtr.erase_unsorted(vectorOfPtr.begin());
+		EXPECT_EQ(**it, 20);
+		EXPECT_EQ(vectorOfPtr.size(), 20u);
+
+		//Erasing the back leaves nothing to relocate
+		auto last = vectorOfPtr.begin();
+		for (size_t i = 1; i < vectorOfPtr.size(); i++)
+		{
+			++last;
+		}
+		EXPECT_TRUE(vectorOfPtr.erase_unsorted(last) == vectorOfPtr.end());
+		EXPECT_EQ(vectorOfPtr.size(), 19u);
+		EXPECT_EQ(*vectorOfPtr[18], 18);
+	}
+
+	{
+		copy_counter::sCopyCount = 0;
+		copy_counter::sMoveCount = 0;
+		sw::cluster_vector<copy_counter, default_allocator> vectorOfCounter(4);
+		for (int i = 0; i < 10; i++)
+		{
+			vectorOfCounter.emplace_back(i);
+			vectorOfCounter.push_back(copy_counter(i));
+		}
+		EXPECT_EQ(copy_counter::sMoveCount, 10);
+
+		//Not trivially relocatable, so erasing move constructs the back into the hole
+		auto it = vectorOfCounter.begin();
+		vectorOfCounter.erase_unsorted(it);
+		EXPECT_EQ(vectorOfCounter[0].mValue, 9);
+		EXPECT_EQ(copy_counter::sMoveCount, 11);
+		EXPECT_EQ(copy_counter::sCopyCount, 0);
+	}
+
+	{
+		EXPECT_TRUE(sw::is_trivially_relocatable<int>::value);
+		EXPECT_FALSE(sw::is_trivially_relocatable<std::string>::value);
+		EXPECT_TRUE(sw::is_trivially_relocatable<owned_buffer>::value);
+
+		sw::cluster_vector<owned_buffer, default_allocator> vectorOfBuffer(2);
+		for (int i = 0; i < 30; i++)
+		{
+			vectorOfBuffer.emplace_back(i);
+		}
+		for (int i = 0; i < 10; i++)
+		{
+			auto it = vectorOfBuffer.begin();
+			vectorOfBuffer.erase_unsorted(it);
+		}
+		EXPECT_EQ(vectorOfBuffer.size(), 20u);
+		int total = 0;
+		for (owned_buffer& buffer : vectorOfBuffer)
+		{
+			total += *buffer.mData;
+		}
+		//0 and then 29 down to 21 were erased, each time relocating the next back element to the front
+		EXPECT_EQ(total, 30 * 29 / 2 - (29 + 21) * 9 / 2);
+		EXPECT_EQ(*vectorOfBuffer[0].mData, 20);
+	}
+}
+
+struct destroy_counter
+{
+	destroy_counter(int value) : mValue(value) {}
+	~destroy_counter() { ++sDestroyCount; }
+
+	int mValue;
+	static int sDestroyCount;
+};
+
+int destroy_counter::sDestroyCount = 0;
+
+TEST(cluster_vector_test, destroy_test)
+{
+	destroy_counter::sDestroyCount = 0;
+	{
+		sw::cluster_vector<destroy_counter, default_allocator> vectorOfCounter(4);
+		for (int i = 0; i < 29; i++)
+		{
+			vectorOfCounter.emplace_back(i);
+		}
+		//Full clusters and the partially filled last one are all destroyed
+		vectorOfCounter.clear();
+		EXPECT_EQ(destroy_counter::sDestroyCount, 29);
+		EXPECT_TRUE(vectorOfCounter.empty());
+
+		for (int i = 0; i < 13; i++)
+		{
+			vectorOfCounter.emplace_back(i);
+		}
+		EXPECT_EQ(vectorOfCounter[12].mValue, 12);
+	}
+	EXPECT_EQ(destroy_counter::sDestroyCount, 42);
+
+	{
+		sw::cluster_vector<std::unique_ptr<int>, default_allocator> vectorOfPtr(2);
+		for (int i = 0; i < 100; i++)
+		{
+			vectorOfPtr.emplace_back(new int(i));
+		}
+	}
+}
+
+TEST(cluster_vector_test, compact_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		EXPECT_TRUE(vectorOfInt.compact() == nullptr);
+
+		for (int i = 0; i < 100; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		EXPECT_GT(vectorOfInt.cluster_count(), 1u);
+		EXPECT_TRUE(vectorOfInt.data() == nullptr);
+
+		int* block = vectorOfInt.compact();
+		EXPECT_TRUE(block == vectorOfInt.data());
+		EXPECT_EQ(vectorOfInt.cluster_count(), 1u);
+		EXPECT_EQ(vectorOfInt.capacity(), 100u);
+		for (int i = 0; i < 100; i++)
+		{
+			EXPECT_EQ(block[i], i);
+			EXPECT_EQ(vectorOfInt[i], i);
+		}
+
+		//Already compact, so nothing moves
+		EXPECT_TRUE(vectorOfInt.compact() == block);
+
+		//The next cluster carries on from the compacted size rather than the initial capacity
+		vectorOfInt.push_back(100);
+		EXPECT_EQ(vectorOfInt.cluster_count(), 2u);
+		EXPECT_GT(vectorOfInt.capacity(), 200u);
+		vectorOfInt.pop_back();
+
+		//Growing past the compacted block still indexes correctly
+		for (int i = 100; i < 300; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		for (int i = 0; i < 300; i++)
+		{
+			EXPECT_EQ(vectorOfInt[i], i);
+		}
+		int expected = 0;
+		for (int value : vectorOfInt)
+		{
+			EXPECT_EQ(value, expected++);
+		}
+		EXPECT_EQ(expected, 300);
+
+		vectorOfInt.clear();
+		vectorOfInt.shrink_to_fit();
+		for (int i = 0; i < 50; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		EXPECT_EQ(vectorOfInt[49], 49);
+	}
+
+	{
+		sw::cluster_vector<std::unique_ptr<int>, default_allocator> vectorOfPtr(2);
+		for (int i = 0; i < 40; i++)
+		{
+			vectorOfPtr.emplace_back(new int(i));
+		}
+		std::unique_ptr<int>* block = vectorOfPtr.compact();
+		for (int i = 0; i < 40; i++)
+		{
+			EXPECT_EQ(*block[i], i);
+		}
+	}
+}
+
+TEST(cluster_vector_test, splice_test)
+{
+	{
+		sw::cluster_vector<int, default_allocator> vectorOfInt(4);
+		sw::cluster_vector<int, default_allocator> other(4);
+		for (int i = 0; i < 10; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		for (int i = 10; i < 110; i++)
+		{
+			other.push_back(i);
+		}
+		size_t const clusterCount = vectorOfInt.cluster_count() + other.cluster_count();
+		int* adopted = &other[50];
+
+		//The partly filled last cluster is relocated, other's clusters are linked as they are
+		vectorOfInt.splice_back(std::move(other));
+		EXPECT_TRUE(other.empty());
+		EXPECT_EQ(other.cluster_count(), 0u);
+		EXPECT_EQ(vectorOfInt.size(), 110u);
+		EXPECT_EQ(vectorOfInt.cluster_count(), clusterCount);
+		EXPECT_EQ(&vectorOfInt[60], adopted);
+		for (int i = 0; i < 110; i++)
+		{
+			EXPECT_EQ(vectorOfInt[i], i);
+		}
+
+		for (int i = 110; i < 400; i++)
+		{
+			vectorOfInt.push_back(i);
+		}
+		int expected = 0;
+		for (int value : vectorOfInt)
+		{
+			EXPECT_EQ(value, expected++);
+		}
+		EXPECT_EQ(expected, 400);
+		EXPECT_EQ(vectorOfInt[399], 399);
+
+		//other is still usable
+		other.push_back(7);
+		EXPECT_EQ(other[0], 7);
+
+		//A few elements that fit in the free space of the last cluster are moved into it
+		size_t const finalClusterCount = vectorOfInt.cluster_count();
+		vectorOfInt.splice_back(std::move(other));
+		EXPECT_EQ(vectorOfInt.cluster_count(), finalClusterCount);
+		EXPECT_EQ(vectorOfInt.back(), 7);
+
+		//Splicing into an empty vector takes the chain over
+		sw::cluster_vector<int, default_allocator> empty(4);
+		empty.splice_back(std::move(vectorOfInt));
+		EXPECT_EQ(empty.size(), 401u);
+		EXPECT_EQ(empty[200], 200);
+		EXPECT_TRUE(vectorOfInt.empty());
+	}
+
+	{
+		//Merging per-worker vectors of non-trivial elements, one of them with reserved clusters
+		std::vector<sw::cluster_vector<std::unique_ptr<int>, default_allocator>> workers;
+		for (int w = 0; w < 4; w++)
+		{
+			workers.emplace_back(2);
+			if (w == 2)
+			{
+				workers.back().reserve(100);
+			}
+			for (int i = 0; i < 25; i++)
+			{
+				workers.back().emplace_back(new int(w * 25 + i));
+			}
+		}
+
+		sw::cluster_vector<std::unique_ptr<int>, default_allocator> merged(2);
+		for (auto& worker : workers)
+		{
+			merged.splice_back(std::move(worker));
+		}
+		EXPECT_EQ(merged.size(), 100u);
+		for (int i = 0; i < 100; i++)
+		{
+			EXPECT_EQ(*merged[i], i);
+		}
+
+		for (int i = 100; i < 200; i++)
+		{
+			merged.emplace_back(new int(i));
+		}
+		int expected = 0;
+		for (auto const& value : merged)
+		{
+			EXPECT_EQ(*value, expected++);
+		}
+		EXPECT_EQ(expected, 200);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	The allocators the container tests share. _aligned_malloc is the MSVC CRT's
+//	aligned allocation, declared in malloc.h on Windows.
+//-----------------------------------------------------------------------------
+
+#include <stddef.h>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+class default_allocator
+{
+public:
+
+	void* allocate(size_t n)
+	{
+		return _aligned_malloc(n, 8);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset)
+	{
+		if ((alignmentOffset % alignment) == 0)
+		{
+			return _aligned_malloc(n, alignment);
+		}
+
+		return NULL;
+	}
+
+	void deallocate(void* p, size_t n)
+	{
+		_aligned_free(p);
+	}
+};
+
+//Counts the bytes live across every instance, and the most that were ever live at once. A template only so that the
+//counters can be defined in this header.
+template <typename Tag = void>
+class basic_byte_counting_allocator : public default_allocator
+{
+public:
+	static size_t sLiveBytes;
+	static size_t sPeakBytes;
+
+	void* allocate(size_t n)
+	{
+		DoCount(n);
+		return default_allocator::allocate(n);
+	}
+
+	void* allocate(size_t n, size_t alignment, size_t alignmentOffset)
+	{
+		DoCount(n);
+		return default_allocator::allocate(n, alignment, alignmentOffset);
+	}
+
+	void deallocate(void* p, size_t n)
+	{
+		sLiveBytes -= n;
+		default_allocator::deallocate(p, n);
+	}
+
+private:
+	static void DoCount(size_t n)
+	{
+		sLiveBytes += n;
+		sPeakBytes = sLiveBytes > sPeakBytes ? sLiveBytes : sPeakBytes;
+	}
+};
+
+template <typename Tag>
+size_t basic_byte_counting_allocator<Tag>::sLiveBytes = 0u;
+template <typename Tag>
+size_t basic_byte_counting_allocator<Tag>::sPeakBytes = 0u;
+
+using byte_counting_allocator = basic_byte_counting_allocator<>;